@@ -27,6 +27,13 @@
 #include "ft0cc/doc/dpcm_sample.hpp"		// // //
 #include "RegisterState.h"		// // //
 
+namespace {
+
+// // // Shortest lockstep slice, keeps ultrasonic periods from running cycle by cycle
+const uint32_t MIN_STEP = 7u;
+
+} // namespace
+
 // // // 2A03 sound chip class
 
 C2A03::C2A03(CMixer &Mixer) :
@@ -206,12 +213,15 @@ inline void C2A03::Clock_60Hz()
 	// IRQ
 }
 
+// // // Channels on the same pin are mixed non-linearly and must run in lockstep; each
+// step ends at the earliest output change, idle channels are skipped in a single step
+
 inline void C2A03::RunAPU1(uint32_t Time)
 {
 	// APU pin 1
 	while (Time > 0) {
-		uint32_t Period = std::max((uint32_t)std::min(m_Square1.GetPeriod(), m_Square2.GetPeriod()), 7u);
-		Period = std::min(Period, Time);
+		uint32_t Period = std::min(m_Square1.GetNextEdge(), m_Square2.GetNextEdge());		// // //
+		Period = std::min(std::max(Period, MIN_STEP), Time);
 		m_Square1.Process(Period);
 		m_Square2.Process(Period);
 		Time -= Period;
@@ -222,8 +232,8 @@ inline void C2A03::RunAPU2(uint32_t Time)
 {
 	// APU pin 2
 	while (Time > 0) {
-		uint32_t Period = std::max((uint32_t)std::min(std::min(m_Triangle.GetPeriod(), m_Noise.GetPeriod()), m_DPCM.GetPeriod()), 7u);
-		Period = std::min(Period, Time);
+		uint32_t Period = std::min({m_Triangle.GetNextEdge(), m_Noise.GetNextEdge(), m_DPCM.GetNextEdge()});		// // //
+		Period = std::min(std::max(Period, MIN_STEP), Time);
 		m_Triangle.Process(Period);
 		m_Noise.Process(Period);
 		m_DPCM.Process(Period);
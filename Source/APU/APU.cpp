@@ -25,15 +25,22 @@
 #include <algorithm>		// // //
 #include "APU/Mixer.h"		// // //
 #include "APU/2A03.h"		// // //
+#include "APU/VRC6.h"		// // //
 #include "APU/MMC5.h"
+#include "APU/FDS.h"		// // //
 #include "APU/N163.h"
 #include "APU/VRC7.h"
-#include "FamiTrackerEnv.h"		// // //
-#include "SoundChipService.h"		// // //
+#include "APU/S5B.h"		// // //
 #include "RegisterState.h"		// // //
 #include "Assertion.h"		// // //
+#include <stdexcept>		// // //
 
 CAPU::CAPU(IAudioCallback *pCallback) :		// // //
+	CAPU(&CAPU::MakeDefaultSoundChip, pCallback)
+{
+}
+
+CAPU::CAPU(const sound_chip_factory_t &MakeChip, IAudioCallback *pCallback) :		// // //
 	m_pMixer(std::make_unique<CMixer>()),		// // //
 	m_pParent(pCallback),
 	m_iSampleRate(44100),		// // //
@@ -42,7 +49,7 @@ CAPU::CAPU(IAudioCallback *pCallback) :		// // //
 	m_fLevelVRC7(1.f)
 {
 	for (sound_chip_t c : SOUND_CHIPS)
-		m_pSoundChips.push_back(Env.GetSoundChipService()->MakeSoundChipDriver(c, *m_pMixer));
+		m_pSoundChips.push_back(MakeChip(c, *m_pMixer));		// // //
 
 #ifdef LOGGING
 	m_pLog = std::make_unique<CFile>("apu_log.txt", CFile::modeCreate | CFile::modeWrite);
@@ -57,6 +64,20 @@ CAPU::~CAPU()
 #endif
 }
 
+std::unique_ptr<CSoundChip> CAPU::MakeDefaultSoundChip(sound_chip_t Chip, CMixer &Mixer) {		// // //
+	switch (Chip) {
+	case sound_chip_t::APU:  return std::make_unique<C2A03>(Mixer);
+	case sound_chip_t::VRC6: return std::make_unique<CVRC6>(Mixer);
+	case sound_chip_t::VRC7: return std::make_unique<CVRC7>(Mixer);
+	case sound_chip_t::FDS:  return std::make_unique<CFDS>(Mixer);
+	case sound_chip_t::MMC5: return std::make_unique<CMMC5>(Mixer);
+	case sound_chip_t::N163: return std::make_unique<CN163>(Mixer);
+	case sound_chip_t::S5B:  return std::make_unique<CS5B>(Mixer);
+	default: break;
+	}
+	throw std::invalid_argument {"Unknown sound chip"};
+}
+
 // The main APU emulation
 //
 // The amount of cycles that will be emulated is added by CAPU::AddCycles
@@ -66,6 +87,8 @@ void CAPU::Process()
 	while (m_iCyclesToRun > 0) {
 
 		uint32_t Time = std::min(m_iCyclesToRun, m_iSequencerNext - m_iSequencerClock);		// // //
+		if (m_iSubFrameCycles && m_iFrameCycles < m_iSubFrameCycles)		// // //
+			Time = std::min(Time, m_iSubFrameCycles - m_iFrameCycles);
 
 		for (auto *Chip : m_pActiveChips)		// // //
 			Chip->Process(Time);
@@ -76,6 +99,8 @@ void CAPU::Process()
 
 		if (m_iSequencerClock == m_iSequencerNext)
 			StepSequence();		// // //
+		if (m_iSubFrameCycles && m_iFrameCycles >= m_iSubFrameCycles)		// // //
+			EndSubFrame();
 	}
 }
 
@@ -95,17 +120,11 @@ void CAPU::StepSequence()		// // //
 // End of audio frame, flush the buffer if enough samples has been produced, and start a new frame
 void CAPU::EndFrame()
 {
-	// The APU will always output audio in 32 bit signed format
-
 	for (auto *Chip : m_pActiveChips)		// // //
 		Chip->EndFrame();
 
-	int SamplesAvail = m_pMixer->FinishBuffer(m_iFrameCycles);
-	int ReadSamples	= m_pMixer->ReadBuffer(SamplesAvail, m_pSoundBuffer.get(), m_bStereoEnabled);
-	if (m_pParent)		// // //
-		m_pParent->FlushBuffer({m_pSoundBuffer.get(), (unsigned)ReadSamples});
-
-	m_iFrameCycles = 0;
+	FlushSamples();		// // //
+	m_pMixer->UpdateMeters();		// // // VRC7 levels are stored by CVRC7::EndFrame
 
 	for (auto *r : m_pActiveChips)		// // //
 		r->GetRegisterLogger().Step();
@@ -115,6 +134,34 @@ void CAPU::EndFrame()
 #endif
 }
 
+// // // Hands over the samples emulated so far in the middle of a frame, this
+// lowers latency when the audio blocks are shorter than a frame
+void CAPU::EndSubFrame()
+{
+	for (auto *Chip : m_pActiveChips)
+		Chip->EndSubFrame();
+
+	FlushSamples();
+}
+
+void CAPU::FlushSamples()		// // //
+{
+	// The APU will always output audio in 32 bit signed format
+
+	int SamplesAvail = m_pMixer->FinishBuffer(m_iFrameCycles);
+	int ReadSamples	= m_pMixer->ReadBuffer(SamplesAvail, m_pSoundBuffer.get(), m_bStereoEnabled);
+	if (m_pParent)		// // //
+		m_pParent->FlushBuffer({m_pSoundBuffer.get(), (unsigned)ReadSamples});
+
+	if (m_pStemCallback)		// // //
+		for (chan_id_t ch : m_pMixer->GetStemChannels()) {
+			int StemSamples = m_pMixer->ReadStem(ch, SamplesAvail, m_pStemBuffer.get());
+			m_pStemCallback->FlushStem(ch, {m_pStemBuffer.get(), (unsigned)StemSamples});
+		}
+
+	m_iFrameCycles = 0;
+}
+
 void CAPU::Reset()
 {
 	// Reset APU
@@ -157,6 +204,15 @@ void CAPU::SetCallback(IAudioCallback &pCallback) {
 	m_pParent = &pCallback;
 }
 
+void CAPU::SetStemCallback(IStemCallback *pCallback) {		// // //
+	m_pStemCallback = pCallback;
+	m_pMixer->EnableStems(pCallback != nullptr);
+}
+
+void CAPU::SetSubFrameCycles(uint32_t Cycles) {		// // //
+	m_iSubFrameCycles = Cycles;
+}
+
 void CAPU::SetExternalSound(CSoundChipSet Chip) {
 	// Set expansion chip
 	m_iExternalSoundChip = Chip;
@@ -206,9 +262,10 @@ bool CAPU::SetupSound(int SampleRate, int NrChannels, int Machine)		// // //
 
 	m_pMixer->SetClockRate(BaseFreq);
 
-	m_pSoundBuffer = std::make_unique<int16_t[]>(m_iSoundBufferSize << 1);
+	m_pSoundBuffer = std::make_unique<float[]>(m_iSoundBufferSize << 1);
 	if (!m_pSoundBuffer)
 		return false;
+	m_pStemBuffer = std::make_unique<float[]>(m_iSoundBufferSize << 1);		// // //
 
 	ChangeMachineRate(Machine, FrameRate);		// // //
 
@@ -333,6 +390,11 @@ void CAPU::SetNamcoMixing(bool bLinear)		// // //
 			pN163->SetMixingMethod(bLinear);
 }
 
+void CAPU::SetChannelPan(chan_id_t Chan, int Pan)		// // //
+{
+	m_pMixer->SetChannelPan(Chan, Pan);
+}
+
 void CAPU::SetMeterDecayRate(decay_rate_t Type) const		// // // 050B
 {
 	m_pMixer->SetMeterDecayRate(Type);
@@ -28,6 +28,7 @@
 #include "Common.h"
 #include <memory>		// // //
 #include <vector>		// // //
+#include <functional>		// // //
 #include "SoundChipSet.h"		// // //
 #include "APUInterface.h"		// // //
 
@@ -43,11 +44,18 @@ enum chip_level_t : unsigned char;		// // //
 class CFile;
 #endif
 
+// // // creates the emulator for a given sound chip, owned by the APU
+using sound_chip_factory_t = std::function<std::unique_ptr<CSoundChip> (sound_chip_t, CMixer &)>;
+
 class CAPU : public CAPUInterface {
 public:
 	explicit CAPU(IAudioCallback *pCallback = nullptr);		// // //
+	explicit CAPU(const sound_chip_factory_t &MakeChip, IAudioCallback *pCallback = nullptr);		// // //
 	~CAPU();
 
+	// // // the built-in chip emulators, used when no factory is given
+	static std::unique_ptr<CSoundChip> MakeDefaultSoundChip(sound_chip_t Chip, CMixer &Mixer);
+
 	void	Reset();
 	void	Process();
 	void	AddTime(int32_t Cycles);
@@ -61,6 +69,8 @@ public:
 	bool	SetupSound(int SampleRate, int NrChannels, int Speed);
 	void	SetupMixer(int LowCut, int HighCut, int HighDamp, int Volume) const;
 	void	SetCallback(IAudioCallback &pCallback);		// // //
+	void	SetStemCallback(IStemCallback *pCallback);		// // // nullptr disables stems
+	void	SetSubFrameCycles(uint32_t Cycles);		// // // flush samples every Cycles CPU cycles, 0 flushes once per frame
 
 	int32_t	GetVol(chan_id_t Chan) const;		// // //
 	uint8_t	GetReg(sound_chip_t Chip, int Reg) const;
@@ -70,6 +80,7 @@ public:
 	void	SetChipLevel(chip_level_t Chip, float Level);
 
 	void	SetNamcoMixing(bool bLinear);		// // //
+	void	SetChannelPan(chan_id_t Chan, int Pan);		// // // -100 to 100, requires stereo output
 
 	void	SetMeterDecayRate(decay_rate_t Type) const;		// // // 050B
 	decay_rate_t GetMeterDecayRate() const;		// // // 050B
@@ -82,12 +93,15 @@ public:
 
 private:
 	void StepSequence();		// // //
+	void EndSubFrame();		// // //
+	void FlushSamples();		// // //
 
 	void LogWrite(uint16_t Address, uint8_t Value);
 
 private:
 	std::unique_ptr<CMixer> m_pMixer;		// // //
 	IAudioCallback *m_pParent;
+	IStemCallback *m_pStemCallback = nullptr;		// // //
 
 	// Expansion chips
 	std::vector<std::unique_ptr<CSoundChip>> m_pSoundChips;		// // //
@@ -105,9 +119,11 @@ private:
 	uint32_t	m_iSampleSizeShift;					// To convert samples to bytes
 	uint32_t	m_iSoundBufferSize;					// Size of buffer, in samples
 	uint32_t	m_iBufferPointer;					// Fill pos in buffer
-	std::unique_ptr<int16_t[]> m_pSoundBuffer;			// // // Sound transfer buffer
+	std::unique_ptr<float[]> m_pSoundBuffer;			// // // Sound transfer buffer
+	std::unique_ptr<float[]> m_pStemBuffer;				// // // Sound transfer buffer for stems
 
 	uint32_t	m_iFrameCycles;						// Cycles emulated from start of frame
+	uint32_t	m_iSubFrameCycles = 0;				// // // Cycles between partial flushes, 0 if disabled
 	uint32_t	m_iSequencerClock;					// Clock for frame sequencer
 	uint32_t	m_iSequencerNext;					// // // Next value for sequencer
 	uint8_t		m_iSequencerCount;					// // // Step count for sequencer
@@ -43,6 +43,12 @@ public:
 
 	virtual double GetFrequency() const = 0;		// // //
 
+	// // // Number of cycles until the output of this channel may change, or EDGE_IDLE
+	// if it stays the same until the next register write or sequencer clock
+	virtual uint32_t GetNextEdge() const = 0;
+
+	static constexpr uint32_t EDGE_IDLE = 0xFFFFFFFFu;		// // //
+
 protected:
 	void Mix(int32_t Value);		// // //
 
@@ -181,6 +181,14 @@ void CDPCM::Process(uint32_t Time)
 	m_iTime += Time;
 }
 
+uint32_t CDPCM::GetNextEdge() const		// // //
+{
+	// The delta counter is left alone until another sample is played
+	if (m_bSilenceFlag && !m_bSampleFilled && !m_iDMA_BytesRemaining)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CDPCM::GetFrequency() const		// // //
 {
 	if (!m_bSampleFilled && !m_iDMA_BytesRemaining)
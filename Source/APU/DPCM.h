@@ -36,6 +36,7 @@ public:
 	void	WriteControl(uint8_t Value);
 	uint8_t	ReadControl() const;
 	void	Process(uint32_t Time);
+	uint32_t GetNextEdge() const override;		// // //
 	double	GetFrequency() const;		// // //
 
 	uint8_t	DidIRQ() const;
@@ -27,6 +27,12 @@
 
 // FDS interface, actual FDS emulation is in FDSSound.cpp
 
+namespace {
+
+const uint32_t TIME_STEP = 32u; // ???
+
+} // namespace
+
 CFDS::CFDS(CMixer &Mixer) :
 	CSoundChip(Mixer),
 	CChannel(Mixer, sound_chip_t::FDS, chan_id_t::FDS),
@@ -70,8 +76,6 @@ void CFDS::Process(uint32_t Time)
 	if (!Time)
 		return;
 
-	const uint32_t TIME_STEP = 32u; // ???
-
 	while (Time) {
 		const uint32_t t = Time < TIME_STEP ? Time : TIME_STEP;
 		emu_->Tick(t);
@@ -81,6 +85,11 @@ void CFDS::Process(uint32_t Time)
 	}
 }
 
+uint32_t CFDS::GetNextEdge() const		// // //
+{
+	return TIME_STEP;
+}
+
 double CFDS::GetFreq(int Channel) const		// // //
 {
 	if (Channel) return 0.;
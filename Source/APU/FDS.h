@@ -46,6 +46,7 @@ public:
 
 	double	GetFreq(int Channel) const override;		// // //
 	double	GetFrequency() const { return GetFreq(0); }		// // //
+	uint32_t GetNextEdge() const override;		// // //
 
 private:
 	std::unique_ptr<xgm::NES_FDS> emu_;		// // //
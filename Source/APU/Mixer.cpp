@@ -56,13 +56,19 @@
 #include <algorithm>		// // //
 #include <memory>
 #include <cmath>
-#include "APU/ext/emu2413.h"		// // //
 
 namespace {
 
 const float LEVEL_FALL_OFF_RATE = 0.6f;
 const int   LEVEL_FALL_OFF_DELAY = 3;
 
+const int   PAN_MAX = 100;		// // //
+
+// // // VRC7 channels are mixed by emu2413 and share a single buffer
+constexpr chan_id_t GetBufferChannel(chan_id_t ch) noexcept {
+	return GetChipFromChannel(ch) == sound_chip_t::VRC7 ? chan_id_t::VRC7_CH1 : ch;
+}
+
 constexpr chip_level_t GetMixerFromChannel(chan_id_t ch) noexcept {		// // //
 	switch (ch) {
 	case chan_id_t::SQUARE1: case chan_id_t::SQUARE2:
@@ -117,6 +123,22 @@ void CMixer::VisitMixers(F f) {
 	WithMixer(CHIP_LEVEL_S5B, f);
 }
 
+template <typename F>
+void CMixer::VisitBuffers(F f) {		// // //
+	for (auto &x : m_pChannelBuffers)
+		if (x)
+			f(*x);
+}
+
+template <typename F>
+void CMixer::VisitChannelBuffers(F f) {		// // //
+	for (std::size_t i = 0; i < CHANID_COUNT; ++i) {
+		const auto ch = static_cast<chan_id_t>(i);
+		if (m_pChannelBuffers[i] && m_iExternalChip.ContainsChip(GetChipFromChannel(ch)))
+			f(ch, *m_pChannelBuffers[i]);
+	}
+}
+
 void CMixer::ExternalSound(CSoundChipSet Chip) {		// // //
 	m_iExternalChip = Chip;
 	UpdateSettings(m_iLowCut, m_iHighCut, m_iHighDamp, m_fOverallVol);
@@ -175,6 +197,9 @@ void CMixer::UpdateSettings(int LowCut,	int HighCut, int HighDamp, float Overall
 
 	// Blip-buffer filtering
 	BlipBuffer.bass_freq(m_iLowCut);
+	VisitBuffers([&] (Blip_Buffer &bb) {		// // //
+		bb.bass_freq(m_iLowCut);
+	});
 
 	blip_eq_t eq(-m_iHighDamp, m_iHighCut, m_iSampleRate);
 
@@ -232,7 +257,10 @@ void CMixer::SetMeterDecayRate(decay_rate_t Rate)		// // // 050B
 void CMixer::MixSamples(blip_sample_t *pBuffer, uint32_t Count)
 {
 	// For VRC7
-	BlipBuffer.mix_samples(pBuffer, Count);
+	if (!IsPanned(chan_id_t::VRC7_CH1))		// // //
+		BlipBuffer.mix_samples(pBuffer, Count);
+	if (auto *pChan = GetChannelBuffer(chan_id_t::VRC7_CH1))		// // //
+		pChan->mix_samples(pBuffer, Count);
 }
 
 uint32_t CMixer::GetMixSampleCount(int t) const
@@ -243,18 +271,32 @@ uint32_t CMixer::GetMixSampleCount(int t) const
 bool CMixer::AllocateBuffer(unsigned int BufferLength, uint32_t SampleRate, uint8_t NrChannels)
 {
 	m_iSampleRate = SampleRate;
-	return !BlipBuffer.set_sample_rate(SampleRate, (BufferLength * 1000 * 4) / SampleRate);		// // //
+	m_iBufferLength = (BufferLength * 1000 * 4) / SampleRate;		// // //
+	bool Success = !BlipBuffer.set_sample_rate(SampleRate, m_iBufferLength);
+	VisitBuffers([&] (Blip_Buffer &bb) {		// // //
+		Success = Success && !bb.set_sample_rate(SampleRate, m_iBufferLength);
+	});
+	m_bStereo = NrChannels == 2;		// // //
+	UpdateChannelBuffers();
+	return Success;
 }
 
 void CMixer::SetClockRate(uint32_t Rate)
 {
 	// Change the clockrate
+	m_iClockRate = Rate;		// // //
 	BlipBuffer.clock_rate(Rate);
+	VisitBuffers([&] (Blip_Buffer &bb) {		// // //
+		bb.clock_rate(Rate);
+	});
 }
 
 void CMixer::ClearBuffer()
 {
 	BlipBuffer.clear();
+	VisitBuffers([] (Blip_Buffer &bb) {		// // //
+		bb.clear();
+	});
 	VisitMixers([] (auto &levels) {
 		levels.ResetDelta();
 	});
@@ -269,11 +311,18 @@ int CMixer::FinishBuffer(int t)
 {
 	BlipBuffer.end_frame(t);
 
-	// Get channel levels for VRC7
-	for (int i = 0; i < MAX_CHANNELS_VRC7; ++i)
-		StoreChannelLevel(MakeChannelIndex(sound_chip_t::VRC7, i), OPLL_getchanvol(i));
-
-	UpdateMeters();		// // //
+	// // // buffers of inactive chips are never read; the others are read together
+	std::array<Blip_Buffer *, CHANID_COUNT> Buffers;
+	std::array<float *, CHANID_COUNT> Samples;
+	int Count = 0;
+	VisitChannelBuffers([&] (chan_id_t ch, Blip_Buffer &bb) {
+		bb.end_frame(t);
+		auto &samples = m_fChannelSamples[value_cast(ch)];
+		samples.resize(bb.samples_avail());
+		Buffers[Count] = &bb;
+		Samples[Count++] = samples.data();
+	});
+	Blip_Buffer::read_samples(Buffers.data(), Samples.data(), Count);
 
 	// Return number of samples available
 	return BlipBuffer.samples_avail();
@@ -285,13 +334,131 @@ int CMixer::FinishBuffer(int t)
 
 void CMixer::AddValue(chan_id_t ChanID, int Value, int FrameCycles) {		// // //
 	WithMixer(GetMixerFromChannel(ChanID), [&] (auto &mixer) {
-		StoreChannelLevel(ChanID, mixer.AddValue(ChanID, Value, FrameCycles, BlipBuffer));
+		StoreChannelLevel(ChanID, mixer.AddValue(ChanID, Value, FrameCycles,		// // //
+			IsPanned(ChanID) ? nullptr : &BlipBuffer, GetChannelBuffer(ChanID)));
 	});
 }
 
-int CMixer::ReadBuffer(int Size, void *Buffer, bool Stereo)
+int CMixer::ReadBuffer(int Size, float *pBuffer, bool Stereo)		// // //
 {
-	return BlipBuffer.read_samples((blip_sample_t*)Buffer, Size);
+	int Count = BlipBuffer.read_samples(pBuffer, Size);
+	if (!Stereo)
+		return Count;
+	MixStereo(pBuffer, Count);
+	return Count * 2;
+}
+
+void CMixer::MixStereo(float *pBuffer, int Count) {		// // //
+	// Centered channels are already in the mono mix; add every panned channel
+	// with its own gains in one pass per channel over the frame, then interleave
+	m_fMixLeft.assign(pBuffer, pBuffer + Count);
+	m_fMixRight.assign(pBuffer, pBuffer + Count);
+
+	VisitChannelBuffers([&] (chan_id_t ch, Blip_Buffer &) {
+		if (!IsPanned(ch))
+			return;
+		const int Pan = m_iChannelPan[value_cast(ch)];
+		const float GainL = static_cast<float>(PAN_MAX - std::max(Pan, 0)) / PAN_MAX;
+		const float GainR = static_cast<float>(PAN_MAX + std::min(Pan, 0)) / PAN_MAX;
+		const auto &samples = m_fChannelSamples[value_cast(ch)];
+		const int n = std::min(Count, static_cast<int>(samples.size()));
+		float *pLeft = m_fMixLeft.data();
+		float *pRight = m_fMixRight.data();
+		for (int i = 0; i < n; ++i) {
+			pLeft[i] += samples[i] * GainL;
+			pRight[i] += samples[i] * GainR;
+		}
+	});
+
+	// no clipping here, the samples are only limited when they are converted for output
+	for (int i = 0; i < Count; ++i) {
+		pBuffer[i * 2] = m_fMixLeft[i];
+		pBuffer[i * 2 + 1] = m_fMixRight[i];
+	}
+}
+
+// // // Stems
+
+void CMixer::EnableStems(bool Enable) {
+	m_bStems = Enable;
+	UpdateChannelBuffers();
+}
+
+bool CMixer::StemsEnabled() const {
+	return m_bStems;
+}
+
+std::vector<chan_id_t> CMixer::GetStemChannels() const {
+	std::vector<chan_id_t> chans;
+	if (m_bStems)
+		for (std::size_t i = 0; i < CHANID_COUNT; ++i)
+			if (m_pChannelBuffers[i] && m_iExternalChip.ContainsChip(GetChipFromChannel(static_cast<chan_id_t>(i))))
+				chans.push_back(static_cast<chan_id_t>(i));
+	return chans;
+}
+
+int CMixer::ReadStem(chan_id_t Chan, int Size, float *Buffer) {
+	if (!GetChannelBuffer(Chan))
+		return 0;
+	const auto &samples = m_fChannelSamples[value_cast(GetBufferChannel(Chan))];
+	const int Count = std::min(Size, static_cast<int>(samples.size()));
+	std::copy_n(samples.begin(), Count, Buffer);
+	return Count;
+}
+
+// // // Panning
+
+void CMixer::SetChannelPan(chan_id_t Chan, int Pan) {
+	Chan = GetBufferChannel(Chan);
+	if (value_cast(Chan) < CHANID_COUNT) {
+		m_iChannelPan[value_cast(Chan)] = std::clamp(Pan, -PAN_MAX, PAN_MAX);
+		UpdateChannelBuffers();
+	}
+}
+
+int CMixer::GetChannelPan(chan_id_t Chan) const {
+	Chan = GetBufferChannel(Chan);
+	return value_cast(Chan) < CHANID_COUNT ? m_iChannelPan[value_cast(Chan)] : 0;
+}
+
+bool CMixer::IsPanned(chan_id_t Chan) const {
+	Chan = GetBufferChannel(Chan);
+	return m_bStereo && value_cast(Chan) < CHANID_COUNT && m_iChannelPan[value_cast(Chan)] != 0;
+}
+
+Blip_Buffer *CMixer::GetChannelBuffer(chan_id_t Chan) const {
+	Chan = GetBufferChannel(Chan);
+	return value_cast(Chan) < CHANID_COUNT ? m_pChannelBuffers[value_cast(Chan)].get() : nullptr;
+}
+
+void CMixer::UpdateChannelBuffers() {
+	bool Changed = false;
+
+	for (std::size_t i = 0; i < CHANID_COUNT; ++i) {
+		auto &pBuf = m_pChannelBuffers[i];
+		const auto ch = static_cast<chan_id_t>(i);
+		const bool HasBuffer = GetBufferChannel(ch) == ch && (m_bStems || IsPanned(ch));
+		if (!HasBuffer && pBuf) {
+			pBuf.reset();
+			m_fChannelSamples[i].clear();
+			Changed = true;
+		}
+		else if (HasBuffer && !pBuf) {
+			pBuf = std::make_unique<Blip_Buffer>();
+			if (m_iSampleRate)
+				pBuf->set_sample_rate(m_iSampleRate, m_iBufferLength);
+			if (m_iClockRate)
+				pBuf->clock_rate(m_iClockRate);
+			pBuf->bass_freq(m_iLowCut);
+			Changed = true;
+		}
+	}
+
+	// the chip mixes do not include panned channels, levels are tracked again from the next reset
+	if (Changed)
+		VisitMixers([] (auto &levels) {
+			levels.ResetDelta();
+		});
 }
 
 int32_t CMixer::GetChanOutput(chan_id_t Chan) const		// // //
@@ -28,6 +28,8 @@
 #include "Common.h"
 #include "Blip_Buffer/Blip_Buffer.h"
 #include <array>		// // //
+#include <vector>		// // //
+#include <memory>		// // //
 #include "SoundChipSet.h"		// // //
 
 enum chip_level_t : unsigned char {
@@ -54,14 +56,16 @@ public:
 	void	SetClockRate(uint32_t Rate);
 	void	ClearBuffer();
 	int		FinishBuffer(int t);
+	void	UpdateMeters();		// // // once per frame, after the last FinishBuffer
 	int		SamplesAvail() const;
 	void	MixSamples(blip_sample_t *pBuffer, uint32_t Count);
 	uint32_t	GetMixSampleCount(int t) const;
 
 	void	AddSample(int ChanID, int Value);
-	int		ReadBuffer(int Size, void *Buffer, bool Stereo);
+	int		ReadBuffer(int Size, float *Buffer, bool Stereo);		// // // returns the number of values written, two per sample in stereo
 
 	int32_t	GetChanOutput(chan_id_t Chan) const;		// // //
+	void	StoreChannelLevel(chan_id_t Channel, int Level);		// // //
 	void	SetChipLevel(chip_level_t Chip, float Level);
 	uint32_t	ResampleDuration(uint32_t Time) const;
 	void	SetNamcoMixing(bool bLinear);		// // //
@@ -70,13 +74,35 @@ public:
 	decay_rate_t GetMeterDecayRate() const;		// // // 050B
 	void	SetMeterDecayRate(decay_rate_t Rate);		// // // 050B
 
+	// // // Stems, every channel is also mixed alone into its own buffer; VRC7 is mixed as a single stem
+	void	EnableStems(bool Enable);
+	bool	StemsEnabled() const;
+	std::vector<chan_id_t> GetStemChannels() const;
+	int		ReadStem(chan_id_t Chan, int Size, float *Buffer);
+
+	// // // Panning, from -100 (left) to 100 (right); only used when the buffer is allocated as stereo
+	void	SetChannelPan(chan_id_t Chan, int Pan);
+	int		GetChannelPan(chan_id_t Chan) const;
+
 private:
-	void UpdateMeters();		// // //
-	void StoreChannelLevel(chan_id_t Channel, int Level);		// // //
 	void ClearChannelLevels();
 
 	float GetAttenuation() const;
 
+	// // // Channels that are panned or rendered as stems have their own buffer
+	Blip_Buffer *GetChannelBuffer(chan_id_t Chan) const;
+	bool IsPanned(chan_id_t Chan) const;
+	void UpdateChannelBuffers();
+	void MixStereo(float *pBuffer, int Count);
+
+	// void (*F)(Blip_Buffer &bb)
+	template <typename F>
+	void VisitBuffers(F f);		// // //
+
+	// void (*F)(chan_id_t ch, Blip_Buffer &bb), only for channels of active chips
+	template <typename F>
+	void VisitChannelBuffers(F f);		// // //
+
 	// template <typename T> void (*F)(CMixerChannel<T> &levels)
 	template <typename F>
 	void WithMixer(chip_level_t Mixer, F f);		// // //
@@ -88,6 +114,11 @@ private:
 private:
 	// Blip buffer object
 	Blip_Buffer	BlipBuffer;
+	std::array<std::unique_ptr<Blip_Buffer>, CHANID_COUNT> m_pChannelBuffers;		// // //
+	std::array<std::vector<float>, CHANID_COUNT> m_fChannelSamples;		// // // read from the channel buffers every frame
+	std::vector<float> m_fMixLeft;		// // //
+	std::vector<float> m_fMixRight;		// // //
+	std::array<int, CHANID_COUNT> m_iChannelPan = { };		// // //
 
 	CMixerChannel<stLevels2A03SS>  levels2A03SS_  { 500.00};		// // //
 	CMixerChannel<stLevels2A03TND> levels2A03TND_ { 500.00};
@@ -99,6 +130,10 @@ private:
 
 	CSoundChipSet m_iExternalChip;
 	uint32_t	m_iSampleRate = 0;
+	uint32_t	m_iClockRate = 0;		// // //
+	int			m_iBufferLength = 0;		// // // in milliseconds
+	bool		m_bStereo = false;		// // //
+	bool		m_bStems = false;		// // //
 
 	std::array<float, CHANID_COUNT>		m_fChannelLevels = { };
 	std::array<float, CHANID_COUNT>		m_fChannelLevelsLast = { };		// // //
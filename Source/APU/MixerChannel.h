@@ -25,6 +25,7 @@
 
 #include "APU/Types.h"
 #include "Blip_Buffer/Blip_Buffer.h"
+#include <array>		// // //
 
 class CMixerChannelBase {
 public:
@@ -46,18 +47,33 @@ class CMixerChannel : public CMixerChannelBase {
 public:
 	using CMixerChannelBase::CMixerChannelBase;
 
-	int AddValue(chan_id_t ChanID, int Value, int FrameCycles, Blip_Buffer &bb) {
-		const int level = levels_.Offset(ChanID, Value);
-		const double prev = lastSum_;
-		lastSum_ = levels_.CalcPin();
-		const double Delta = lastSum_ - prev;
-		synth_.offset(FrameCycles, static_cast<int>(Delta), &bb);
+	// // // pMix receives the chip mix, pSolo what this channel would output if every other channel were muted
+	int AddValue(chan_id_t ChanID, int Value, int FrameCycles, Blip_Buffer *pMix, Blip_Buffer *pSolo = nullptr) {
+		int level = 0;
+
+		if (pMix) {
+			level = levels_.Offset(ChanID, Value);
+			const double prev = lastSum_;
+			lastSum_ = levels_.CalcPin();
+			const double Delta = lastSum_ - prev;
+			synth_.offset(FrameCycles, static_cast<int>(Delta), pMix);
+		}
+
+		if (pSolo) {
+			auto &solo = solo_[value_cast(ChanID)];
+			level = solo.levels_.Offset(ChanID, Value);
+			const double soloPrev = solo.lastSum_;
+			solo.lastSum_ = solo.levels_.CalcPin();
+			synth_.offset(FrameCycles, static_cast<int>(solo.lastSum_ - soloPrev), pSolo);
+		}
+
 		return level;
 	}
 
 	void ResetDelta() {
 		lastSum_ = 0;
 		levels_ = T { };
+		solo_ = { };		// // //
 	}
 
 	double GetLevel(chan_id_t ChanID) const {
@@ -66,4 +82,10 @@ public:
 
 private:
 	T levels_;
+
+	struct solo_t {		// // //
+		T levels_;
+		double lastSum_ = 0.;
+	};
+	std::array<solo_t, CHANID_COUNT> solo_ = { };
 };
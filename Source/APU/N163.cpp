@@ -149,6 +149,13 @@ void CN163::EndFrame()
 	m_iGlobalTime = 0;
 }
 
+void CN163::EndSubFrame()		// // // phase logging and counter resets only happen once per frame
+{
+	for (auto &x : m_Channels)
+		x.EndFrame();
+	m_iGlobalTime = 0;
+}
+
 void CN163::Write(uint16_t Address, uint8_t Value)
 {
 	int Area = m_iExpandAddr & 0x7F;
@@ -377,6 +384,13 @@ void CN163Chan::ResetCounter()
 	m_iCounter = 0;
 }
 
+uint32_t CN163Chan::GetNextEdge() const		// // //
+{
+	if (!m_iFrequency || !m_iWaveLength)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CN163Chan::GetFrequency() const		// // //
 {
 	return MASTER_CLOCK_NTSC / 983040. * m_iFrequency / (m_iWaveLength >> 16);
@@ -44,6 +44,7 @@ public:
 	uint8_t ReadMem(uint8_t Reg);
 	void ResetCounter();
 	double GetFrequency() const;		// // //
+	uint32_t GetNextEdge() const override;		// // //
 
 private:
 	uint32_t	m_iCounter, m_iFrequency;
@@ -68,6 +69,7 @@ public:
 	void Reset() override;
 	void Process(uint32_t Time) override;
 	void EndFrame() override;
+	void EndSubFrame() override;		// // //
 
 	void Write(uint16_t Address, uint8_t Value) override;
 	uint8_t Read(uint16_t Address, bool &Mapped);
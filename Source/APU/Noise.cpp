@@ -118,6 +118,14 @@ void CNoise::Process(uint32_t Time)
 	m_iTime += Time;
 }
 
+uint32_t CNoise::GetNextEdge() const		// // //
+{
+	const uint8_t Volume = m_iEnvelopeFix ? m_iFixedVolume : m_iEnvelopeVolume;
+	if ((!m_iEnabled || !m_iLengthCounter || !Volume) && !m_iLastValue)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CNoise::GetFrequency() const		// // //
 {
 	if (!m_iEnabled || !m_iLengthCounter)
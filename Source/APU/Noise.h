@@ -40,6 +40,7 @@ public:
 	void	WriteControl(uint8_t Value);
 	uint8_t	ReadControl();
 	void	Process(uint32_t Time);
+	uint32_t GetNextEdge() const override;		// // //
 	double	GetFrequency() const;		// // //
 
 	void	LengthCounterUpdate();
@@ -70,10 +70,10 @@ void CS5BChannel::Reset()
 	m_bNoiseDisable = true;
 }
 
-uint32_t CS5BChannel::GetTime() const
+uint32_t CS5BChannel::GetNextEdge() const		// // //
 {
 	if (m_iPeriod < 2U || !m_iVolume)
-		return 0xFFFFFU;
+		return EDGE_IDLE;
 	return m_iPeriod - m_iPeriodClock;
 }
 
@@ -141,7 +141,7 @@ void CS5B::Process(uint32_t Time)
 		if (m_iNoiseClock < m_iNoisePeriod)
 			TimeToRun = std::min<uint32_t>(m_iNoisePeriod - m_iNoiseClock, TimeToRun);
 		for (const auto &x : m_Channel)
-			TimeToRun = std::min<uint32_t>(x.GetTime(), TimeToRun);
+			TimeToRun = std::min<uint32_t>(x.GetNextEdge(), TimeToRun);		// // //
 
 		m_iCounter += TimeToRun;
 		Time -= TimeToRun;
@@ -38,7 +38,7 @@ public:
 	void Process(uint32_t Time);
 	void Reset();
 
-	uint32_t GetTime() const;
+	uint32_t GetNextEdge() const override;		// // //
 	void Output(uint32_t Noise, uint32_t Envelope);
 
 	double GetFrequency() const;
@@ -32,6 +32,11 @@ CSoundChip::CSoundChip(CMixer &Mixer) :
 CSoundChip::~CSoundChip() noexcept {
 }
 
+void CSoundChip::EndSubFrame()		// // //
+{
+	EndFrame();
+}
+
 double CSoundChip::GetFreq(int Channel) const		// // //
 {
 	return 0.0;
@@ -40,6 +40,8 @@ public:
 	virtual void	Reset() = 0;
 	virtual void	Process(uint32_t Time) = 0;
 	virtual void	EndFrame() = 0;
+	// // // Starts a new time base in the middle of a frame, without per-frame side effects
+	virtual void	EndSubFrame();
 
 	virtual void	Write(uint16_t Address, uint8_t Value) = 0;
 	virtual uint8_t	Read(uint16_t Address, bool &Mapped) = 0;
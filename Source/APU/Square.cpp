@@ -132,14 +132,26 @@ void CSquare::Process(uint32_t Time)
 		return;
 	}
 
-	bool Valid = (m_iPeriod > 7 || (m_iPeriod > 0 && m_iChip == sound_chip_t::MMC5))		// // //
-		&& (m_iEnabled != 0) && (m_iLengthCounter > 0) && (m_iSweepResult < 0x800);
+	const bool Valid = IsValid();		// // //
+	const uint8_t Volume = GetVolume();
+
+	// // // Silent channel, only advance the duty cycle
+	if ((!Valid || !Volume) && !m_iLastValue) {
+		if (Time >= m_iCounter) {
+			const uint32_t Steps = (Time - m_iCounter) / (m_iPeriod + 1) + 1;
+			m_iCounter = m_iPeriod + 1 - (Time - m_iCounter) % (m_iPeriod + 1);
+			m_iDutyCycle = (m_iDutyCycle + Steps) & 0x0F;
+		}
+		else
+			m_iCounter -= Time;
+		m_iTime += Time;
+		return;
+	}
 
 	while (Time >= m_iCounter) {
 		Time		-= m_iCounter;
 		m_iTime		+= m_iCounter;
 		m_iCounter	 = m_iPeriod + 1;
-		uint8_t Volume = m_iEnvelopeFix ? m_iFixedVolume : m_iEnvelopeVolume;
 		Mix(Valid && DUTY_TABLE[m_iDutyLength][m_iDutyCycle] ? Volume : 0);
 		m_iDutyCycle = (m_iDutyCycle + 1) & 0x0F;
 	}
@@ -150,13 +162,29 @@ void CSquare::Process(uint32_t Time)
 
 double CSquare::GetFrequency() const		// // //
 {
-	bool Valid = (m_iPeriod > 7 || (m_iPeriod > 0 && m_iChip == sound_chip_t::MMC5))
-		&& m_iEnabled && m_iLengthCounter && m_iSweepResult < 0x800;
-	if (!Valid)
+	if (!IsValid())
 		return 0.;
 	return CPU_RATE / 16. / (m_iPeriod + 1.);
 }
 
+uint32_t CSquare::GetNextEdge() const		// // //
+{
+	if (!m_iPeriod || ((!IsValid() || !GetVolume()) && !m_iLastValue))
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
+bool CSquare::IsValid() const		// // //
+{
+	return (m_iPeriod > 7 || (m_iPeriod > 0 && m_iChip == sound_chip_t::MMC5))
+		&& m_iEnabled && m_iLengthCounter && m_iSweepResult < 0x800;
+}
+
+uint8_t CSquare::GetVolume() const		// // //
+{
+	return m_iEnvelopeFix ? m_iFixedVolume : m_iEnvelopeVolume;
+}
+
 void CSquare::LengthCounterUpdate()
 {
 	if ((m_iLooping == 0) && (m_iLengthCounter > 0))
@@ -41,6 +41,7 @@ public:
 	uint8_t	ReadControl();
 	void	Process(uint32_t Time);
 	double	GetFrequency() const;		// // //
+	uint32_t GetNextEdge() const override;		// // //
 
 	void	LengthCounterUpdate();
 	void	SweepUpdate(int Diff);
@@ -50,6 +51,10 @@ public:
 	static const uint8_t DUTY_TABLE[4][16];
 	uint32_t CPU_RATE;		// // //
 
+private:
+	bool	IsValid() const;		// // //
+	uint8_t	GetVolume() const;		// // //
+
 private:
 	uint8_t	m_iDutyLength, m_iDutyCycle;
 
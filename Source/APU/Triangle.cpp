@@ -120,6 +120,13 @@ void CTriangle::Process(uint32_t Time)
 	m_iTime += Time;
 }
 
+uint32_t CTriangle::GetNextEdge() const		// // //
+{
+	if (!m_iLinearCounter || !m_iLengthCounter || !m_iEnabled)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CTriangle::GetFrequency() const		// // //
 {
 	if (!m_iLinearCounter || !m_iLengthCounter || !m_iEnabled)
@@ -171,6 +171,7 @@ constexpr chan_id_t MakeChannelIndex(sound_chip_t chip, unsigned subindex) noexc
 		if (subindex < MAX_CHANNELS_S5B)
 			return (chan_id_t)((unsigned)chan_id_t::S5B_CH1 + subindex);
 		break;
+	default: break;		// // //
 	}
 	return chan_id_t::NONE;
 }
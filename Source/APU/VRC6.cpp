@@ -84,6 +84,13 @@ void CVRC6_Pulse::Process(int Time)
 	m_iTime += Time;
 }
 
+uint32_t CVRC6_Pulse::GetNextEdge() const		// // //
+{
+	if (!m_iEnabled || m_iPeriod == 0)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CVRC6_Pulse::GetFrequency() const		// // //
 {
 	if (m_iGate || !m_iEnabled || !m_iPeriod)
@@ -155,6 +162,13 @@ void CVRC6_Sawtooth::Process(int Time)
 	m_iTime += Time;
 }
 
+uint32_t CVRC6_Sawtooth::GetNextEdge() const		// // //
+{
+	if (!m_iEnabled || !m_iPeriod)
+		return EDGE_IDLE;
+	return m_iCounter;
+}
+
 double CVRC6_Sawtooth::GetFrequency() const		// // //
 {
 	if (!m_iEnabled || !m_iPeriod)
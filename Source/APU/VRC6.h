@@ -33,6 +33,7 @@ public:
 	void Write(uint16_t Address, uint8_t Value);
 	void Process(int Time);
 	double GetFrequency() const;		// // //
+	uint32_t GetNextEdge() const override;		// // //
 
 private:
 	uint8_t	m_iDutyCycle,
@@ -53,6 +54,7 @@ public:
 	void Write(uint16_t Address, uint8_t Value);
 	void Process(int Time);
 	double GetFrequency() const;		// // //
+	uint32_t GetNextEdge() const override;		// // //
 
 private:
 	uint8_t	m_iPhaseAccumulator,
@@ -29,6 +29,10 @@ const uint32_t CVRC7::OPL_CLOCK = 3579545;	// Clock frequency
 
 CVRC7::CVRC7(CMixer &Mixer) : CSoundChip(Mixer)
 {
+	// // // build the shared OPLL tables exactly once, even if multiple APUs are created concurrently
+	static const bool OPLLTablesReady = (OPLL_init_tables(), true);
+	(void)OPLLTablesReady;
+
 	m_pRegisterLogger->AddRegisterRange(0x00, 0x07);		// // //
 	m_pRegisterLogger->AddRegisterRange(0x10, 0x15);
 	m_pRegisterLogger->AddRegisterRange(0x20, 0x25);
@@ -92,8 +96,6 @@ void CVRC7::EndFrame()
 {
 	uint32_t WantSamples = m_pMixer->GetMixSampleCount(m_iTime);
 
-	static int32_t LastSample = 0;
-
 	// Generate VRC7 samples
 	while (m_iBufferPtr < WantSamples) {
 		int32_t RawSample = OPLL_calc(m_pOPLLInt.get());
@@ -112,12 +114,16 @@ void CVRC7::EndFrame()
 		if (Sample < -32768)
 			Sample = -32768;
 
-		m_iBuffer[m_iBufferPtr++] = int16_t((Sample + LastSample) >> 1);
-		LastSample = Sample;
+		m_iBuffer[m_iBufferPtr++] = int16_t((Sample + m_iLastSample) >> 1);		// // //
+		m_iLastSample = Sample;
 	}
 
 	m_pMixer->MixSamples((blip_sample_t*)m_iBuffer.data(), WantSamples);		// // //
 
+	// Get channel levels
+	for (int i = 0; i < MAX_CHANNELS_VRC7; ++i)		// // //
+		m_pMixer->StoreChannelLevel(MakeChannelIndex(sound_chip_t::VRC7, i), OPLL_getchanvol(m_pOPLLInt.get(), i));
+
 	m_iBufferPtr -= WantSamples;
 	m_iTime = 0;
 }
@@ -66,6 +66,7 @@ private:
 	uint32_t	m_iBufferPtr;
 
 	float		m_fVolume = 1.f;
+	int32_t		m_iLastSample = 0;		// // //
 
 	uint8_t		m_iSoundReg = 0;
 };
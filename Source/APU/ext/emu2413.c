@@ -155,16 +155,17 @@ static unsigned char default_inst[OPLL_TONE_NUM][(16 + 3) * 16] = {
 
 /* Adjust envelope speed which depends on sampling rate. */
 #define RATE_ADJUST(x) (rate==49716?x:(uint32_t)((double)(x)*clk/72/rate + 0.5))        /* added 0.5 to round the value*/
+/* // // // clk and rate are local to each function using RATE_ADJUST */
 
 #define MOD(o,x) (&(o)->slot[(x)<<1])
 #define CAR(o,x) (&(o)->slot[((x)<<1)|1])
 
 #define BIT(s,b) (((s)>>(b))&1)
 
-/* Input clock */
-static uint32_t clk = 844451141;
-/* Sampling rate */
-static uint32_t rate = 3354932;
+/* // // // The tables below do not depend on the clock or the sampling rate; they
+   are built once by OPLL_init_tables and only read afterwards. Tables depending
+   on the clock or the sampling rate are stored in each OPLL object. */
+static int tables_ready = 0;
 
 /* WaveTable for each envelope amp */
 static uint16_t fullsintable[PG_WIDTH];
@@ -176,10 +177,6 @@ static uint16_t *waveform[2] = { fullsintable, halfsintable };
 static int32_t pmtable[PM_PG_WIDTH];
 static int32_t amtable[AM_PG_WIDTH];
 
-/* Phase delta for LFO */
-static uint32_t pm_dphase;
-static uint32_t am_dphase;
-
 /* dB to Liner table */
 static int16_t DB2LIN_TABLE[(DB_MUTE + DB_MUTE) * 2];
 
@@ -196,21 +193,10 @@ static OPLL_PATCH default_patch[OPLL_TONE_NUM][(16 + 3) * 2];
 enum OPLL_EG_STATE
 { READY, ATTACK, DECAY, SUSHOLD, SUSTINE, RELEASE, SETTLE, FINISH };
 
-/* Phase incr table for Attack */
-static uint32_t dphaseARTable[16][16];
-/* Phase incr table for Decay and Release */
-static uint32_t dphaseDRTable[16][16];
-
 /* KSL + TL Table */
 static uint32_t tllTable[16][8][1 << TL_BITS][4];
 static int32_t rksTable[2][8][2];
 
-/* Phase incr table for PG */
-static uint32_t dphaseTable[512][8][16];
-
-// Added by jsr
-int32_t opll_volumes[10];
-
 /***************************************************
 
                   Create tables
@@ -323,7 +309,7 @@ makeAmTable (void)
 
 /* Phase increment counter table */
 static void
-makeDphaseTable (void)
+makeDphaseTable (OPLL * opll, uint32_t clk, uint32_t rate)
 {
   uint32_t fnum, block, ML;
   uint32_t mltable[16] =
@@ -332,7 +318,7 @@ makeDphaseTable (void)
   for (fnum = 0; fnum < 512; fnum++)
     for (block = 0; block < 8; block++)
       for (ML = 0; ML < 16; ML++)
-        dphaseTable[fnum][block][ML] = RATE_ADJUST (((fnum * mltable[ML]) << block) >> (20 - DP_BITS));
+        opll->dphaseTable[fnum][block][ML] = RATE_ADJUST (((fnum * mltable[ML]) << block) >> (20 - DP_BITS));
 }
 
 static void
@@ -410,7 +396,7 @@ static double decaytime[16][4] = {
 
 /* Rate Table for Attack */
 static void
-makeDphaseARTable (void)
+makeDphaseARTable (OPLL * opll, uint32_t clk, uint32_t rate)
 {
   int32_t AR, Rks, RM, RL;
 
@@ -440,16 +426,16 @@ makeDphaseARTable (void)
       switch (AR)
       {
       case 0:
-        dphaseARTable[AR][Rks] = 0;
+        opll->dphaseARTable[AR][Rks] = 0;
         break;
       case 15:
-        dphaseARTable[AR][Rks] = 0;/*EG_DP_WIDTH;*/
+        opll->dphaseARTable[AR][Rks] = 0;/*EG_DP_WIDTH;*/
         break;
       default:
 #ifdef USE_SPEC_ENV_SPEED
-        dphaseARTable[AR][Rks] = RATE_ADJUST (attacktable[RM][RL]);
+        opll->dphaseARTable[AR][Rks] = RATE_ADJUST (attacktable[RM][RL]);
 #else
-        dphaseARTable[AR][Rks] = RATE_ADJUST ((3 * (RL + 4) << (RM + 1)));
+        opll->dphaseARTable[AR][Rks] = RATE_ADJUST ((3 * (RL + 4) << (RM + 1)));
 #endif
         break;
       }
@@ -458,7 +444,7 @@ makeDphaseARTable (void)
 
 /* Rate Table for Decay and Release */
 static void
-makeDphaseDRTable (void)
+makeDphaseDRTable (OPLL * opll, uint32_t clk, uint32_t rate)
 {
   int32_t DR, Rks, RM, RL;
 
@@ -483,13 +469,13 @@ makeDphaseDRTable (void)
       switch (DR)
       {
       case 0:
-        dphaseDRTable[DR][Rks] = 0;
+        opll->dphaseDRTable[DR][Rks] = 0;
         break;
       default:
 #ifdef USE_SPEC_ENV_SPEED
-        dphaseDRTable[DR][Rks] = RATE_ADJUST (decaytable[RM][RL]);
+        opll->dphaseDRTable[DR][Rks] = RATE_ADJUST (decaytable[RM][RL]);
 #else
-        dphaseDRTable[DR][Rks] = RATE_ADJUST ((RL + 4) << (RM - 1));
+        opll->dphaseDRTable[DR][Rks] = RATE_ADJUST ((RL + 4) << (RM - 1));
 #endif
         break;
       }
@@ -607,27 +593,27 @@ calc_eg_dphase (OPLL_SLOT * slot)
   switch (slot->eg_mode)
   {
   case ATTACK:
-    return dphaseARTable[slot->patch->AR][slot->rks];
+    return slot->opll->dphaseARTable[slot->patch->AR][slot->rks];
 
   case DECAY:
-    return dphaseDRTable[slot->patch->DR][slot->rks];
+    return slot->opll->dphaseDRTable[slot->patch->DR][slot->rks];
 
   case SUSHOLD:
     return 0;
 
   case SUSTINE:
-    return dphaseDRTable[slot->patch->RR][slot->rks];
+    return slot->opll->dphaseDRTable[slot->patch->RR][slot->rks];
 
   case RELEASE:
     if (slot->sustine)
-      return dphaseDRTable[5][slot->rks];
+      return slot->opll->dphaseDRTable[5][slot->rks];
     else if (slot->patch->EG)
-      return dphaseDRTable[slot->patch->RR][slot->rks];
+      return slot->opll->dphaseDRTable[slot->patch->RR][slot->rks];
     else
-      return dphaseDRTable[7][slot->rks];
+      return slot->opll->dphaseDRTable[7][slot->rks];
 
   case SETTLE:
-    return dphaseDRTable[15][0];
+    return slot->opll->dphaseDRTable[15][0];
 
   case FINISH:
     return 0;
@@ -649,7 +635,7 @@ calc_eg_dphase (OPLL_SLOT * slot)
 #define SLOT_TOM 16
 #define SLOT_CYM 17
 
-#define UPDATE_PG(S)  (S)->dphase = dphaseTable[(S)->fnum][(S)->block][(S)->patch->ML]
+#define UPDATE_PG(S)  (S)->dphase = (S)->opll->dphaseTable[(S)->fnum][(S)->block][(S)->patch->ML]
 #define UPDATE_TLL(S)\
 (((S)->type==0)?\
 ((S)->tll = tllTable[((S)->fnum)>>5][(S)->block][(S)->patch->TL][(S)->patch->KL]):\
@@ -924,8 +910,9 @@ OPLL_copyPatch (OPLL * opll, int32_t num, OPLL_PATCH * patch)
 ***********************************************************/
 
 static void
-OPLL_SLOT_reset (OPLL_SLOT * slot, int type)
+OPLL_SLOT_reset (OPLL * opll, OPLL_SLOT * slot, int type)
 {
+  slot->opll = opll;
   slot->type = type;
   slot->sintbl = waveform[0];
   slot->phase = 0;
@@ -948,36 +935,34 @@ OPLL_SLOT_reset (OPLL_SLOT * slot, int type)
 }
 
 static void
-internal_refresh (void)
+internal_refresh (OPLL * opll, uint32_t rate)
 {
-  makeDphaseTable ();
-  makeDphaseARTable ();
-  makeDphaseDRTable ();
-  pm_dphase = (uint32_t) RATE_ADJUST (PM_SPEED * PM_DP_WIDTH / (clk / 72));
-  am_dphase = (uint32_t) RATE_ADJUST (AM_SPEED * AM_DP_WIDTH / (clk / 72));
+  uint32_t clk = opll->clk;
+
+  makeDphaseTable (opll, clk, rate);
+  makeDphaseARTable (opll, clk, rate);
+  makeDphaseDRTable (opll, clk, rate);
+  opll->pm_dphase = (uint32_t) RATE_ADJUST (PM_SPEED * PM_DP_WIDTH / (clk / 72));
+  opll->am_dphase = (uint32_t) RATE_ADJUST (AM_SPEED * AM_DP_WIDTH / (clk / 72));
 }
 
-static void
-maketables (uint32_t c, uint32_t r)
+/* // // // Builds the shared tables. Not thread-safe; call it once before
+   creating OPLL objects from multiple threads. */
+void
+OPLL_init_tables (void)
 {
-  if (c != clk)
-  {
-    clk = c;
-    makePmTable ();
-    makeAmTable ();
-    makeDB2LinTable ();
-    makeAdjustTable ();
-    makeTllTable ();
-    makeRksTable ();
-    makeSinTable ();
-    makeDefaultPatch ();
-  }
+  if (tables_ready)
+    return;
 
-  if (r != rate)
-  {
-    rate = r;
-    internal_refresh ();
-  }
+  makePmTable ();
+  makeAmTable ();
+  makeDB2LinTable ();
+  makeAdjustTable ();
+  makeTllTable ();
+  makeRksTable ();
+  makeSinTable ();
+  makeDefaultPatch ();
+  tables_ready = 1;
 }
 
 OPLL *
@@ -986,12 +971,16 @@ OPLL_new (uint32_t c, uint32_t r)
   OPLL *opll;
   int32_t i;
 
-  maketables (c, r);
+  OPLL_init_tables ();
 
   opll = (OPLL *) calloc (sizeof (OPLL), 1);
   if (opll == NULL)
     return NULL;
 
+  opll->clk = c;
+  opll->rate = r;
+  internal_refresh (opll, r);
+
   for (i = 0; i < 19 * 2; i++)
     memcpy(&opll->patch[i],&null_patch,sizeof(OPLL_PATCH));
 
@@ -1040,7 +1029,7 @@ OPLL_reset (OPLL * opll)
   opll->mask = 0;
 
   for (i = 0; i <18; i++)
-    OPLL_SLOT_reset(&opll->slot[i], i%2);
+    OPLL_SLOT_reset(opll, &opll->slot[i], i%2);
 
   for (i = 0; i < 9; i++)
   {
@@ -1052,8 +1041,8 @@ OPLL_reset (OPLL * opll)
     OPLL_writeReg (opll, i, 0);
 
 #ifndef EMU2413_COMPACTION
-  opll->realstep = (uint32_t) ((1 << 31) / rate);
-  opll->opllstep = (uint32_t) ((1 << 31) / (clk / 72));
+  opll->realstep = (uint32_t) ((1 << 31) / opll->rate);
+  opll->opllstep = (uint32_t) ((1 << 31) / (opll->clk / 72));
   opll->oplltime = 0;
   for (i = 0; i < 14; i++)
     opll->pan[i] = 2;
@@ -1087,19 +1076,15 @@ OPLL_forceRefresh (OPLL * opll)
 void
 OPLL_set_rate (OPLL * opll, uint32_t r)
 {
-  if (opll->quality)
-    rate = 49716;
-  else
-    rate = r;
-  internal_refresh ();
-  rate = r;
+  internal_refresh (opll, opll->quality ? 49716 : r);
+  opll->rate = r;
 }
 
 void
 OPLL_set_quality (OPLL * opll, uint32_t q)
 {
   opll->quality = q;
-  OPLL_set_rate (opll, rate);
+  OPLL_set_rate (opll, opll->rate);
 }
 
 /*********************************************************
@@ -1136,8 +1121,8 @@ OPLL_set_quality (OPLL * opll, uint32_t q)
 static void
 update_ampm (OPLL * opll)
 {
-  opll->pm_phase = (opll->pm_phase + pm_dphase) & (PM_DP_WIDTH - 1);
-  opll->am_phase = (opll->am_phase + am_dphase) & (AM_DP_WIDTH - 1);
+  opll->pm_phase = (opll->pm_phase + opll->pm_dphase) & (PM_DP_WIDTH - 1);
+  opll->am_phase = (opll->am_phase + opll->am_dphase) & (AM_DP_WIDTH - 1);
   opll->lfo_am = amtable[HIGHBITS (opll->am_phase, AM_DP_BITS - AM_PG_BITS)];
   opll->lfo_pm = pmtable[HIGHBITS (opll->pm_phase, PM_DP_BITS - PM_PG_BITS)];
 }
@@ -1407,8 +1392,8 @@ calc (OPLL * opll)
 		int32_t val = calc_slot_car (CAR(opll,i), calc_slot_mod(MOD(opll,i)));
 		inst += val;
 		int32_t absval = abs(val);		// // //
-		if (absval > opll_volumes[i])
-			opll_volumes[i] = absval;		// // //
+		if (absval > opll->chan_volumes[i])
+			opll->chan_volumes[i] = absval;		// // //
 	  }
 
   /* CH6 */
@@ -1861,9 +1846,9 @@ OPLL_calc_stereo (OPLL * opll, int32_t out[2])
 #endif /* EMU2413_COMPACTION */
 
 
-int32_t OPLL_getchanvol(int i)
+int32_t OPLL_getchanvol(OPLL *opll, int i)		// // //
 {
-	int retval = opll_volumes[i];
-	opll_volumes[i] = 0;
+	int retval = opll->chan_volumes[i];
+	opll->chan_volumes[i] = 0;
 	return retval;
 }
@@ -22,9 +22,12 @@ typedef struct __OPLL_PATCH {
   uint32_t TL,FB,EG,ML,AR,DR,SL,RR,KR,KL,AM,PM,WF ;
 } OPLL_PATCH ;
 
+struct __OPLL;
+
 /* slot */
 typedef struct __OPLL_SLOT {
 
+  struct __OPLL *opll;  /* // // // owner, for the rate-dependent tables */
   OPLL_PATCH *patch;
 
   int32_t type ;          /* 0 : modulator 1 : carrier */
@@ -107,9 +110,28 @@ typedef struct __OPLL {
 
   uint32_t mask ;
 
+  /* // // // Input clock and sampling rate */
+  uint32_t clk ;
+  uint32_t rate ;
+
+  /* // // // Phase delta for LFO */
+  uint32_t pm_dphase ;
+  uint32_t am_dphase ;
+
+  /* // // // Phase incr table for Attack */
+  uint32_t dphaseARTable[16][16] ;
+  /* // // // Phase incr table for Decay and Release */
+  uint32_t dphaseDRTable[16][16] ;
+  /* // // // Phase incr table for PG */
+  uint32_t dphaseTable[512][8][16] ;
+
+  /* // // // Peak output of each melodic channel since the last OPLL_getchanvol */
+  int32_t chan_volumes[10] ;
+
 } OPLL ;
 
 /* Create Object */
+EMU2413_API void OPLL_init_tables(void) ;
 EMU2413_API OPLL *OPLL_new(uint32_t clk, uint32_t rate) ;
 EMU2413_API void OPLL_delete(OPLL *) ;
 
@@ -143,7 +165,7 @@ EMU2413_API uint32_t OPLL_toggleMask(OPLL *, uint32_t mask) ;
 
 #define dump2patch OPLL_dump2patch
 
-int32_t OPLL_getchanvol(int i);
+int32_t OPLL_getchanvol(OPLL *opll, int i);		// // //
 
 #ifdef __cplusplus
 }
@@ -21,27 +21,49 @@
 */
 
 #include "AudioDriver.h"
-#include "DirectSound.h"
+#include "AudioSink.h"		// // //
+#include "Assertion.h"		// // //
+#include "SampleConversion.h"		// // //
+#include <algorithm>		// // //
+#include <chrono>		// // //
+#include <limits>		// // //
 
 // 1kHz test tone
 //#define AUDIO_TEST
 
-// Enable audio dithering
-//#define DITHERING
+namespace {
 
-#ifdef DITHERING
-int dither(long size);
-#endif
+const int AUDIO_TIMEOUT = 2000;		// // // 2s buffer timeout
 
-CAudioDriver::CAudioDriver(IAudioCallback &Parent, std::unique_ptr<CDSoundChannel> pDevice, unsigned SampleSize) :
+const std::uint64_t NO_LATENCY_MARK = std::numeric_limits<std::uint64_t>::max();		// // //
+
+// // // queue length in bytes, rounded up to whole blocks
+unsigned GetQueueLimit(unsigned BlockSize, unsigned SampleSize, unsigned QueueLength) {
+	if (!BlockSize)
+		return 0;
+	unsigned Blocks = (QueueLength * (SampleSize / 8) + BlockSize - 1) / BlockSize;
+	return std::max(Blocks, 1u) * BlockSize;
+}
+
+} // namespace
+
+CAudioDriver::CAudioDriver(IAudioCallback &Parent, std::unique_ptr<CAudioSink> pDevice, unsigned SampleSize, unsigned QueueLength) :
+	m_pAudioSink(std::move(pDevice)),		// // //
 	m_Parent(Parent),
-	m_pDSoundChannel(std::move(pDevice)),
 	m_iSampleSize(SampleSize),
-	m_iBufSizeBytes(m_pDSoundChannel ? m_pDSoundChannel->GetBlockSize() : 0),
+	m_iBufSizeBytes(m_pAudioSink ? m_pAudioSink->GetBlockSize() : 0),
 	m_iBufSizeSamples(m_iBufSizeBytes / (SampleSize / 8)),
+	m_pMixBuffer(std::make_unique<float[]>(m_iBufSizeSamples)),		// // //
 	m_pAccumBuffer(std::make_unique<char[]>(m_iBufSizeBytes)),		// // //
-	m_iGraphBuffer(std::make_unique<int16_t[]>(m_iBufSizeSamples))
+	m_iGraphBuffer(std::make_unique<int16_t[]>(m_iBufSizeSamples)),
+	m_AudioQueue(GetQueueLimit(m_iBufSizeBytes, SampleSize, QueueLength)),		// // //
+	m_iQueueLimit(GetQueueLimit(m_iBufSizeBytes, SampleSize, QueueLength)),
+	m_iLatencyMark(NO_LATENCY_MARK)		// // //
 {
+	if (m_pAudioSink) {		// // //
+		m_bDeviceRunning = true;
+		m_DeviceThread = std::thread {[this] { DeviceThread(); }};
+	}
 }
 
 CAudioDriver::~CAudioDriver() {
@@ -50,18 +72,66 @@ CAudioDriver::~CAudioDriver() {
 
 void CAudioDriver::Reset() {
 	m_iBufferPtr = 0;
-	if (m_pDSoundChannel)
-		m_pDSoundChannel->ClearBuffer();
+	m_iLatencyMark = NO_LATENCY_MARK;		// // // the marked samples are dropped
+	if (m_pAudioSink) {
+		// // // the device thread owns the device buffer, let it drop everything queued
+		std::unique_lock<std::mutex> lock {m_mWait};
+		m_bResetRequest = true;
+		m_cvWait.notify_all();
+		m_cvWait.wait_for(lock, std::chrono::milliseconds {AUDIO_TIMEOUT}, [&] { return !m_bResetRequest; });
+	}
 }
 
-void CAudioDriver::FlushBuffer(array_view<int16_t> Buffer) {
-	if (!m_pDSoundChannel)
+void CAudioDriver::FlushBuffer(array_view<float> Buffer) {		// // //
+	// Called when the APU audio buffer is full and ready for playing; samples are
+	// converted one block at a time
+	if (!m_pAudioSink)
 		return;
 
-	if (m_iSampleSize == 8)
-		FillBuffer<uint8_t, 8>(Buffer);
+	while (!Buffer.empty()) {
+		Assert(m_iBufferPtr < m_iBufSizeSamples);
+		std::size_t Count = std::min<std::size_t>(Buffer.size(), m_iBufSizeSamples - m_iBufferPtr);
+		float *pBlock = m_pMixBuffer.get() + m_iBufferPtr;
+		Buffer.copy(pBlock, Count);
+		Buffer.remove_front(Count);
+
+#ifdef AUDIO_TEST
+		// 1000 Hz test tone
+		static double sine_phase = 0;
+		static double freq = 1000;
+		for (std::size_t i = 0; i < Count; ++i) {
+			pBlock[i] = static_cast<float>(sin(sine_phase) * 10000.0 / 32768.0);
+
+			// Sweep
+			//freq+=0.1;
+			if (freq > 20000)
+				freq = 20;
+
+			sine_phase += freq / (double(m_pAudioSink->GetSampleRate()) / 6.283184);
+			if (sine_phase > 6.283184)
+				sine_phase -= 6.283184;
+		}
+#endif /* AUDIO_TEST */
+
+		m_iBufferPtr += Count;
+
+		// If buffer is filled, throw it to direct sound
+		if (m_iBufferPtr >= m_iBufSizeSamples) {
+			ConvertBlock();
+			if (!PlayBuffer())
+				return;
+		}
+	}
+}
+
+void CAudioDriver::ConvertBlock() {		// // //
+	// The visualizer always receives 16-bit samples, which also detect clipping
+	array_view<float> Block {m_pMixBuffer.get(), m_iBufSizeSamples};
+	m_iClipCounter += ConvertSamples(Block, m_iGraphBuffer.get(), 16);
+	if (m_iSampleSize == 16)
+		std::copy_n(m_iGraphBuffer.get(), m_iBufSizeSamples, reinterpret_cast<int16_t *>(m_pAccumBuffer.get()));
 	else
-		FillBuffer<int16_t, 0>(Buffer);
+		ConvertSamples(Block, m_pAccumBuffer.get(), m_iSampleSize);
 
 	if (m_iClipCounter > 50) {
 		// Ignore some clipping to allow the HP-filter adjust itself
@@ -77,36 +147,125 @@ bool CAudioDriver::PlayBuffer() {
 }
 
 bool CAudioDriver::DoPlayBuffer() {
-	const int AUDIO_TIMEOUT = 2000;		// // // 2s buffer timeout
+	// // // Wait until the queue has room for the block, this only blocks once the
+	// emulation is a full queue ahead of the device; the queue is measured from the
+	// producer side, since the capacity may exceed the block-rounded limit
+	const std::size_t MinFree = m_AudioQueue.GetCapacity() - m_iQueueLimit + m_iBufSizeBytes;
+	{
+		std::unique_lock<std::mutex> lock {m_mWait};
+		bool Ready = m_cvWait.wait_for(lock, std::chrono::milliseconds {AUDIO_TIMEOUT}, [&] {
+			return m_bInterrupted || m_AudioQueue.GetWriteAvailable() >= MinFree;
+		});
+		if (!Ready)
+			// Buffer timeout
+			m_bBufferTimeout = true;
+		if (!Ready || m_bInterrupted.exchange(false)) {
+			// Custom event, quit
+			m_iBufferPtr = 0;
+			return false;
+		}
+	}
 
-	// Output to direct sound
-	DWORD dwEvent;
+	// Queue audio for the device
+	m_AudioQueue.Write(ReleaseSoundBuffer());		// // //
+	m_iBytesQueued += m_iBufSizeBytes;
+	NotifyWaiting();		// // //
 
-	// Wait for a buffer event
-	while ((dwEvent = m_pDSoundChannel->WaitForSyncEvent(AUDIO_TIMEOUT)) != BUFFER_IN_SYNC) {
-		switch (dwEvent) {
+	// Reset buffer position
+	m_bBufferTimeout = false;
+
+	return true;
+}
+
+void CAudioDriver::DeviceThread() {		// // //
+	auto pBlock = std::make_unique<char[]>(m_iBufSizeBytes);
+
+	// sinks without a clock receive every queued block before the thread exits
+	while (m_bDeviceRunning || (!m_pAudioSink->IsClocked() && m_AudioQueue.GetReadAvailable() >= m_iBufSizeBytes)) {
+		if (m_bResetRequest) {
+			m_pAudioSink->ClearBuffer();
+			m_iBytesPlayed += m_AudioQueue.Discard(m_AudioQueue.GetReadAvailable());
+			m_bQueuePrimed = false;
+			m_bResetRequest = false;
+			NotifyWaiting();
+			continue;
+		}
+
+		// Wait for a buffer event
+		switch (m_pAudioSink->WaitForSyncEvent(AUDIO_TIMEOUT)) {
+			case BUFFER_IN_SYNC:
+				PullBlock(pBlock.get());
+				break;
 			case BUFFER_TIMEOUT:
 				// Buffer timeout
 				m_bBufferTimeout = true;
+				NotifyWaiting();
+				break;
 			case BUFFER_CUSTOM_EVENT:
-				// Custom event, quit
-				m_iBufferPtr = 0;
-				return false;
+				// Custom event, pass it on to the emulation
+				m_bInterrupted = true;
+				NotifyWaiting();
+				break;
 			case BUFFER_OUT_OF_SYNC:
 				// Buffer underrun detected
 				++m_iAudioUnderruns;
 				m_bBufferUnderrun = true;
 				break;
+			case BUFFER_NONE:
+				// Device error, try again later
+				std::this_thread::sleep_for(std::chrono::milliseconds {1});
+				break;
 		}
 	}
+}
 
-	// Write audio to buffer
-	m_pDSoundChannel->WriteBuffer(ReleaseSoundBuffer());		// // //
+void CAudioDriver::PullBlock(char *pBlock) {		// // //
+	if (!m_pAudioSink->IsClocked()) {
+		// Sinks without a clock of their own wait for the emulation instead
+		std::unique_lock<std::mutex> lock {m_mWait};
+		m_cvWait.wait_for(lock, std::chrono::milliseconds {AUDIO_TIMEOUT}, [&] {
+			return !m_bDeviceRunning || m_bResetRequest || m_AudioQueue.GetReadAvailable() >= m_iBufSizeBytes;
+		});
+		if (m_AudioQueue.GetReadAvailable() < m_iBufSizeBytes)
+			return;
+	}
 
-	// Reset buffer position
-	m_bBufferTimeout = false;
+	bool Queued = m_AudioQueue.GetReadAvailable() >= m_iBufSizeBytes;		// // //
+	if (Queued) {
+		m_AudioQueue.Read(pBlock, m_iBufSizeBytes);
+		m_iBytesPlayed += m_iBufSizeBytes;
+		m_bQueuePrimed = true;
+		m_bBufferTimeout = false;
+		NotifyWaiting();
+	}
+	else {
+		// Emulation fell behind, play silence instead of waiting for it
+		std::fill_n(pBlock, m_iBufSizeBytes, m_iSampleSize == 8 ? '\x80' : '\0');
+		if (m_bQueuePrimed) {
+			++m_iAudioUnderruns;
+			m_bBufferUnderrun = true;
+		}
+	}
 
-	return true;
+	m_pAudioSink->WriteBuffer({pBlock, m_iBufSizeBytes});
+
+	// // // the marked samples are now in the device
+	if (Queued && m_iLatencyMark.load(std::memory_order_acquire) < m_iBytesPlayed) {
+		using ms = std::chrono::duration<double, std::milli>;
+		auto KeyTime = std::chrono::steady_clock::time_point {std::chrono::steady_clock::duration {m_iLatencyKeyTime.load()}};
+		auto Elapsed = ms(std::chrono::steady_clock::now() - KeyTime).count();
+		m_fLatency = Elapsed + 1000. * m_pAudioSink->GetOutputLatency() / m_pAudioSink->GetSampleRate();
+		m_iLatencyMark = NO_LATENCY_MARK;
+	}
+}
+
+void CAudioDriver::NotifyWaiting() {		// // //
+	// empty critical section so that the other thread cannot miss the
+	// notification between checking the queue and going to sleep
+	{
+		std::lock_guard<std::mutex> lock {m_mWait};
+	}
+	m_cvWait.notify_all();
 }
 
 array_view<char> CAudioDriver::ReleaseSoundBuffer() {
@@ -119,14 +278,18 @@ array_view<std::int16_t> CAudioDriver::ReleaseGraphBuffer() {
 }
 
 void CAudioDriver::CloseAudioDevice() {
-	if (m_pDSoundChannel) {
-		m_pDSoundChannel->Stop();
-		m_pDSoundChannel.reset();		// // //
+	if (m_pAudioSink) {
+		m_bDeviceRunning = false;		// // //
+		NotifyWaiting();
+		if (m_DeviceThread.joinable())
+			m_DeviceThread.join();
+		m_pAudioSink->Stop();
+		m_pAudioSink.reset();		// // //
 	}
 }
 
 bool CAudioDriver::IsAudioDeviceOpen() const {
-	return static_cast<bool>(m_pDSoundChannel);
+	return static_cast<bool>(m_pAudioSink);
 }
 
 bool CAudioDriver::GetSoundTimeout() const {
@@ -134,7 +297,7 @@ bool CAudioDriver::GetSoundTimeout() const {
 }
 
 bool CAudioDriver::DidBufferUnderrun() {
-	return std::exchange(m_bBufferUnderrun, false);
+	return m_bBufferUnderrun.exchange(false);		// // //
 }
 
 bool CAudioDriver::WasAudioClipping() {
@@ -145,57 +308,13 @@ unsigned CAudioDriver::GetUnderruns() const {
 	return m_iAudioUnderruns;
 }
 
-template <class T, int SHIFT>
-void CAudioDriver::FillBuffer(array_view<int16_t> Buffer)		// // //
-{
-	// Called when the APU audio buffer is full and
-	// ready for playing
-
-	auto pConversionBuffer = reinterpret_cast<T *>(m_pAccumBuffer.get());		// // //
-
-	for (int16_t Sample : Buffer) {		// // //
-		// 1000 Hz test tone
-#ifdef AUDIO_TEST
-		static double sine_phase = 0;
-		Sample = int32_t(sin(sine_phase) * 10000.0);
-
-		static double freq = 1000;
-		// Sweep
-		//freq+=0.1;
-		if (freq > 20000)
-			freq = 20;
-
-		sine_phase += freq / (double(m_pDSoundChannel->GetSampleRate()) / 6.283184);
-		if (sine_phase > 6.283184)
-			sine_phase -= 6.283184;
-#endif /* AUDIO_TEST */
-
-		// Clip detection
-		if (Sample == std::numeric_limits<int16_t>::max() || Sample == std::numeric_limits<int16_t>::min())
-			++m_iClipCounter;
-
-		ASSERT(m_iBufferPtr < m_iBufSizeSamples);
-
-		// Visualizer
-		m_iGraphBuffer[m_iBufferPtr] = (short)Sample;
-
-		// Convert sample and store in temp buffer
-#ifdef DITHERING
-		if (SHIFT > 0)
-			Sample = (Sample + dither(1 << SHIFT)) >> SHIFT;
-#else
-		Sample >>= SHIFT;
-#endif
-
-		if (SHIFT == 8)
-			Sample ^= 0x80;
-
-		pConversionBuffer[m_iBufferPtr++] = (T)Sample;
+void CAudioDriver::MarkLatency(std::chrono::steady_clock::time_point KeyTime) {		// // //
+	if (!m_pAudioSink || m_iLatencyMark.load(std::memory_order_acquire) != NO_LATENCY_MARK)
+		return;
+	m_iLatencyKeyTime = KeyTime.time_since_epoch().count();
+	m_iLatencyMark.store(m_iBytesQueued + m_iBufferPtr * (m_iSampleSize / 8), std::memory_order_release);
+}
 
-		// If buffer is filled, throw it to direct sound
-		if (m_iBufferPtr >= m_iBufSizeSamples) {
-			if (!PlayBuffer())
-				return;
-		}
-	}
+double CAudioDriver::GetLatency() const {		// // //
+	return m_fLatency;
 }
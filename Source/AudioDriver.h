@@ -26,20 +26,31 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <atomic>		// // //
+#include <chrono>		// // //
+#include <thread>		// // //
+#include <mutex>		// // //
+#include <condition_variable>		// // //
 #include "Common.h"
 #include "array_view.h"
+#include "RingBuffer.h"		// // //
 
-class CDSoundChannel;
+class CAudioSink;
+
+// // // Converted audio blocks are queued in a lock-free ring buffer and written to
+// the sink by a separate thread whenever the sink requests a block, so the
+// emulation may run ahead of the sink by the queue length
 
 class CAudioDriver : public IAudioCallback {
 public:
 	CAudioDriver(const CAudioDriver &) = delete;
 	virtual ~CAudioDriver();
 
-	CAudioDriver(IAudioCallback &Parent, std::unique_ptr<CDSoundChannel> pDevice, unsigned SampleSize);
+	// QueueLength is the number of samples the emulation may run ahead of the device
+	CAudioDriver(IAudioCallback &Parent, std::unique_ptr<CAudioSink> pDevice, unsigned SampleSize, unsigned QueueLength);
 
 	void Reset();
-	void FlushBuffer(array_view<int16_t> Buffer) override;
+	void FlushBuffer(array_view<float> Buffer) override;		// // //
 	bool PlayBuffer() override;
 	bool DoPlayBuffer();
 	array_view<char> ReleaseSoundBuffer();
@@ -53,23 +64,50 @@ public:
 	bool WasAudioClipping();
 	unsigned GetUnderruns() const;
 
+	// // // Key-to-sound latency, KeyTime is passed as soon as the emulation begins
+	// producing the samples of the key press; only one key is measured at a time
+	void MarkLatency(std::chrono::steady_clock::time_point KeyTime);
+	// Latency of the last measured key including the device buffer, in milliseconds, 0 if none
+	double GetLatency() const;
+
 private:
-	template <class T, int SHIFT>
-	void FillBuffer(array_view<int16_t> Buffer);		// // //
+	void ConvertBlock();		// // //
+	void DeviceThread();		// // //
+	void PullBlock(char *pBlock);		// // //
+	void NotifyWaiting();		// // //
 
 private:
-	std::unique_ptr<CDSoundChannel> m_pDSoundChannel;		// // // directsound channel
+	std::unique_ptr<CAudioSink> m_pAudioSink;			// // // output device
 	IAudioCallback		&m_Parent;							// // //
 
 	unsigned int		m_iSampleSize;						// Size of samples, in bits
 	unsigned int		m_iBufSizeBytes = 0;				// Buffer size in bytes
 	unsigned int		m_iBufSizeSamples = 0;				// Buffer size in samples
 	unsigned int		m_iBufferPtr = 0;					// This will point in samples
+	std::unique_ptr<float[]> m_pMixBuffer;					// // // Samples of the current block before conversion
 	std::unique_ptr<char[]> m_pAccumBuffer;					// // //
 	std::unique_ptr<int16_t[]> m_iGraphBuffer;
-	unsigned int		m_iAudioUnderruns = 0;				// Keep track of underruns to inform user
-	bool				m_bBufferTimeout = false;
-	bool				m_bBufferUnderrun = false;
+	std::atomic<unsigned> m_iAudioUnderruns = 0;			// Keep track of underruns to inform user
+	std::atomic_bool	m_bBufferTimeout = false;
+	std::atomic_bool	m_bBufferUnderrun = false;
 	bool				m_bAudioClipping = false;
-	unsigned int		m_iClipCounter = 0;
+	std::size_t			m_iClipCounter = 0u;		// // //
+
+	// // // Device side
+	CRingBuffer<char>	m_AudioQueue;						// Blocks waiting for the device
+	unsigned int		m_iQueueLimit;						// Maximum number of bytes queued, in whole blocks
+	std::thread			m_DeviceThread;
+	std::atomic_bool	m_bDeviceRunning = false;
+	std::atomic_bool	m_bResetRequest = false;
+	std::atomic_bool	m_bInterrupted = false;				// Set when the device receives the custom event
+	bool				m_bQueuePrimed = false;				// Device thread only, no underruns before the first block
+	std::mutex			m_mWait;							// Only guards sleeping on either side, never the queue
+	std::condition_variable m_cvWait;
+
+	// // // Latency measurement, queue positions are in bytes since the driver was created
+	std::uint64_t		m_iBytesQueued = 0u;				// Emulation side
+	std::uint64_t		m_iBytesPlayed = 0u;				// Device side
+	std::atomic<std::uint64_t> m_iLatencyMark;				// Position of the marked samples
+	std::atomic<std::chrono::steady_clock::rep> m_iLatencyKeyTime = 0;
+	std::atomic<double>	m_fLatency = 0.;
 };
@@ -0,0 +1,75 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+
+#pragma once
+
+#include "array_view.h"
+
+// // // Output device selected in the sound settings
+enum audio_sink_t {
+	AUDIO_SINK_DIRECTSOUND,
+	AUDIO_SINK_NULL,
+	AUDIO_SINK_FILE,
+};
+
+// Return values from WaitForSyncEvent()
+enum buffer_event_t {
+	BUFFER_NONE = 0,
+	BUFFER_CUSTOM_EVENT = 1,
+	BUFFER_TIMEOUT,
+	BUFFER_IN_SYNC,
+	BUFFER_OUT_OF_SYNC,
+};
+
+// // // Audio output device used by CAudioDriver. The device is split into blocks
+// of GetBlockSize() bytes; WaitForSyncEvent returns BUFFER_IN_SYNC each time a
+// block may be written with WriteBuffer
+
+class CAudioSink {
+public:
+	virtual ~CAudioSink() noexcept = default;
+
+	virtual bool Play() = 0;
+	virtual bool Stop() = 0;
+	virtual bool IsPlaying() const = 0;
+	// Fills the device buffer with silence and stops playback
+	virtual bool ClearBuffer() = 0;
+	// Writes exactly one block
+	virtual bool WriteBuffer(array_view<char> Buffer) = 0;
+
+	// Starts playback if necessary and waits for the next free block, in milliseconds
+	virtual buffer_event_t WaitForSyncEvent(unsigned Timeout) = 0;
+
+	// True if the device consumes blocks at the sample rate on its own; blocks
+	// that are not ready in time are then replaced with silence. Otherwise the
+	// driver waits for every block before writing it
+	virtual bool IsClocked() const = 0;
+
+	virtual int GetBlockSize() const = 0;		// in bytes
+	virtual int GetSampleSize() const = 0;		// in bits
+	virtual int GetSampleRate() const = 0;
+	virtual int GetChannels() const = 0;
+
+	// Samples played by the device between writing a block and hearing its first sample
+	virtual int GetOutputLatency() const { return 0; }
+};
@@ -0,0 +1,69 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "BatchRenderer.h"
+#include <thread>
+#include <algorithm>
+#include "OfflineRenderer.h"
+#include "WaveRenderer.h"
+
+CBatchRenderer::CBatchRenderer(const CFamiTrackerModule &modfile) : modfile_(modfile) {
+}
+
+CBatchRenderer::~CBatchRenderer() {
+}
+
+void CBatchRenderer::AddTrack(unsigned Track, std::shared_ptr<CWaveRenderer> pRender) {
+	pRender->SetRenderTrack(Track);
+	jobs_.push_back(std::make_unique<COfflineRenderer>(modfile_, std::move(pRender)));
+}
+
+std::size_t CBatchRenderer::Render(unsigned Threads) {
+	if (!Threads)
+		Threads = std::max(std::thread::hardware_concurrency(), 1u);
+	Threads = std::min<unsigned>(Threads, jobs_.size());
+
+	std::atomic<std::size_t> next = 0;
+	std::atomic<std::size_t> rendered = 0;
+	auto worker = [&] {
+		// renderers share nothing but the module, which is only read during rendering
+		for (std::size_t i = next++; i < jobs_.size() && !cancel_; i = next++)
+			if (jobs_[i]->Render())
+				++rendered;
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < Threads; ++i)
+		pool.emplace_back(worker);
+	if (Threads)
+		worker();
+	for (auto &t : pool)
+		t.join();
+
+	return rendered;
+}
+
+void CBatchRenderer::Cancel() {
+	cancel_ = true;
+	for (auto &x : jobs_)
+		x->Cancel();
+}
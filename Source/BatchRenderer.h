@@ -0,0 +1,54 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+class CFamiTrackerModule;
+class CWaveRenderer;
+class COfflineRenderer;
+
+// // // Renders multiple tracks of a module concurrently; every track gets its own
+// offline renderer (APU, sound driver and wave renderer) and runs on a worker pool
+
+class CBatchRenderer {
+public:
+	explicit CBatchRenderer(const CFamiTrackerModule &modfile);
+	~CBatchRenderer();
+
+	// The renderer must already have an output file
+	void AddTrack(unsigned Track, std::shared_ptr<CWaveRenderer> pRender);
+
+	// Renders all added tracks using at most Threads workers, or one worker per
+	// hardware thread if zero; returns the number of tracks rendered completely
+	std::size_t Render(unsigned Threads = 0);
+	// Safe to call from any thread
+	void Cancel();
+
+private:
+	const CFamiTrackerModule &modfile_;
+	std::vector<std::unique_ptr<COfflineRenderer>> jobs_;
+	std::atomic_bool cancel_ = false;
+};
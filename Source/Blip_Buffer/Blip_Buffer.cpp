@@ -2,6 +2,7 @@
 // Blip_Buffer 0.4.0. http://www.slack.net/~ant/
 
 #include "Blip_Buffer/Blip_Buffer.h"
+#include "Blip_Buffer/Blip_Kernels.h"		// // //
 
 #include <assert.h>
 #include <limits.h>
@@ -43,7 +44,7 @@ Blip_Buffer::Blip_Buffer()
 		long i = LONG_MIN;
 		assert( (i >> 1) == LONG_MIN / 2 );
 		i = LONG_MIN;
-		assert( (i >> 31) == -1 );
+		assert( (i >> (sizeof i * CHAR_BIT - 1)) == -1 ); // // // long is 64-bit on LP64
 
 		// casting to smaller signed type truncates bits and extends sign
 		i = (SHRT_MAX + 1) * 5;
@@ -167,8 +168,9 @@ void Blip_Buffer::remove_samples( long count )
 
 // Blip_Synth_
 
-Blip_Synth_::Blip_Synth_( short* p, int w ) :
+Blip_Synth_::Blip_Synth_( short* p, short* r, int w ) :		// // //
 	impulses( p ),
+	rows( r ),
 	width( w )
 {
 	volume_unit_ = 0.0;
@@ -176,6 +178,10 @@ Blip_Synth_::Blip_Synth_( short* p, int w ) :
 	buf = 0;
 	last_amp = 0;
 	delta_factor = 0;
+
+	// // // a call to the portable kernel is slower than the inline code
+	blip_synth_kernel_t best = blip_kernels().synth;
+	kernel = best != blip_kernel_set( 0 )->synth ? best : 0;
 }
 
 static double const pi = 3.1415926535897932384626433832795029;
@@ -255,6 +261,21 @@ void Blip_Synth_::adjust_impulse()
 	//      printf( "%5ld,", impulses [j * blip_res + i + 1] );
 }
 
+void Blip_Synth_::transpose_impulses()		// // //
+{
+	// same order as Blip_Synth::offset_resampled reads the impulses
+	int const half = width / 2;
+	for ( int phase = 0; phase < blip_res; phase++ )
+	{
+		short* row = rows + phase * width;
+		for ( int i = 0; i < half; i++ )
+		{
+			row [i] = impulses [blip_res * (i + 1) - phase];
+			row [width - 1 - i] = impulses [blip_res * i + phase];
+		}
+	}
+}
+
 void Blip_Synth_::treble_eq( blip_eq_t const& eq )
 {
 	float fimpulse [blip_res / 2 * (blip_widest_impulse_ - 1) + blip_res * 2];
@@ -294,6 +315,7 @@ void Blip_Synth_::treble_eq( blip_eq_t const& eq )
 		next += fimpulse [i + blip_res];
 	}
 	adjust_impulse();
+	transpose_impulses();		// // //
 
 	// volume might require rescaling
 	double vol = volume_unit_;
@@ -338,6 +360,7 @@ void Blip_Synth_::volume_unit( double new_unit )
 				for ( int i = impulses_size(); i--; )
 					impulses [i] = (short) (((impulses [i] + offset) >> shift) - offset2);
 				adjust_impulse();
+				transpose_impulses();		// // //
 			}
 		}
 		delta_factor = (int) floor( factor + 0.5 );
@@ -416,19 +439,86 @@ long Blip_Buffer::read_samples( blip_sample_t* out, long max_samples, int stereo
 	return count;
 }
 
-void Blip_Buffer::mix_samples( blip_sample_t const* in, long count )
+long Blip_Buffer::read_samples( float* out, long max_samples, int stereo )		// // //
 {
-	buf_t_* out = buffer_ + (offset_ >> BLIP_BUFFER_ACCURACY) + blip_widest_impulse_ / 2;
+	long count = samples_avail();
+	if ( count > max_samples )
+		count = max_samples;
 
-	int const sample_shift = blip_sample_bits - 16;
-	int prev = 0;
-	while ( count-- )
+	if ( count && !stereo )
 	{
-		long s = (long) *in++ << sample_shift;
-		*out += s - prev;
-		prev = s;
-		++out;
+		blip_lane_t lane = { buffer_, out, reader_accum };
+		blip_kernels().integrate( &lane, 1, count, bass_shift );
+		reader_accum = lane.accum;
+		remove_samples( count );
 	}
-	*out -= prev;
+	else if ( count )
+	{
+		int const sample_shift = blip_sample_bits - 24;
+		float const scale = 1.0f / (1 << 23);
+		int const bass_shift_ = this->bass_shift;
+		long accum = reader_accum;
+		buf_t_* in = buffer_;
+
+		for ( long n = count; n--; )
+		{
+			*out = (float) (accum >> sample_shift) * scale;
+			out += 2;
+			accum -= accum >> bass_shift_;
+			accum += *in++;
+		}
+
+		reader_accum = accum;
+		remove_samples( count );
+	}
+	return count;
+}
+
+void Blip_Buffer::read_samples( Blip_Buffer* const* buffers, float* const* dests, int count )		// // //
+{
+	if ( !count )
+		return;
+
+	// buffers created in the middle of a frame may be one sample apart from the others
+	long const samples = buffers [0]->samples_avail();
+	int const bass_shift_ = buffers [0]->bass_shift;
+
+	int const max_lanes = 16;
+	blip_lane_t lanes [max_lanes];
+	Blip_Buffer* lane_buffers [max_lanes];
+	int lane_count = 0;
+
+	for ( int i = 0; i <= count; i++ )
+	{
+		if ( i < count )
+		{
+			Blip_Buffer& b = *buffers [i];
+			if ( b.samples_avail() != samples || b.bass_shift != bass_shift_ )
+			{
+				b.read_samples( dests [i], b.samples_avail() );
+				continue;
+			}
+			lanes [lane_count].in = b.buffer_;
+			lanes [lane_count].out = dests [i];
+			lanes [lane_count].accum = b.reader_accum;
+			lane_buffers [lane_count++] = &b;
+			if ( lane_count < max_lanes )
+				continue;
+		}
+
+		blip_kernels().integrate( lanes, lane_count, samples, bass_shift_ );
+		for ( int l = 0; l < lane_count; l++ )
+		{
+			lane_buffers [l]->reader_accum = lanes [l].accum;
+			lane_buffers [l]->remove_samples( samples );
+		}
+		lane_count = 0;
+	}
+}
+
+void Blip_Buffer::mix_samples( blip_sample_t const* in, long count )
+{
+	buf_t_* out = buffer_ + (offset_ >> BLIP_BUFFER_ACCURACY) + blip_widest_impulse_ / 2;
+	blip_kernels().mix( out, in, count );		// // //
 }
 
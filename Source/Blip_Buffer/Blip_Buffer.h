@@ -36,6 +36,14 @@ public:
 	// easy interleving of two channels into a stereo output buffer.
 	long read_samples( blip_sample_t* dest, long max_samples, int stereo = 0 );
 
+	// // // Same as above, but without clamping; 1.0 is the full scale of a 16-bit
+	// sample, and in-range samples keep 24 bits of the internal resolution
+	long read_samples( float* dest, long max_samples, int stereo = 0 );
+
+	// // // Same as above for all available samples of several buffers, which are read
+	// together where they have the same number of samples and bass frequency
+	static void read_samples( Blip_Buffer* const* buffers, float* const* dests, int count );
+
 // Additional optional features
 
 	// Current output sample rate
@@ -133,19 +141,25 @@ private:
 	int const blip_res = 1 << BLIP_PHASE_BITS;
 	class blip_eq_t;
 
+	// // // Adds 'row [i] * delta' to 'out [i]' for 'width' values, see Blip_Kernels.h
+	typedef void (*blip_synth_kernel_t)( Blip_Buffer::buf_t_* out, short const* row, int width, int delta );
+
 	class Blip_Synth_ {
 		double volume_unit_;
 		short* const impulses;
+		short* const rows;		// // // impulse of each phase in output order
 		int const width;
 		long kernel_unit;
 		int impulses_size() const { return blip_res / 2 * width + 1; }
 		void adjust_impulse();
+		void transpose_impulses();		// // //
 	public:
 		Blip_Buffer* buf;
 		int last_amp;
 		int delta_factor;
+		blip_synth_kernel_t kernel;		// // // null if the inline code is used
 
-		Blip_Synth_( short* impulses, int width );
+		Blip_Synth_( short* impulses, short* rows, int width );
 		void treble_eq( blip_eq_t const& );
 		void volume_unit( double );
 	};
@@ -195,10 +209,11 @@ public:
 	}
 
 public:
-	explicit Blip_Synth(double range) : impl( impulses, quality ), range_( range < 0. ? -range : range ) { }		// // //
+	explicit Blip_Synth(double range) : impl( impulses, rows, quality ), range_( range < 0. ? -range : range ) { }		// // //
 private:
 	typedef short imp_t;
 	imp_t impulses [blip_res * (quality / 2) + 1];
+	imp_t rows [blip_res * quality];		// // //
 	Blip_Synth_ impl;
 	double range_;
 };
@@ -283,13 +298,20 @@ inline void Blip_Synth<quality>::offset_resampled( blip_resampled_time_t time,
 	assert( (long) (time >> BLIP_BUFFER_ACCURACY) < blip_buf->buffer_size_ );
 	delta *= impl.delta_factor;
 	int phase = (int) (time >> (BLIP_BUFFER_ACCURACY - BLIP_PHASE_BITS) & (blip_res - 1));
-	imp_t const* imp = impulses + blip_res - phase;
 	long* buf = blip_buf->buffer_ + (time >> BLIP_BUFFER_ACCURACY);
-	long i0 = *imp;
 
 	int const fwd = (blip_widest_impulse_ - quality) / 2;
 	int const rev = fwd + quality - 2;
 
+	if ( impl.kernel )		// // //
+	{
+		impl.kernel( buf + fwd, rows + phase * quality, quality, delta );
+		return;
+	}
+
+	imp_t const* imp = impulses + blip_res - phase;
+	long i0 = *imp;
+
 	BLIP_FWD( 0 )
 	if constexpr ( quality > 8  ) BLIP_FWD( 2 )		// // //
 	if constexpr ( quality > 12 ) BLIP_FWD( 4 )
@@ -0,0 +1,490 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "Blip_Buffer/Blip_Kernels.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define BLIP_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define BLIP_TARGET( isa )
+	#else
+		#define BLIP_TARGET( isa ) __attribute__(( target( isa ) ))
+	#endif
+#endif
+
+// Other architectures only have the portable kernels; a NEON set would be added
+// to supported_sets() the same way as the x86 ones.
+
+typedef Blip_Buffer::buf_t_ buf_t;
+
+static bool const wide_lanes = sizeof (buf_t) == 8; // long is 64-bit on LP64
+
+// same as in Blip_Buffer::read_samples
+static int const float_shift = blip_sample_bits - 24;
+static float const float_scale = 1.0f / (1 << 23);
+static int const mix_shift = blip_sample_bits - 16;
+
+// Portable
+
+static void synth_scalar( buf_t* out, short const* row, int width, int delta )
+{
+	for ( int i = 0; i < width; i++ )
+		out [i] += row [i] * (buf_t) delta;
+}
+
+static void integrate_scalar( blip_lane_t* lanes, int lane_count, long count, int bass_shift )
+{
+	for ( int l = 0; l < lane_count; l++ )
+	{
+		buf_t const* in = lanes [l].in;
+		float* out = lanes [l].out;
+		buf_t accum = lanes [l].accum;
+		for ( long n = count; n--; )
+		{
+			*out++ = (float) (accum >> float_shift) * float_scale;
+			accum -= accum >> bass_shift;
+			accum += *in++;
+		}
+		lanes [l].accum = accum;
+	}
+}
+
+static void mix_scalar( buf_t* out, blip_sample_t const* in, long count )
+{
+	int prev = 0;
+	while ( count-- )
+	{
+		buf_t s = (buf_t) *in++ << mix_shift;
+		*out += s - prev;
+		prev = s;
+		++out;
+	}
+	*out -= prev;
+}
+
+// Finishes the samples from 'first' on with the portable kernel
+static void integrate_tail( blip_lane_t* lanes, int lane_count, long first, long count, int bass_shift )
+{
+	if ( first == count )
+		return;
+	for ( int l = 0; l < lane_count; l++ )
+	{
+		blip_lane_t tail = { lanes [l].in + first, lanes [l].out + first, lanes [l].accum };
+		integrate_scalar( &tail, 1, count - first, bass_shift );
+		lanes [l].accum = tail.accum;
+	}
+}
+
+#ifdef BLIP_X86
+
+// SSE2, two 64-bit or four 32-bit values per vector
+
+BLIP_TARGET( "sse2" )
+static inline __m128i sign_extend_16_32( __m128i x, bool high )
+{
+	__m128i sign = _mm_srai_epi16( x, 15 );
+	return high ? _mm_unpackhi_epi16( x, sign ) : _mm_unpacklo_epi16( x, sign );
+}
+
+BLIP_TARGET( "sse2" )
+static inline __m128i sign_extend_32_64( __m128i x, bool high )
+{
+	__m128i sign = _mm_srai_epi32( x, 31 );
+	return high ? _mm_unpackhi_epi32( x, sign ) : _mm_unpacklo_epi32( x, sign );
+}
+
+// there is no 64-bit arithmetic shift; shift the sign bit along and subtract it
+BLIP_TARGET( "sse2" )
+static inline __m128i sra_epi64_sse2( __m128i x, __m128i count, __m128i sign )
+{
+	return _mm_sub_epi64( _mm_xor_si128( _mm_srl_epi64( x, count ), sign ), sign );
+}
+
+// 32-bit buffers only; SSE2 has no signed 64-bit product, and emulating it is
+// slower than the inline code of Blip_Synth, so 64-bit buffers use the portable kernel
+BLIP_TARGET( "sse2" )
+static void synth_sse2( buf_t* out, short const* row, int width, int delta )
+{
+	assert( width % 4 == 0 && !wide_lanes );
+	__m128i const d = _mm_set1_epi32( delta );
+	for ( int i = 0; i < width; i += 4 )
+	{
+		// the low 32 bits are the same for signed and unsigned products
+		__m128i c = sign_extend_16_32( _mm_loadl_epi64( (__m128i const*) (row + i) ), false );
+		__m128i p02 = _mm_mul_epu32( c, d );
+		__m128i p13 = _mm_mul_epu32( _mm_srli_epi64( c, 32 ), d );
+		__m128i p = _mm_unpacklo_epi32( _mm_shuffle_epi32( p02, _MM_SHUFFLE( 0, 0, 2, 0 ) ),
+				_mm_shuffle_epi32( p13, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+		__m128i* o = (__m128i*) (out + i);
+		_mm_storeu_si128( o, _mm_add_epi32( _mm_loadu_si128( o ), p ) );
+	}
+}
+
+BLIP_TARGET( "sse2" )
+static void integrate_sse2( blip_lane_t* lanes, int lane_count, long count, int bass_shift )
+{
+	__m128i const bass = _mm_cvtsi32_si128( bass_shift );
+	__m128 const scale = _mm_set1_ps( float_scale );
+	long const vec_count = count & ~3L;
+
+	if constexpr ( wide_lanes )
+	{
+		// two lanes at a time, two samples per step
+		__m128i const bass_sign = _mm_srl_epi64( _mm_set1_epi64x( INT64_MIN ), bass );
+		__m128i const float_sign = _mm_set1_epi64x( (int64_t) ((uint64_t) 1 << (63 - float_shift)) );
+		for ( ; lane_count >= 2; lanes += 2, lane_count -= 2 )
+		{
+			buf_t const* in0 = lanes [0].in;
+			buf_t const* in1 = lanes [1].in;
+			float* out0 = lanes [0].out;
+			float* out1 = lanes [1].out;
+			__m128i accum = _mm_set_epi64x( lanes [1].accum, lanes [0].accum );
+			__m128i bad = _mm_setzero_si128();
+			for ( long n = 0; n < vec_count; n += 2 )
+			{
+				__m128i a = _mm_loadu_si128( (__m128i const*) (in0 + n) );
+				__m128i b = _mm_loadu_si128( (__m128i const*) (in1 + n) );
+				__m128i x [2] = { _mm_unpacklo_epi64( a, b ), _mm_unpackhi_epi64( a, b ) };
+				__m128i s [2];
+				for ( int k = 0; k < 2; k++ )
+				{
+					s [k] = _mm_srli_epi64( accum, float_shift );
+					s [k] = _mm_sub_epi64( _mm_xor_si128( s [k], float_sign ), float_sign );
+					accum = _mm_sub_epi64( _mm_add_epi64( accum, x [k] ),
+							sra_epi64_sse2( accum, bass, bass_sign ) );
+					// float conversion below only sees the low 32 bits
+					bad = _mm_or_si128( bad, _mm_xor_si128( s [k], sign_extend_32_64(
+							_mm_shuffle_epi32( s [k], _MM_SHUFFLE( 3, 3, 2, 0 ) ), false ) ) );
+				}
+				// lane 0 sample 0, lane 1 sample 0, lane 0 sample 1, lane 1 sample 1
+				__m128 f = _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi64(
+						_mm_shuffle_epi32( s [0], _MM_SHUFFLE( 3, 3, 2, 0 ) ),
+						_mm_shuffle_epi32( s [1], _MM_SHUFFLE( 3, 3, 2, 0 ) ) ) ), scale );
+				f = _mm_shuffle_ps( f, f, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				_mm_storel_pi( (__m64*) (out0 + n), f );
+				_mm_storeh_pi( (__m64*) (out1 + n), f );
+			}
+			if ( _mm_movemask_epi8( _mm_cmpeq_epi32( bad, _mm_setzero_si128() ) ) != 0xFFFF )
+			{
+				integrate_scalar( lanes, 2, count, bass_shift );
+				continue;
+			}
+			alignas( 16 ) int64_t acc [2];
+			_mm_store_si128( (__m128i*) acc, accum );
+			lanes [0].accum = (long) acc [0];
+			lanes [1].accum = (long) acc [1];
+			integrate_tail( lanes, 2, vec_count, count, bass_shift );
+		}
+	}
+	else
+	{
+		// four lanes at a time, four samples per step
+		for ( ; lane_count >= 4; lanes += 4, lane_count -= 4 )
+		{
+			__m128i accum = _mm_set_epi32( lanes [3].accum, lanes [2].accum, lanes [1].accum, lanes [0].accum );
+			for ( long n = 0; n < vec_count; n += 4 )
+			{
+				__m128 x [4];
+				for ( int l = 0; l < 4; l++ )
+					x [l] = _mm_castsi128_ps( _mm_loadu_si128( (__m128i const*) (lanes [l].in + n) ) );
+				_MM_TRANSPOSE4_PS( x [0], x [1], x [2], x [3] );
+				__m128 f [4];
+				for ( int k = 0; k < 4; k++ )
+				{
+					f [k] = _mm_mul_ps( _mm_cvtepi32_ps( _mm_srai_epi32( accum, float_shift ) ), scale );
+					accum = _mm_sub_epi32( _mm_add_epi32( accum, _mm_castps_si128( x [k] ) ),
+							_mm_sra_epi32( accum, bass ) );
+				}
+				_MM_TRANSPOSE4_PS( f [0], f [1], f [2], f [3] );
+				for ( int l = 0; l < 4; l++ )
+					_mm_storeu_ps( lanes [l].out + n, f [l] );
+			}
+			alignas( 16 ) int32_t acc [4];
+			_mm_store_si128( (__m128i*) acc, accum );
+			for ( int l = 0; l < 4; l++ )
+				lanes [l].accum = acc [l];
+			integrate_tail( lanes, 4, vec_count, count, bass_shift );
+		}
+	}
+
+	integrate_scalar( lanes, lane_count, count, bass_shift );
+}
+
+BLIP_TARGET( "sse2" )
+static void mix_sse2( buf_t* out, blip_sample_t const* in, long count )
+{
+	if ( count < 9 )
+	{
+		mix_scalar( out, in, count );
+		return;
+	}
+
+	// the first sample is a difference against silence
+	*out++ += (buf_t) *in++ << mix_shift;
+	long n = count - 1;
+	for ( ; n >= 8; n -= 8, in += 8, out += 8 )
+	{
+		__m128i cur = _mm_loadu_si128( (__m128i const*) in );
+		__m128i prev = _mm_loadu_si128( (__m128i const*) (in - 1) );
+		for ( int h = 0; h < 2; h++ )
+		{
+			__m128i d = _mm_slli_epi32( _mm_sub_epi32( sign_extend_16_32( cur, h != 0 ),
+					sign_extend_16_32( prev, h != 0 ) ), mix_shift );
+			if constexpr ( wide_lanes )
+			{
+				for ( int q = 0; q < 2; q++ )
+				{
+					__m128i* o = (__m128i*) (out + h * 4 + q * 2);
+					_mm_storeu_si128( o, _mm_add_epi64( _mm_loadu_si128( o ), sign_extend_32_64( d, q != 0 ) ) );
+				}
+			}
+			else
+			{
+				__m128i* o = (__m128i*) (out + h * 4);
+				_mm_storeu_si128( o, _mm_add_epi32( _mm_loadu_si128( o ), d ) );
+			}
+		}
+	}
+	for ( ; n; n--, in++, out++ )
+		*out += ((buf_t) in [0] - in [-1]) << mix_shift;
+	*out -= (buf_t) in [-1] << mix_shift;
+}
+
+// AVX2, four 64-bit or eight 32-bit values per vector
+
+BLIP_TARGET( "avx2" )
+static void synth_avx2( buf_t* out, short const* row, int width, int delta )
+{
+	assert( width % 4 == 0 );
+	if constexpr ( wide_lanes )
+	{
+		__m256i const d = _mm256_set1_epi64x( delta );
+		for ( int i = 0; i < width; i += 4 )
+		{
+			__m256i c = _mm256_cvtepi16_epi64( _mm_loadl_epi64( (__m128i const*) (row + i) ) );
+			__m256i* o = (__m256i*) (out + i);
+			_mm256_storeu_si256( o, _mm256_add_epi64( _mm256_loadu_si256( o ), _mm256_mul_epi32( c, d ) ) );
+		}
+	}
+	else
+	{
+		int i = 0;
+		__m256i const d = _mm256_set1_epi32( delta );
+		for ( ; i + 8 <= width; i += 8 )
+		{
+			__m256i c = _mm256_cvtepi16_epi32( _mm_loadu_si128( (__m128i const*) (row + i) ) );
+			__m256i* o = (__m256i*) (out + i);
+			_mm256_storeu_si256( o, _mm256_add_epi32( _mm256_loadu_si256( o ), _mm256_mullo_epi32( c, d ) ) );
+		}
+		if ( i < width )
+		{
+			__m128i c = _mm_cvtepi16_epi32( _mm_loadl_epi64( (__m128i const*) (row + i) ) );
+			__m128i* o = (__m128i*) (out + i);
+			_mm_storeu_si128( o, _mm_add_epi32( _mm_loadu_si128( o ),
+					_mm_mullo_epi32( c, _mm256_castsi256_si128( d ) ) ) );
+		}
+	}
+}
+
+BLIP_TARGET( "avx2" )
+static void integrate_avx2( blip_lane_t* lanes, int lane_count, long count, int bass_shift )
+{
+	if constexpr ( wide_lanes )
+	{
+		// four lanes at a time, four samples per step
+		__m128i const bass = _mm_cvtsi32_si128( bass_shift );
+		__m256i const bass_sign = _mm256_srl_epi64( _mm256_set1_epi64x( INT64_MIN ), bass );
+		__m256i const float_sign = _mm256_set1_epi64x( (int64_t) ((uint64_t) 1 << (63 - float_shift)) );
+		__m256i const low_half = _mm256_setr_epi32( 0, 2, 4, 6, 0, 2, 4, 6 );
+		__m128 const scale = _mm_set1_ps( float_scale );
+		long const vec_count = count & ~3L;
+
+		for ( ; lane_count >= 4; lanes += 4, lane_count -= 4 )
+		{
+			__m256i accum = _mm256_setr_epi64x( lanes [0].accum, lanes [1].accum, lanes [2].accum, lanes [3].accum );
+			__m256i good = _mm256_set1_epi64x( -1 );
+			for ( long n = 0; n < vec_count; n += 4 )
+			{
+				__m256i r [4];
+				for ( int l = 0; l < 4; l++ )
+					r [l] = _mm256_loadu_si256( (__m256i const*) (lanes [l].in + n) );
+				__m256i t0 = _mm256_unpacklo_epi64( r [0], r [1] );
+				__m256i t1 = _mm256_unpackhi_epi64( r [0], r [1] );
+				__m256i t2 = _mm256_unpacklo_epi64( r [2], r [3] );
+				__m256i t3 = _mm256_unpackhi_epi64( r [2], r [3] );
+				__m256i x [4] = {
+					_mm256_permute2x128_si256( t0, t2, 0x20 ),
+					_mm256_permute2x128_si256( t1, t3, 0x20 ),
+					_mm256_permute2x128_si256( t0, t2, 0x31 ),
+					_mm256_permute2x128_si256( t1, t3, 0x31 ),
+				};
+				__m128 f [4];
+				for ( int k = 0; k < 4; k++ )
+				{
+					__m256i s = _mm256_srli_epi64( accum, float_shift );
+					s = _mm256_sub_epi64( _mm256_xor_si256( s, float_sign ), float_sign );
+					__m256i b = _mm256_srl_epi64( accum, bass );
+					b = _mm256_sub_epi64( _mm256_xor_si256( b, bass_sign ), bass_sign );
+					accum = _mm256_sub_epi64( _mm256_add_epi64( accum, x [k] ), b );
+					// float conversion only sees the low 32 bits
+					__m128i s32 = _mm256_castsi256_si128( _mm256_permutevar8x32_epi32( s, low_half ) );
+					good = _mm256_and_si256( good, _mm256_cmpeq_epi64( s, _mm256_cvtepi32_epi64( s32 ) ) );
+					f [k] = _mm_mul_ps( _mm_cvtepi32_ps( s32 ), scale );
+				}
+				_MM_TRANSPOSE4_PS( f [0], f [1], f [2], f [3] );
+				for ( int l = 0; l < 4; l++ )
+					_mm_storeu_ps( lanes [l].out + n, f [l] );
+			}
+			if ( _mm256_movemask_epi8( good ) != -1 )
+			{
+				integrate_scalar( lanes, 4, count, bass_shift );
+				continue;
+			}
+			alignas( 32 ) int64_t acc [4];
+			_mm256_store_si256( (__m256i*) acc, accum );
+			for ( int l = 0; l < 4; l++ )
+				lanes [l].accum = (long) acc [l];
+			integrate_tail( lanes, 4, vec_count, count, bass_shift );
+		}
+	}
+
+	// 32-bit lanes already fit the SSE2 kernel
+	integrate_sse2( lanes, lane_count, count, bass_shift );
+}
+
+BLIP_TARGET( "avx2" )
+static void mix_avx2( buf_t* out, blip_sample_t const* in, long count )
+{
+	if ( count < 9 )
+	{
+		mix_scalar( out, in, count );
+		return;
+	}
+
+	*out++ += (buf_t) *in++ << mix_shift;
+	long n = count - 1;
+	for ( ; n >= 8; n -= 8, in += 8, out += 8 )
+	{
+		__m256i cur = _mm256_cvtepi16_epi32( _mm_loadu_si128( (__m128i const*) in ) );
+		__m256i prev = _mm256_cvtepi16_epi32( _mm_loadu_si128( (__m128i const*) (in - 1) ) );
+		__m256i d = _mm256_slli_epi32( _mm256_sub_epi32( cur, prev ), mix_shift );
+		if constexpr ( wide_lanes )
+		{
+			for ( int h = 0; h < 2; h++ )
+			{
+				__m128i half = h ? _mm256_extracti128_si256( d, 1 ) : _mm256_castsi256_si128( d );
+				__m256i* o = (__m256i*) (out + h * 4);
+				_mm256_storeu_si256( o, _mm256_add_epi64( _mm256_loadu_si256( o ), _mm256_cvtepi32_epi64( half ) ) );
+			}
+		}
+		else
+		{
+			__m256i* o = (__m256i*) out;
+			_mm256_storeu_si256( o, _mm256_add_epi32( _mm256_loadu_si256( o ), d ) );
+		}
+	}
+	for ( ; n; n--, in++, out++ )
+		*out += ((buf_t) in [0] - in [-1]) << mix_shift;
+	*out -= (buf_t) in [-1] << mix_shift;
+}
+
+static bool has_sse2()
+{
+#ifdef _MSC_VER
+	int info [4];
+	__cpuid( info, 1 );
+	return (info [3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports( "sse2" );
+#endif
+}
+
+static bool has_avx2()
+{
+#ifdef _MSC_VER
+	int info [4];
+	__cpuid( info, 0 );
+	if ( info [0] < 7 )
+		return false;
+	__cpuid( info, 1 );
+	if ( !(info [2] & (1 << 27)) ) // OSXSAVE
+		return false;
+	if ( (_xgetbv( 0 ) & 6) != 6 ) // XMM and YMM state saved by the OS
+		return false;
+	__cpuidex( info, 7, 0 );
+	return (info [1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports( "avx2" );
+#endif
+}
+
+#endif // BLIP_X86
+
+static blip_kernels_t const kernels_scalar = { "scalar", synth_scalar, integrate_scalar, mix_scalar };
+#ifdef BLIP_X86
+static blip_kernels_t const kernels_sse2 = { "sse2", wide_lanes ? synth_scalar : synth_sse2, integrate_sse2, mix_sse2 };
+static blip_kernels_t const kernels_avx2 = { "avx2", synth_avx2, integrate_avx2, mix_avx2 };
+#endif
+
+namespace {
+
+struct kernel_sets_t {
+	blip_kernels_t const* list [3];
+	int count;
+};
+
+kernel_sets_t const& supported_sets()
+{
+	static kernel_sets_t const sets = [] {
+		kernel_sets_t s = { };
+		s.list [s.count++] = &kernels_scalar;
+#ifdef BLIP_X86
+		if ( has_sse2() )
+		{
+			s.list [s.count++] = &kernels_sse2;
+			if ( has_avx2() )
+				s.list [s.count++] = &kernels_avx2;
+		}
+#endif
+		return s;
+	}();
+	return sets;
+}
+
+} // namespace
+
+blip_kernels_t const* blip_kernel_set( int index )
+{
+	kernel_sets_t const& sets = supported_sets();
+	return index >= 0 && index < sets.count ? sets.list [index] : 0;
+}
+
+blip_kernels_t const& blip_kernels()
+{
+	kernel_sets_t const& sets = supported_sets();
+	return *sets.list [sets.count - 1];
+}
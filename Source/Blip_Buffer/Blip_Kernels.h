@@ -0,0 +1,61 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+// Inner loops of Blip_Buffer and Blip_Synth, with vectorized versions chosen at
+// run time; every kernel set produces exactly the same output as the portable one
+
+#ifndef BLIP_KERNELS_H
+#define BLIP_KERNELS_H
+
+#include "Blip_Buffer/Blip_Buffer.h"
+
+// One buffer read by blip_kernels_t::integrate
+struct blip_lane_t {
+	Blip_Buffer::buf_t_ const* in;
+	float* out;
+	long accum;
+};
+
+struct blip_kernels_t {
+	// Name of the instruction set
+	char const* name;
+
+	// Adds 'row [i] * delta' to 'out [i]' for 'width' values, a multiple of 4
+	blip_synth_kernel_t synth;
+
+	// Runs the bass filter of Blip_Buffer over 'count' samples of every lane,
+	// writing floats as Blip_Buffer::read_samples does and updating the accumulators
+	void (*integrate)( blip_lane_t* lanes, int lane_count, long count, int bass_shift );
+
+	// Adds the first difference of 'count' 16-bit samples to 'out', as
+	// Blip_Buffer::mix_samples does
+	void (*mix)( Blip_Buffer::buf_t_* out, blip_sample_t const* in, long count );
+};
+
+// Kernels for the best instruction set supported by the processor
+blip_kernels_t const& blip_kernels();
+
+// Kernel sets supported by the processor, starting from the portable one at index 0;
+// returns NULL past the last set
+blip_kernels_t const* blip_kernel_set( int index );
+
+#endif
@@ -1009,6 +1009,12 @@ bool CChannelHandler::IsReleasing() const
 	return m_bRelease;
 }
 
+void CChannelHandler::SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos)		// // //
+{
+	if (m_pSoundGen)
+		m_pSoundGen->SetSequencePlayPos(std::move(pSequence), Pos);
+}
+
 /*
  * Class CChannelHandlerInverted
  *
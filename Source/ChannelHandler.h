@@ -329,6 +329,10 @@ public:		// // //
 	unsigned char GetArpParam() const;		// // //
 	bool	IsActive() const;
 	bool	IsReleasing() const;
+	/*!	\brief Reports the play position of an instrument sequence to the sound generator.
+		\param pSequence The sequence.
+		\param Pos The current position, or -1 if the sequence has stopped. */
+	void	SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos);		// // //
 
 private:
 	void	UpdateNoteCut();
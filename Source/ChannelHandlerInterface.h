@@ -26,6 +26,8 @@
 #include <memory>
 #include "array_view.h"
 
+class CSequence;		// // //
+
 /*!
 	\brief A pure virtual interface for channel handlers.
 	\details This class resembles the part of CSequenceHandler of the official build that is
@@ -51,6 +53,8 @@ public:
 
 	virtual bool	IsActive() const = 0;
 	virtual bool	IsReleasing() const = 0;
+
+	virtual void	SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos) = 0;		// // //
 };
 
 namespace ft0cc::doc {
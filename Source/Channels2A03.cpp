@@ -34,7 +34,7 @@
 #include "SeqInstHandler.h"		// // //
 #include "InstHandlerDPCM.h"		// // //
 #include "SongState.h"		// // //
-#include "SoundGen.h"		// // //
+#include "SoundGenBase.h"		// // //
 
 //#define NOISE_PITCH_SCALE
 
@@ -630,7 +630,7 @@ void CDPCMChan::RefreshChannel()
 		// Cut sample
 		m_pAPU->Write(0x4015, 0x0F);
 
-		if (!Env.GetSettings()->General.bNoDPCMReset || Env.GetSoundGenerator()->IsPlaying())		// // //
+		if (!Env.GetSettings()->General.bNoDPCMReset || m_pSoundGen->IsPlaying())		// // //
 			m_pAPU->Write(0x4011, 0);	// regain full volume for TN
 
 		m_bEnabled = false;		// don't write to this channel anymore
@@ -23,18 +23,37 @@
 #include "Chunk.h"
 #include "Assertion.h"		// // //
 
+// // //
+unsigned CChunkLabelTable::Intern(const stChunkLabel &label) {
+	auto [it, inserted] = m_Map.try_emplace(label, static_cast<unsigned>(m_vLabels.size()));
+	if (inserted)
+		m_vLabels.push_back(label);
+	return it->second;
+}
+
+const stChunkLabel &CChunkLabelTable::GetLabel(unsigned id) const {
+	return m_vLabels[id];
+}
+
+std::size_t CChunkLabelTable::GetCount() const {
+	return m_vLabels.size();
+}
+
 /**
  * CChunk - Stores NSF data
  *
  */
 
-CChunk::CChunk(const stChunkLabel &label) : m_stChunkLabel(label)		// // //
+CChunk::CChunk(const stChunkLabel &label, CChunkLabelTable &labels) :		// // //
+	m_stChunkLabel(label), m_pLabels(&labels), m_iLabelID(labels.Intern(label))
 {
 }
 
 void CChunk::Clear()
 {
-	m_vChunkData.clear();
+	m_vData.clear();		// // //
+	m_vItems.clear();
+	m_vRelocs.clear();
 }
 
 chunk_type_t CChunk::GetType() const
@@ -47,6 +66,11 @@ const stChunkLabel &CChunk::GetLabel() const
 	return m_stChunkLabel;
 }
 
+unsigned CChunk::GetLabelID() const		// // //
+{
+	return m_iLabelID;
+}
+
 void CChunk::SetBank(unsigned char Bank)
 {
 	m_iBank = Bank;
@@ -60,116 +84,148 @@ unsigned char CChunk::GetBank() const
 int CChunk::GetLength() const
 {
 	// Return number of data items in the collection
-	return m_vChunkData.size();
+	return m_vItems.size();
 }
 
 unsigned short CChunk::GetData(int index) const
 {
-	return m_vChunkData[index]->GetData();
+	const auto &item = m_vItems[index];		// // //
+	switch (item.Type) {
+	case item_t::byte: case item_t::bank:
+		return m_vData[item.Pos];
+	case item_t::word: case item_t::pointer:
+		return m_vData[item.Pos] | (m_vData[item.Pos + 1] << 8);
+	default:
+		return 0;	// Invalid for strings
+	}
 }
 
 unsigned short CChunk::GetDataSize(int index) const
 {
-	return m_vChunkData[index]->GetSize();
+	return m_vItems[index].Size;		// // //
 }
 
 void CChunk::StoreByte(unsigned char data)
 {
-	DoAddChunk<CChunkDataByte>(data);		// // //
+	AddItem(item_t::byte, 1);		// // //
+	m_vData.push_back(data);
 }
 
 void CChunk::StoreWord(unsigned short data)
 {
-	DoAddChunk<CChunkDataWord>(data);		// // //
+	AddItem(item_t::word, 2);		// // //
+	m_vData.push_back(data & 0xFF);
+	m_vData.push_back(data >> 8);
 }
 
 void CChunk::StorePointer(const stChunkLabel &label)		// // //
 {
-	DoAddChunk<CChunkDataPointer>(label);
+	AddItem(item_t::pointer, 2, m_vRelocs.size());
+	m_vRelocs.push_back({m_pLabels->Intern(label)});
+	m_vData.insert(m_vData.end(), 2, 0xFF);		// unresolved
 }
 
 void CChunk::StoreBankReference(const stChunkLabel &label, int bank)		// // //
 {
-	DoAddChunk<CChunkDataBank>(label, bank);
+	AddItem(item_t::bank, 1, m_vRelocs.size());
+	m_vRelocs.push_back({m_pLabels->Intern(label)});
+	m_vData.push_back(bank);
 }
 
 void CChunk::StoreString(const std::vector<unsigned char> &data)		// // //
 {
-	DoAddChunk<CChunkDataString>(data);		// // //
+	AddItem(item_t::string, data.size());
+	m_vData.insert(m_vData.end(), data.begin(), data.end());
 }
 
 void CChunk::ChangeByte(int index, unsigned char data)
 {
-	GetChunkData<CChunkDataByte>(index).m_data = data;		// // //
+	m_vData[GetItem(index, item_t::byte).Pos] = data;		// // //
 }
 
 void CChunk::SetupBankData(int index, unsigned char bank)
 {
-	GetChunkData<CChunkDataBank>(index).m_bank = bank;
+	m_vData[GetItem(index, item_t::bank).Pos] = bank;		// // //
 }
 
 unsigned char CChunk::GetStringData(int index, int pos) const
 {
-	return GetChunkData<const CChunkDataString>(index).m_vData[pos];
+	return m_vData[GetItem(index, item_t::string).Pos + pos];		// // //
 }
 
-const std::vector<unsigned char> &CChunk::GetStringData(int index) const
+array_view<unsigned char> CChunk::GetStringData(int index) const		// // //
 {
-	return GetChunkData<const CChunkDataString>(index).m_vData;
+	const auto &item = GetItem(index, item_t::string);
+	return {m_vData.data() + item.Pos, item.Size};
+}
+
+array_view<unsigned char> CChunk::GetBinaryData() const		// // //
+{
+	return m_vData;
 }
 
 stChunkLabel CChunk::GetDataPointerTarget(int index) const		// // //
 {
-	auto pChunkData = dynamic_cast<CChunkDataPointer *>(m_vChunkData[index].get());
-	return pChunkData ? pChunkData->m_Label : stChunkLabel { };
+	return IsDataPointer(index) ? m_pLabels->GetLabel(m_vRelocs[m_vItems[index].Reloc].Target) : stChunkLabel { };
+}
+
+unsigned CChunk::GetDataPointerTargetID(int index) const		// // //
+{
+	return IsDataPointer(index) ? m_vRelocs[m_vItems[index].Reloc].Target : CChunkLabelTable::NONE;
 }
 
-void CChunk::SetDataPointerTarget(int index, const stChunkLabel &label)		// // //
+unsigned CChunk::GetDataPointerOffset(int index) const		// // //
 {
-	if (auto pChunkData = dynamic_cast<CChunkDataPointer *>(m_vChunkData[index].get()))
-		pChunkData->m_Label = label;
+	return IsDataPointer(index) ? m_vRelocs[m_vItems[index].Reloc].Offset : 0u;
+}
+
+void CChunk::SetDataPointerTarget(int index, const stChunkLabel &label, unsigned offset)		// // //
+{
+	if (IsDataPointer(index))
+		m_vRelocs[m_vItems[index].Reloc] = {m_pLabels->Intern(label), offset};
 }
 
 bool CChunk::IsDataPointer(int index) const
 {
-	return dynamic_cast<CChunkDataPointer *>(m_vChunkData[index].get()) != nullptr;
+	return m_vItems[index].Type == item_t::pointer;		// // //
 }
 
 bool CChunk::IsDataBank(int index) const
 {
-	return dynamic_cast<CChunkDataBank *>(m_vChunkData[index].get()) != nullptr;
+	return m_vItems[index].Type == item_t::bank;		// // //
 }
 
 unsigned int CChunk::CountDataSize() const
 {
-	return m_iTotalSize;		// // //
+	return m_vData.size();		// // //
 }
 
-void CChunk::AssignLabels(std::map<stChunkLabel, int> &labelMap)		// // //
+void CChunk::AssignLabels(const std::vector<int> &Addresses)		// // //
 {
-	for (auto &x : m_vChunkData)
-		if (auto pChunkData = dynamic_cast<CChunkDataPointer *>(x.get())) {
-			if (auto it = labelMap.find(pChunkData->m_Label); it != labelMap.end())		// // //
-				pChunkData->ref = it->second;
+	for (const auto &item : m_vItems)
+		if (item.Type == item_t::pointer) {
+			const auto &reloc = m_vRelocs[item.Reloc];
+			if (int Address = Addresses[reloc.Target]; Address >= 0) {		// // //
+				unsigned short ref = Address + reloc.Offset;
+				m_vData[item.Pos] = ref & 0xFF;
+				m_vData[item.Pos + 1] = ref >> 8;
+			}
 			else
 				DEBUG_BREAK();
 		}
 }
 
 // // //
-template <typename T>
-T &CChunk::GetChunkData(std::size_t index) const {
+const CChunk::stChunkItem &CChunk::GetItem(int index, item_t Type) const {
 #ifdef _DEBUG		// // //
-	return dynamic_cast<T &>(*m_vChunkData.at(index));
+	const auto &item = m_vItems.at(index);
+	Assert(item.Type == Type);
+	return item;
 #else
-	return static_cast<T &>(*m_vChunkData[index]);
+	return m_vItems[index];
 #endif
 }
 
-template <typename T, typename... Args>
-void CChunk::DoAddChunk(Args&&... args) {
-	if (auto ptr = std::make_unique<T>(std::forward<Args>(args)...)) {
-		m_iTotalSize += ptr->GetSize();
-		m_vChunkData.push_back(std::move(ptr));
-	}
+void CChunk::AddItem(item_t Type, unsigned Size, unsigned Reloc) {
+	m_vItems.push_back({Type, static_cast<unsigned>(m_vData.size()), Size, Reloc});
 }
@@ -24,8 +24,9 @@
 #pragma once
 
 #include <vector>		// // //
-#include <memory>		// // //
-#include <map>		// // //
+#include <unordered_map>		// // //
+#include <tuple>		// // //
+#include "array_view.h"		// // //
 
 // Helper classes/objects for NSF compiling
 
@@ -72,67 +73,30 @@ struct stChunkLabel {
 	}
 };
 
-class CChunkData
-{
-protected:		// // //
-	CChunkData() = default;
-
-public:
-	virtual ~CChunkData() = default;
-	virtual int GetSize() const = 0;
-	virtual unsigned short GetData() const = 0;
-};
-
-class CChunkDataByte : public CChunkData
-{
-public:
-	CChunkDataByte(unsigned char data) : CChunkData(), m_data(data) { }
-	int GetSize() const override { return 1; }
-
-	unsigned short GetData() const override { return m_data; }
-	unsigned char m_data;
-};
-
-class CChunkDataWord : public CChunkData
-{
-public:
-	CChunkDataWord(unsigned short data) : CChunkData(), m_data(data) { }
-	int GetSize() const override { return 2; }
-
-	unsigned short GetData() const override { return m_data; }
-	unsigned short m_data;
+// // //
+struct stChunkLabelHash {
+	std::size_t operator()(const stChunkLabel &label) const noexcept {
+		std::size_t h = label.Type;
+		for (unsigned x : {label.Param1, label.Param2, label.Param3})
+			h = h * 0x9E3779B1u + x;
+		return h;
+	}
 };
 
-class CChunkDataPointer : public CChunkData
+// // // Interns chunk labels to dense IDs so that label resolution can use
+// plain arrays, labels referenced before their chunk exists get an ID too
+class CChunkLabelTable
 {
 public:
-	CChunkDataPointer(const stChunkLabel &label) : CChunkData(), m_Label(label) { }		// // //
-	int GetSize() const override { return 2; }
-	unsigned short GetData() const override { return ref; }
+	static constexpr unsigned NONE = static_cast<unsigned>(-1);
 
-	stChunkLabel m_Label;
-	unsigned short ref = 0xFFFF;
-};
+	unsigned		Intern(const stChunkLabel &label);
+	const stChunkLabel &GetLabel(unsigned id) const;
+	std::size_t		GetCount() const;
 
-class CChunkDataBank : public CChunkData
-{
-public:
-	CChunkDataBank(const stChunkLabel &label, int bank) : CChunkData(), m_Label(label), m_bank(bank) { }		// // //
-	int GetSize() const override { return 1; }
-	unsigned short GetData() const override { return m_bank; }
-
-	stChunkLabel m_Label;		// // // Reference to a label which belongs to the bank this data should point to
-	unsigned int m_bank;
-};
-
-class CChunkDataString : public CChunkData
-{
-public:
-	CChunkDataString(const std::vector<unsigned char> &data) : CChunkData(), m_vData(data) { }
-	int GetSize() const override { return m_vData.size(); }
-	unsigned short GetData() const override { return 0; }	// Invalid for this type
-
-	std::vector<unsigned char> m_vData;		// // //
+private:
+	std::unordered_map<stChunkLabel, unsigned, stChunkLabelHash> m_Map;
+	std::vector<stChunkLabel> m_vLabels;
 };
 
 //
@@ -142,12 +106,13 @@ public:
 class CChunk
 {
 public:
-	explicit CChunk(const stChunkLabel &label);		// // //
+	CChunk(const stChunkLabel &label, CChunkLabelTable &labels);		// // //
 
 	void			Clear();
 
 	chunk_type_t	GetType() const;
 	const stChunkLabel &GetLabel() const;		// // //
+	unsigned		GetLabelID() const;		// // //
 	void			SetBank(unsigned char Bank);
 	unsigned char	GetBank() const;
 
@@ -166,25 +131,47 @@ public:
 	void			SetupBankData(int index, unsigned char bank);
 
 	stChunkLabel	GetDataPointerTarget(int index) const;		// // //
-	void			SetDataPointerTarget(int index, const stChunkLabel &label);		// // //
+	unsigned		GetDataPointerTargetID(int index) const;		// // //
+	unsigned		GetDataPointerOffset(int index) const;		// // //
+	void			SetDataPointerTarget(int index, const stChunkLabel &label, unsigned offset = 0);		// // //
 
 	bool			IsDataPointer(int index) const;
 	bool			IsDataBank(int index) const;
 
 	unsigned char	GetStringData(int index, int pos) const;
-	const std::vector<unsigned char> &GetStringData(int index) const;
+	array_view<unsigned char> GetStringData(int index) const;		// // //
+	array_view<unsigned char> GetBinaryData() const;		// // //
 
-	void			AssignLabels(std::map<stChunkLabel, int> &labelMap);		// // //
+	void			AssignLabels(const std::vector<int> &Addresses);		// // // indexed by label ID
 
 private:
-	template <typename T>		// // //
-	T &GetChunkData(std::size_t index) const;
-	template <typename T, typename... Args>
-	void DoAddChunk(Args&&... args);
-
-	std::vector<std::unique_ptr<CChunkData>> m_vChunkData;		// // // List of data stored in this chunk
+	// // // Data items are views into one contiguous buffer, pointers and bank
+	// references keep their labels in a separate relocation table
+	enum class item_t : unsigned char {
+		byte, word, pointer, bank, string,
+	};
+
+	struct stChunkItem {
+		item_t Type;
+		unsigned Pos;			// Position in m_vData
+		unsigned Size;
+		unsigned Reloc;			// Index into m_vRelocs for pointers and bank references
+	};
+
+	struct stChunkReloc {
+		unsigned Target;		// Label ID
+		unsigned Offset = 0;	// Byte offset from the start of the labelled chunk
+	};
+
+	const stChunkItem &GetItem(int index, item_t Type) const;		// // //
+	void AddItem(item_t Type, unsigned Size, unsigned Reloc = 0);
+
+	std::vector<unsigned char> m_vData;		// // // Binary data of this chunk
+	std::vector<stChunkItem> m_vItems;		// // // List of data stored in this chunk
+	std::vector<stChunkReloc> m_vRelocs;		// // //
 
 	stChunkLabel m_stChunkLabel;		// // // Label of this chunk
+	CChunkLabelTable *m_pLabels;		// // //
+	unsigned m_iLabelID;		// // //
 	unsigned char m_iBank = 0;		// The bank this chunk will be stored in
-	unsigned m_iTotalSize = 0;		// // // cache
 };
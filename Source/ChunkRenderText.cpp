@@ -361,6 +361,8 @@ void CChunkRenderText::StoreFrameChunk(const CChunk *pChunk)
 			if (j++ > 0)
 				str += ", ";
 			str += GetLabelString(pChunk->GetDataPointerTarget(i));
+			if (unsigned Offset = pChunk->GetDataPointerOffset(i))		// // // shared pattern data
+				str += "+" + conv::from_uint(Offset);
 		}
 	}
 
@@ -386,7 +388,7 @@ void CChunkRenderText::StorePatternChunk(const CChunk *pChunk)
 	std::string str = "; Bank " + conv::from_uint(pChunk->GetBank()) + "\n";
 	str += GetLabelString(pChunk->GetLabel()) + ":\n";
 
-	const std::vector<unsigned char> &vec = pChunk->GetStringData(0);		// // //
+	auto vec = pChunk->GetStringData(0);		// // //
 	str += GetByteString(vec, DEFAULT_LINE_BREAK).data();
 /*
 	len = vec.size();
@@ -27,6 +27,13 @@
 #include "SoundGen.h"
 #include "TextExporter.h"
 #include "str_conv/str_conv.hpp"		// // //
+#include "FamiTrackerEnv.h"		// // //
+#include "Settings.h"		// // //
+#include "WaveFile.h"		// // //
+#include "WaveRenderer.h"		// // //
+#include "WaveRendererFactory.h"		// // //
+#include "BatchRenderer.h"		// // //
+#include "OfflineRenderer.h"		// // //
 
 // Command line export logger
 class CCommandLineLog : public CCompilerLog {
@@ -158,6 +165,36 @@ void CCommandLineExport::CommandLineExport(const CStringW &fileIn, const CString
 		}
 		return;
 	}
+	else if (0 == ext.CompareNoCase(L".wav")) {		// // //
+		// one file per track, rendered in parallel; multiple tracks are numbered
+		const CSettings *pSettings = Env.GetSettings();
+		const unsigned Tracks = pModule->GetSongCount();
+		CBatchRenderer batch {*pModule};
+		for (unsigned i = 0; i < Tracks; ++i) {
+			CStringW fileTrack = Tracks > 1 ? fileOut.Left(nPos) + FormattedW(L"_%02u", i + 1) + ext : fileOut;
+			auto pWave = std::make_unique<CWaveFile>();
+			if (!pWave->OpenFile(fileTrack, pSettings->Sound.iSampleRate, COfflineRenderer::GetOutputSampleSize(), COfflineRenderer::GetOutputChannels())) {		// // //
+				if (bLog) {
+					fLog.WriteString(L"Error: unable to open file: ");
+					fLog.WriteString(fileTrack);
+					fLog.WriteString(L"\n");
+				}
+				continue;
+			}
+			std::shared_ptr<CWaveRenderer> pRender = CWaveRendererFactory::Make(*pModule, i, render_type_t::Loops, 1);
+			pRender->SetOutputFile(std::move(pWave));
+			batch.AddTrack(i, std::move(pRender));
+			if (bLog) {
+				fLog.WriteString(L"Rendering: ");
+				fLog.WriteString(fileTrack);
+				fLog.WriteString(L"\n");
+			}
+		}
+		std::size_t Rendered = batch.Render();
+		if (bLog)
+			fLog.WriteString(FormattedW(L"\nWAV render complete, %u of %u tracks rendered.\n", (unsigned)Rendered, Tracks));
+		return;
+	}
 
 	// // //
 
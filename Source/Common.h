@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include "array_view.h"		// // //
+#include "APU/Types_fwd.h"		// // //
 
 enum decay_rate_t {		// // // 050B
 	DECAY_SLOW,
@@ -40,6 +41,12 @@ struct stDPCMState {
 // Used to play the audio when the buffer is full
 class IAudioCallback {
 public:
-	virtual void FlushBuffer(array_view<int16_t> Buffer) = 0;		// // //
+	virtual void FlushBuffer(array_view<float> Buffer) = 0;		// // // 1.0 is the full scale of the output, see SampleConversion.h
 	virtual bool PlayBuffer() = 0;		// // // return true if succeeded
 };
+
+// // // Receives the output of each channel alone when the APU renders stems
+class IStemCallback {
+public:
+	virtual void FlushStem(chan_id_t Chan, array_view<float> Buffer) = 0;
+};
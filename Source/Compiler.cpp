@@ -47,6 +47,12 @@
 #include "SongLengthScanner.h"		// // //
 #include "NumConv.h"		// // //
 #include "str_conv/str_conv.hpp"		// // //
+#include <thread>		// // //
+#include <atomic>		// // //
+#include <exception>		// // //
+#include <utility>		// // //
+#include <algorithm>		// // //
+#include <numeric>		// // //
 
 //
 // This is the new NSF data compiler, music is compiled to an object list instead of a binary chunk
@@ -97,6 +103,9 @@
 // Remove duplicated patterns (default on)
 #define REMOVE_DUPLICATE_PATTERNS
 
+// // // Point patterns into longer patterns that contain the same data, requires REMOVE_DUPLICATE_PATTERNS (default on)
+#define SHARE_PATTERN_DATA
+
 // Don't remove patterns across different tracks (default off)
 //#define LOCAL_DUPLICATE_PATTERN_REMOVAL
 
@@ -125,6 +134,75 @@ const int CCompiler::FLAG_BANKSWITCHED	= 1 << 0;
 const int CCompiler::FLAG_VIBRATO		= 1 << 1;
 const int CCompiler::FLAG_LINEARPITCH	= 1 << 2;		// // //
 
+namespace {
+
+// // // collects the messages of one pattern so that they can be printed in order
+class CBufferedLog : public CCompilerLog {
+public:
+	void WriteLog(std::string_view text) override {
+		text_ += text;
+	}
+	void Clear() override {
+		text_.clear();
+	}
+	std::string Take() {
+		return std::exchange(text_, std::string { });
+	}
+
+private:
+	std::string text_;
+};
+
+// // // pattern compiled in parallel by StorePatterns
+struct stCompiledPattern {
+	unsigned Pattern;
+	chan_id_t Channel;
+	std::vector<unsigned char> Data;
+	unsigned int Hash = 0;
+	unsigned int CompressedSize = 0;
+	std::string Log;
+	std::exception_ptr Error;
+	stChunkLabel Target;		// pattern whose chunk holds this data, CHUNK_NONE if stored here
+	unsigned Offset = 0;
+	CPatternCompilerCache::key_t Key = { };		// // //
+	bool Cached = false;
+};
+
+// // // Every string of up to this many bytes in the stored pattern data is
+// indexed, a pattern is only compared against hosts that begin the same way
+constexpr std::size_t PATTERN_INDEX_LENGTH = 4;
+
+using pattern_index_t = std::unordered_map<std::uint64_t, std::vector<std::pair<unsigned, unsigned>>>;
+
+std::uint64_t PatternIndexKey(array_view<unsigned char> Data) {
+	const std::size_t Length = std::min(Data.size(), PATTERN_INDEX_LENGTH);
+	std::uint64_t Key = Length;
+	for (std::size_t i = 0; i < Length; ++i)
+		Key = Key << 8 | Data[i];
+	return Key;
+}
+
+void IndexPattern(pattern_index_t &Index, array_view<unsigned char> Data, unsigned Host) {
+	for (std::size_t i = 0; i < Data.size(); ++i)
+		for (std::size_t n = 1; n <= PATTERN_INDEX_LENGTH && i + n <= Data.size(); ++n)
+			Index[PatternIndexKey(Data.subview(i, n))].emplace_back(Host, static_cast<unsigned>(i));
+}
+
+// Finds the first occurrence of the data in a longer host, in the order the hosts were indexed
+template <typename F>
+const std::pair<unsigned, unsigned> *FindPattern(const pattern_index_t &Index, array_view<unsigned char> Data, F GetHost) {
+	if (auto it = Index.find(PatternIndexKey(Data)); it != Index.end())
+		for (const auto &x : it->second) {
+			array_view<unsigned char> Host = GetHost(x.first);
+			if (Host.size() > Data.size() && Host.size() - x.second >= Data.size() &&
+				Host.subview(x.second, Data.size()) == Data)
+				return &x;
+		}
+	return nullptr;
+}
+
+} // namespace
+
 unsigned int CCompiler::AdjustSampleAddress(unsigned int Address)
 {
 	// Align samples to 64-byte pages
@@ -139,6 +217,7 @@ CCompiler::CCompiler(const CFamiTrackerModule &modfile, std::shared_ptr<CCompile
 	title_(m_pModule->GetModuleName()),
 	artist_(m_pModule->GetModuleArtist()),
 	copyright_(m_pModule->GetModuleCopyright()),
+	m_pLabelTable(std::make_unique<CChunkLabelTable>()),		// // //
 	m_pLogger(std::move(pLogger))
 {
 }
@@ -518,6 +597,10 @@ void CCompiler::SetMetadata(std::string_view title, std::string_view artist, std
 	copyright_ = copyright.substr(0, CFamiTrackerModule::METADATA_FIELD_LENGTH - 1);
 }
 
+void CCompiler::SetPatternCache(std::shared_ptr<CPatternCompilerCache> pCache) {		// // //
+	m_pPatternCache = std::move(pCache);
+}
+
 std::vector<unsigned char> CCompiler::LoadDriver(const driver_t &Driver, unsigned short Origin) const {		// // //
 	// Copy embedded driver
 	std::vector<unsigned char> Data(Driver.driver.begin(), Driver.driver.end());
@@ -744,7 +827,7 @@ void CCompiler::UpdateFrameBanks()
 	for (CChunk *pChunk : m_vFrameChunks) {
 		// Add bank data
 		for (int j = 0; j < Channels; ++j) {
-			unsigned char bank = GetObjectByLabel(pChunk->GetDataPointerTarget(j))->GetBank();
+			unsigned char bank = GetObjectByLabelID(pChunk->GetDataPointerTargetID(j))->GetBank();		// // //
 			if (bank < PATTERN_SWITCH_BANK)
 				bank = PATTERN_SWITCH_BANK;
 			pChunk->SetupBankData(j + Channels, bank);
@@ -756,7 +839,7 @@ void CCompiler::UpdateSongBanks()
 {
 	// Write bank numbers to song lists (can only be used when bankswitching is used)
 	for (CChunk *pChunk : m_vSongChunks) {
-		int bank = GetObjectByLabel(pChunk->GetDataPointerTarget(0))->GetBank();
+		int bank = GetObjectByLabelID(pChunk->GetDataPointerTargetID(0))->GetBank();		// // //
 		if (bank < PATTERN_SWITCH_BANK)
 			bank = PATTERN_SWITCH_BANK;
 		pChunk->SetupBankData(m_iSongBankReference, bank);
@@ -782,7 +865,7 @@ void CCompiler::EnableBankswitching()
 void CCompiler::ResolveLabels()
 {
 	// Resolve label addresses, no banks since bankswitching is disabled
-	std::map<stChunkLabel, int> labelMap;		// // //
+	std::vector<int> labelMap(m_pLabelTable->GetCount(), -1);		// // //
 
 	// Pass 1, collect labels
 	CollectLabels(labelMap);
@@ -794,7 +877,7 @@ void CCompiler::ResolveLabels()
 bool CCompiler::ResolveLabelsBankswitched()
 {
 	// Resolve label addresses and banks
-	std::map<stChunkLabel, int> labelMap;		// // //
+	std::vector<int> labelMap(m_pLabelTable->GetCount(), -1);		// // //
 
 	// Pass 1, collect labels
 	if (!CollectLabelsBankswitched(labelMap))
@@ -806,17 +889,17 @@ bool CCompiler::ResolveLabelsBankswitched()
 	return true;
 }
 
-void CCompiler::CollectLabels(std::map<stChunkLabel, int> &labelMap) const		// // //
+void CCompiler::CollectLabels(std::vector<int> &labelMap) const		// // //
 {
 	// Collect labels and assign offsets
 	int Offset = 0;
 	for (const auto &pChunk : m_vChunks) {
-		labelMap[pChunk->GetLabel()] = Offset;
+		labelMap[pChunk->GetLabelID()] = Offset;
 		Offset += pChunk->CountDataSize();
 	}
 }
 
-bool CCompiler::CollectLabelsBankswitched(std::map<stChunkLabel, int> &labelMap)		// // //
+bool CCompiler::CollectLabelsBankswitched(std::vector<int> &labelMap)		// // //
 {
 	int Offset = 0;
 	int Bank = PATTERN_SWITCH_BANK;
@@ -831,7 +914,7 @@ bool CCompiler::CollectLabelsBankswitched(std::map<stChunkLabel, int> &labelMap)
 			case CHUNK_PATTERN:
 				break;
 			default:
-				labelMap[pChunk->GetLabel()] = Offset;
+				labelMap[pChunk->GetLabelID()] = Offset;		// // //
 				Offset += Size;
 		}
 	}
@@ -842,39 +925,84 @@ bool CCompiler::CollectLabelsBankswitched(std::map<stChunkLabel, int> &labelMap)
 		return false;
 	}
 
-	unsigned int Track = 0;
+	// // // The switchable area is $B000-$C000, pack it first-fit decreasing.
+	// A frame list is kept in one piece with its frames since the driver reads
+	// them all from the bank selected by the song header.
+	struct stBankItem {
+		std::size_t Begin, End;		// // // range in m_vChunks
+		int Size;
+		std::size_t Bin;
+	};
+	std::vector<stBankItem> Items;
+	std::vector<std::shared_ptr<CChunk>> Chunks;
 
-	// The switchable area is $B000-$C000
-	for (auto &pChunk : m_vChunks) {
-		int Size = pChunk->CountDataSize();
+	for (std::size_t i = 0; i < m_vChunks.size(); ++i) {
+		int Size = m_vChunks[i]->CountDataSize();
 
-		switch (pChunk->GetType()) {
-			case CHUNK_FRAME_LIST:
-				// Make sure the entire frame list will fit, if not then allocate a new bank
-				if (Offset + m_iDriverSize + m_iTrackFrameSize[Track++] > 0x4000) {
-					Offset = 0x3000 - m_iDriverSize;
-					++Bank;
-				}
-				[[fallthrough]];		// // //
+		switch (m_vChunks[i]->GetType()) {
 			case CHUNK_FRAME:
-				labelMap[pChunk->GetLabel()] = Offset;
-				pChunk->SetBank(Bank < 4 ? ((Offset + m_iDriverSize) >> 12) : Bank);
-				Offset += Size;
+				// Frames directly follow their frame list
+				ASSERT(!Items.empty() && Items.back().End == i);
+				++Items.back().End;
+				Items.back().Size += Size;
 				break;
+			case CHUNK_FRAME_LIST:
 			case CHUNK_PATTERN:
-				// Make sure entire pattern will fit
-				if (Offset + m_iDriverSize + Size > 0x4000) {
-					Offset = 0x3000 - m_iDriverSize;
-					++Bank;
-				}
-				labelMap[pChunk->GetLabel()] = Offset;
-				pChunk->SetBank(Bank < 4 ? ((Offset + m_iDriverSize) >> 12) : Bank);
-				Offset += Size;
-			default:
+				Items.push_back({i, i + 1, Size});
 				break;
+			default:
+				Chunks.push_back(m_vChunks[i]);
+		}
+	}
+
+	std::vector<std::size_t> Order(Items.size());
+	std::iota(Order.begin(), Order.end(), std::size_t {0});
+	std::stable_sort(Order.begin(), Order.end(), [&] (std::size_t l, std::size_t r) {
+		return Items[l].Size > Items[r].Size;
+	});
+
+	// The first bin is what remains of the fixed area and bank 3
+	std::vector<int> Capacity {0x4000 - static_cast<int>(m_iDriverSize) - Offset};
+	std::vector<int> Free = Capacity;
+	for (std::size_t i : Order) {
+		auto &x = Items[i];
+		x.Bin = std::find_if(Free.begin(), Free.end(), [&] (int n) { return n >= x.Size; }) - Free.begin();
+		if (x.Bin == Free.size()) {
+			// items larger than a bank can still fit in what remains of the first bin
+			if (x.Size > 0x1000) {
+				Print("Error: Song data of " + conv::from_int(x.Size) + " bytes does not fit in one bank, can't export file!\n");
+				return false;
+			}
+			Capacity.push_back(0x1000);
+			Free.push_back(0x1000);
 		}
+		Free[x.Bin] -= x.Size;
 	}
 
+	// Assign addresses bin by bin, keeping the original order inside each bank
+	for (std::size_t b = 0; b < Free.size(); ++b) {
+		if (b > 0) {
+			Offset = 0x3000 - m_iDriverSize;
+			++Bank;
+		}
+		for (const auto &x : Items)
+			if (x.Bin == b)
+				for (std::size_t i = x.Begin; i < x.End; ++i) {
+					auto &pChunk = m_vChunks[i];
+					labelMap[pChunk->GetLabelID()] = Offset;
+					pChunk->SetBank(Bank < 4 ? ((Offset + m_iDriverSize) >> 12) : Bank);
+					Offset += pChunk->CountDataSize();
+					Chunks.push_back(pChunk);
+				}
+
+		int Used = Capacity[b] - Free[b];
+		Print(" * Bank " + conv::from_int(Bank) + ": " + conv::from_int(Used) + " / " + conv::from_int(Capacity[b]) +
+			" bytes (" + conv::from_int(Capacity[b] ? Used * 100 / Capacity[b] : 0) + "%)\n");
+	}
+
+	// Chunks are rendered in order, so move them into their banks
+	m_vChunks = std::move(Chunks);
+
 	if (m_bBankSwitched)
 		m_iFirstSampleBank = ((Bank < 4) ? ((Offset + m_iDriverSize) >> 12) : Bank) + 1;
 
@@ -883,7 +1011,7 @@ bool CCompiler::CollectLabelsBankswitched(std::map<stChunkLabel, int> &labelMap)
 	return true;
 }
 
-void CCompiler::AssignLabels(std::map<stChunkLabel, int> &labelMap)		// // //
+void CCompiler::AssignLabels(const std::vector<int> &labelMap)		// // //
 {
 	// Pass 2: assign addresses to labels
 	for (auto &pChunk : m_vChunks)
@@ -1009,11 +1137,6 @@ void CCompiler::AddBankswitching()
 		}
 	}
 
-	// Frame lists sizes has changed
-	m_pModule->VisitSongs([&] (const CSongData &song, unsigned i) {		// // //
-		m_iTrackFrameSize[i] += m_ChannelOrder.GetChannelCount() * song.GetFrameCount();
-	});
-
 	// Data size has changed
 	m_iMusicDataSize = CountData();
 }
@@ -1448,6 +1571,28 @@ void CCompiler::StoreSongs()
 	CChunk &SongListChunk = CreateChunk({CHUNK_SONG_LIST});		// // //
 
 	m_iDuplicatePatterns = 0;
+	m_iSharedPatterns = 0;		// // //
+	m_iSharedPatternSize = 0;
+	m_iCachedPatterns = 0;		// // //
+
+	// // // Everything besides the pattern itself that compiled pattern data depends on
+	if (m_pPatternCache) {
+		std::vector<std::uint64_t> Context {
+			static_cast<std::uint64_t>(m_pModule->GetSpeedSplitPoint()),
+			m_pModule->GetLinearPitch(),
+			m_pModule->GetSoundChipSet().GetFlag(),
+		};
+		for (unsigned i = 0; i < MAX_GROOVE; ++i) {
+			auto pGroove = m_pModule->GetGroove(i);
+			Context.push_back(pGroove ? pGroove->compiled_size() : 0u);
+		}
+		Context.insert(Context.end(), m_iAssignedInstruments.begin(), m_iAssignedInstruments.end());
+		for (unsigned i = 0; i < MAX_INSTRUMENTS; ++i)
+			Context.push_back(static_cast<std::uint64_t>(m_pModule->GetInstrumentManager()->GetInstrumentType(i)));
+		for (const auto &x : m_iSamplesLookUp)
+			Context.insert(Context.end(), x.begin(), x.end());
+		m_pPatternCache->SetContext(std::move(Context));
+	}
 
 	// Store song info
 	m_pModule->VisitSongs([&] (const CSongData &song, unsigned index) {
@@ -1494,6 +1639,13 @@ void CCompiler::StoreSongs()
 
 	if (m_iDuplicatePatterns > 0)
 		Print(" * " + conv::from_int(m_iDuplicatePatterns) + " duplicated pattern(s) removed\n");
+	if (m_iSharedPatterns > 0)		// // //
+		Print(" * " + conv::from_int(m_iSharedPatterns) + " pattern(s) stored inside other patterns (" + conv::from_int(m_iSharedPatternSize) + " bytes saved)\n");
+	if (m_pPatternCache) {		// // //
+		m_pPatternCache->Prune();
+		if (m_iCachedPatterns > 0)
+			Print(" * " + conv::from_int(m_iCachedPatterns) + " pattern(s) reused from the last export\n");
+	}
 
 #ifdef _DEBUG
 	Print("Hash collisions: " + conv::from_uint(m_iHashCollisions) + " (of " + conv::from_uint(m_PatternMap.size()) + " items)\r\n");		// // //
@@ -1546,8 +1698,6 @@ void CCompiler::CreateFrameList(unsigned int Track)
 		});
 	}
 
-	m_iTrackFrameSize[Track] = TotalSize;
-
 	Print(conv::from_int(FrameCount) + " frames (" + conv::from_int(TotalSize) + " bytes), ");
 }
 
@@ -1560,58 +1710,174 @@ void CCompiler::StorePatterns(unsigned int Track)
 	 *
 	 */
 
-	CPatternCompiler PatternCompiler(*m_pModule, m_iAssignedInstruments, (const DPCM_List_t *)m_iSamplesLookUp.data(), m_pLogger);		// // //
-
 	int PatternCount = 0;
 	int PatternSize = 0;
+	int CompressedSize = 0;		// // //
+	int SharedSize = 0;		// // //
 
-	// Iterate through all patterns
-	for (unsigned i = 0; i < MAX_PATTERN; ++i) {
-		m_ChannelOrder.ForeachChannel([&] (chan_id_t j) {		// // //
-			// And store only used ones
-			if (IsPatternAddressed(Track, i, j)) {
+	// // // Scan each frame list once
+	const auto Used = m_pModule->GetSong(Track)->GetUsedPatterns();
 
-				// Compile pattern data
-				PatternCompiler.CompileData(Track, i, j);
+	// Iterate through all patterns, and store only used ones
+	std::vector<stCompiledPattern> Patterns;		// // //
+	for (unsigned i = 0; i < MAX_PATTERN; ++i)
+		m_ChannelOrder.ForeachChannel([&] (chan_id_t j) {
+			if (Used[value_cast(j)][i])
+				Patterns.push_back({i, j});
+		});
 
-				auto label = stChunkLabel {CHUNK_PATTERN, Track, i, value_cast(j)};		// // //
+	// // // Reuse patterns compiled by an earlier export
+	if (m_pPatternCache) {
+		const auto *pSong = m_pModule->GetSong(Track);
+		for (auto &x : Patterns) {
+			x.Key = CPatternCompilerCache::MakeKey(pSong->GetPattern(x.Channel, x.Pattern), x.Channel, x.Pattern,
+				pSong->GetPatternLength(), pSong->GetEffectColumnCount(x.Channel), pSong->GetSongTempo() != 0);
+			if (const auto *pEntry = m_pPatternCache->Find(x.Key)) {
+				x.Data = pEntry->Data;
+				x.Hash = pEntry->Hash;
+				x.CompressedSize = pEntry->CompressedSize;
+				x.Log = pEntry->Log;
+				x.Cached = true;
+				++m_iCachedPatterns;
+			}
+		}
+	}
 
-				bool StoreNew = true;
+	// // // Compile pattern data, patterns only read the module so each worker owns a pattern compiler
+	std::atomic<std::size_t> next = 0;
+	auto worker = [&] {
+		auto pLog = std::make_shared<CBufferedLog>();
+		CPatternCompiler PatternCompiler(*m_pModule, m_iAssignedInstruments, (const DPCM_List_t *)m_iSamplesLookUp.data(), pLog);
+		for (std::size_t k = next++; k < Patterns.size(); k = next++) {
+			auto &x = Patterns[k];
+			if (x.Cached)		// // //
+				continue;
+			try {
+				PatternCompiler.CompileData(Track, x.Pattern, x.Channel);
+				x.Data = PatternCompiler.GetData();
+				x.Hash = PatternCompiler.GetHash();
+				x.CompressedSize = PatternCompiler.GetCompressedDataSize();
+			}
+			catch (...) {
+				x.Error = std::current_exception();
+			}
+			x.Log = pLog->Take();
+		}
+	};
+
+	const unsigned Threads = std::min<unsigned>(std::max(std::thread::hardware_concurrency(), 1u), Patterns.size());
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < Threads; ++i)
+		pool.emplace_back(worker);
+	worker();
+	for (auto &t : pool)
+		t.join();
+
+	// // // Report in the original order so the output does not depend on scheduling
+	for (const auto &x : Patterns) {
+		if (!x.Log.empty())
+			Print(x.Log);
+		if (x.Error)
+			std::rethrow_exception(x.Error);
+		if (m_pPatternCache && !x.Cached)		// // //
+			m_pPatternCache->Store(x.Key, {x.Data, x.Hash, x.CompressedSize, x.Log});
+	}
+
+	const auto LabelOf = [Track] (const stCompiledPattern &x) {		// // //
+		return stChunkLabel {CHUNK_PATTERN, Track, x.Pattern, value_cast(x.Channel)};
+	};
 
 #ifdef REMOVE_DUPLICATE_PATTERNS
-				unsigned int Hash = PatternCompiler.GetHash();
-
-				// Check for duplicate patterns
-				if (auto it = m_PatternMap.find(Hash); it != m_PatternMap.end()) {
-					const CChunk *pDuplicate = it->second;
-					// Hash only indicates that patterns may be equal, check exact data
-					if (PatternCompiler.CompareData(pDuplicate->GetStringData(PATTERN_CHUNK_INDEX))) {
-						// Duplicate was found, store a reference to existing pattern
-						m_DuplicateMap.try_emplace(label, pDuplicate->GetLabel());		// // //
-						++m_iDuplicatePatterns;
-						StoreNew = false;
-					}
-				}
+	// // // Find patterns that can reuse stored data, longest first so that
+	// shorter patterns may point into longer ones. The driver reads exactly
+	// as many bytes as the pattern needs from wherever its pointer leads, so
+	// any pattern whose data appears inside another one can share its chunk.
+	std::vector<std::size_t> Order(Patterns.size());
+	std::iota(Order.begin(), Order.end(), std::size_t {0});
+	std::stable_sort(Order.begin(), Order.end(), [&] (std::size_t l, std::size_t r) {
+		return Patterns[l].Data.size() > Patterns[r].Data.size();
+	});
+
+	std::map<unsigned, const stCompiledPattern *> TrackMap;
+	std::vector<const stCompiledPattern *> Hosts;
+	pattern_index_t TrackIndex;		// // // indexes Hosts
+
+	for (std::size_t k : Order) {
+		auto &x = Patterns[k];
+
+		// Check for duplicate patterns, hash only indicates that patterns may be equal
+		if (auto it = m_PatternMap.find(x.Hash); it != m_PatternMap.end() && array_view<unsigned char> {x.Data} == it->second->GetStringData(PATTERN_CHUNK_INDEX))
+			x.Target = it->second->GetLabel();
+		else if (auto it = TrackMap.find(x.Hash); it != TrackMap.end() && x.Data == it->second->Data)
+			x.Target = LabelOf(*it->second);
+		if (x.Target.Type != CHUNK_NONE) {
+			++m_iDuplicatePatterns;
+			continue;
+		}
+
+#ifdef SHARE_PATTERN_DATA
+		// Check for longer patterns containing this one, stored ones first
+		if (!x.Data.empty()) {
+			if (auto pFound = FindPattern(m_PatternIndex, x.Data, [&] (unsigned i) {
+				return m_vPatternChunks[i]->GetStringData(PATTERN_CHUNK_INDEX);
+			})) {
+				x.Target = m_vPatternChunks[pFound->first]->GetLabel();
+				x.Offset = pFound->second;
+			}
+			else if (auto pFound = FindPattern(TrackIndex, x.Data, [&] (unsigned i) {
+				return array_view<unsigned char> {Hosts[i]->Data};
+			})) {
+				x.Target = LabelOf(*Hosts[pFound->first]);
+				x.Offset = pFound->second;
+			}
+			if (x.Target.Type != CHUNK_NONE) {
+				++m_iSharedPatterns;
+				SharedSize += x.Data.size();
+				continue;
+			}
+		}
+#endif /* SHARE_PATTERN_DATA */
+
+		TrackMap.try_emplace(x.Hash, &x);
+#ifdef SHARE_PATTERN_DATA
+		IndexPattern(TrackIndex, x.Data, static_cast<unsigned>(Hosts.size()));		// // //
+#endif /* SHARE_PATTERN_DATA */
+		Hosts.push_back(&x);
+	}
 #endif /* REMOVE_DUPLICATE_PATTERNS */
 
-				if (StoreNew) {
-					// Store new pattern
-					CChunk &Chunk = CreateChunk(label);		// // //
+	// // // Store patterns in the original order
+	for (const auto &x : Patterns) {
+		auto label = LabelOf(x);		// // //
+
+		if (x.Target.Type != CHUNK_NONE) {
+			// Store a reference to existing pattern data
+			m_DuplicateMap.try_emplace(label, x.Target, x.Offset);		// // //
+			continue;
+		}
+
+		// Store new pattern
+		CChunk &Chunk = CreateChunk(label);		// // //
 
 #ifdef REMOVE_DUPLICATE_PATTERNS
-					if (m_PatternMap.count(Hash))
-						++m_iHashCollisions;
-					m_PatternMap[Hash] = &Chunk;
+		if (m_PatternMap.count(x.Hash))
+			++m_iHashCollisions;
+		m_PatternMap[x.Hash] = &Chunk;
 #endif /* REMOVE_DUPLICATE_PATTERNS */
 
-					// Store pattern data as string
-					Chunk.StoreString(PatternCompiler.GetData());
+		// Store pattern data as string
+		Chunk.StoreString(x.Data);
 
-					PatternSize += PatternCompiler.GetDataSize();
-					++PatternCount;
-				}
-			}
-		});
+#ifdef REMOVE_DUPLICATE_PATTERNS
+#ifdef SHARE_PATTERN_DATA
+		IndexPattern(m_PatternIndex, Chunk.GetStringData(PATTERN_CHUNK_INDEX), static_cast<unsigned>(m_vPatternChunks.size()));		// // //
+#endif /* SHARE_PATTERN_DATA */
+		m_vPatternChunks.push_back(&Chunk);		// // //
+#endif /* REMOVE_DUPLICATE_PATTERNS */
+
+		PatternSize += x.Data.size();
+		CompressedSize += x.CompressedSize;		// // //
+		++PatternCount;
 	}
 
 #ifdef REMOVE_DUPLICATE_PATTERNS
@@ -1619,28 +1885,25 @@ void CCompiler::StorePatterns(unsigned int Track)
 	for (const auto pChunk : m_vFrameChunks)
 		for (int j = 0, n = pChunk->GetLength(); j < n; ++j)
 			if (auto it = m_DuplicateMap.find(pChunk->GetDataPointerTarget(j)); it != m_DuplicateMap.cend())		// // //
-				pChunk->SetDataPointerTarget(j, it->second);
+				pChunk->SetDataPointerTarget(j, it->second.first, it->second.second);
 #endif /* REMOVE_DUPLICATE_PATTERNS */
 
 #ifdef LOCAL_DUPLICATE_PATTERN_REMOVAL
 	// Forget patterns when one whole track is stored
 	m_PatternMap.RemoveAll();
 	m_DuplicateMap.RemoveAll();
+	m_vPatternChunks.clear();		// // //
+	m_PatternIndex.clear();		// // //
 #endif /* LOCAL_DUPLICATE_PATTERN_REMOVAL */
 
-	Print(conv::from_int(PatternCount) + " patterns (" + conv::from_int(PatternSize) + " bytes)\r\n");
-}
-
-bool CCompiler::IsPatternAddressed(unsigned int Track, int Pattern, chan_id_t Channel) const
-{
-	// Scan the frame list to see if a pattern is accessed for that frame
-	if (const auto *pSong = m_pModule->GetSong(Track))		// // //
-		if (const auto *pTrack = pSong->GetTrack(Channel))
-			for (int i = 0, n = pSong->GetFrameCount(); i < n; ++i)
-				if (pTrack->GetFramePattern(i) == Pattern)
-					return true;
-
-	return false;
+	Print(conv::from_int(PatternCount) + " patterns (" + conv::from_int(PatternSize) + " bytes");
+	if (SharedSize > 0) {		// // //
+		m_iSharedPatternSize += SharedSize;
+		Print(", " + conv::from_int(SharedSize) + " bytes shared");
+	}
+	if (CompressedSize < PatternSize)		// // //
+		Print(", loops would save " + conv::from_int(PatternSize - CompressedSize) + " bytes");
+	Print(")\r\n");
 }
 
 void CCompiler::AddWavetable(CInstrumentFDS *pInstrument, CChunk *pChunk)
@@ -1657,7 +1920,13 @@ void CCompiler::AddWavetable(CInstrumentFDS *pInstrument, CChunk *pChunk)
 // Object list functions
 
 CChunk &CCompiler::CreateChunk(const stChunkLabel &Label) {		// // //
-	return *m_vChunks.emplace_back(std::make_shared<CChunk>(Label));
+	CChunk &Chunk = *m_vChunks.emplace_back(std::make_shared<CChunk>(Label, *m_pLabelTable));
+	unsigned ID = Chunk.GetLabelID();
+	if (ID >= m_vLabelChunks.size())
+		m_vLabelChunks.resize(ID + 1, nullptr);
+	if (!m_vLabelChunks[ID])
+		m_vLabelChunks[ID] = &Chunk;
+	return Chunk;
 }
 
 CChunk &CCompiler::AddChunkToList(CChunk &Chunk, const stChunkLabel &Label) {		// // //
@@ -1676,12 +1945,9 @@ int CCompiler::CountData() const
 	return Offset;
 }
 
-CChunk *CCompiler::GetObjectByLabel(const stChunkLabel &Label) const		// // //
+CChunk *CCompiler::GetObjectByLabelID(unsigned ID) const		// // //
 {
-	for (const auto &pChunk : m_vChunks)
-		if (Label == pChunk->GetLabel())		// // //
-			return pChunk.get();
-	return nullptr;
+	return ID < m_vLabelChunks.size() ? m_vLabelChunks[ID] : nullptr;
 }
 
 #if 0
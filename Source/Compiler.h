@@ -28,6 +28,7 @@
 #include <memory>
 #include <string>		// // //
 #include <map>		// // //
+#include <unordered_map>		// // //
 #include <cstdint>		// // //
 #include "FamiTrackerTypes.h"
 #include "SoundChipSet.h"		// // //
@@ -75,6 +76,8 @@ struct driver_t;
 class CChunk;
 enum chunk_type_t : int;
 struct stChunkLabel;		// // //
+class CChunkLabelTable;		// // //
+class CPatternCompilerCache;		// // //
 namespace ft0cc::doc {
 class dpcm_sample;
 } // namespace ft0cc::doc
@@ -112,6 +115,7 @@ public:
 	void	ExportASM(const wchar_t *lpszFileName);
 
 	void	SetMetadata(std::string_view title, std::string_view artist, std::string_view copyright);		// // //
+	void	SetPatternCache(std::shared_ptr<CPatternCompilerCache> pCache);		// // //
 
 private:
 	void	ExportNSF_NSFE(const wchar_t *lpszFileName, int MachineType, bool isNSFE);		// // //
@@ -134,14 +138,13 @@ private:
 	bool	CompileData();
 	void	ResolveLabels();
 	bool	ResolveLabelsBankswitched();
-	void	CollectLabels(std::map<stChunkLabel, int> &labelMap) const;		// // //
-	bool	CollectLabelsBankswitched(std::map<stChunkLabel, int> &labelMap);
-	void	AssignLabels(std::map<stChunkLabel, int> &labelMap);
+	void	CollectLabels(std::vector<int> &labelMap) const;		// // //
+	bool	CollectLabelsBankswitched(std::vector<int> &labelMap);
+	void	AssignLabels(const std::vector<int> &labelMap);
 	void	AddBankswitching();
 
 	void	ScanSong();
 	int		GetSampleIndex(int SampleNumber);
-	bool	IsPatternAddressed(unsigned int Track, int Pattern, chan_id_t Channel) const;
 
 	void	CreateMainHeader();
 	void	CreateSequenceList();
@@ -168,7 +171,7 @@ private:
 	// Object list functions
 	CChunk	&CreateChunk(const stChunkLabel &Label);		// // //
 	CChunk	&AddChunkToList(CChunk &Chunk, const stChunkLabel &Label);		// // //
-	CChunk	*GetObjectByLabel(const stChunkLabel &Label) const;		// // //
+	CChunk	*GetObjectByLabelID(unsigned ID) const;		// // //
 	int		CountData() const;
 
 	// Debugging
@@ -206,6 +209,8 @@ private:
 
 	// Object lists
 	std::vector<std::shared_ptr<CChunk>> m_vChunks;		// // //
+	std::unique_ptr<CChunkLabelTable> m_pLabelTable;		// // //
+	std::vector<CChunk *> m_vLabelChunks;		// // // indexed by label ID
 	std::vector<CChunk*> m_vSongChunks;
 	std::vector<CChunk*> m_vFrameChunks;
 	//std::vector<CChunk*> m_vWaveChunks;
@@ -249,12 +254,13 @@ private:
 	unsigned int	m_iInitAddress;			// NSF init address
 	unsigned int	m_iDriverAddress;		// Music driver location
 
-	unsigned int	m_iTrackFrameSize[MAX_TRACKS];	// Cached song frame sizes
-
 	unsigned int	m_iHeaderFlagOffset;	// Offset to flag location in main header
 	unsigned int	m_iSongBankReference;	// Offset to bank value in song header
 
 	unsigned int	m_iDuplicatePatterns;	// Number of duplicated patterns removed
+	unsigned int	m_iSharedPatterns;		// // // Number of patterns stored inside other patterns
+	unsigned int	m_iSharedPatternSize;	// // // Bytes saved by sharing pattern data
+	unsigned int	m_iCachedPatterns;		// // // Number of patterns reused from an earlier export
 
 	// NSF banks
 	unsigned int	m_iFirstSampleBank;		// Bank number with the first DPCM sample
@@ -268,7 +274,10 @@ private:
 
 	// Optimization
 	std::map<unsigned, const CChunk *> m_PatternMap;		// // //
-	std::map<stChunkLabel, stChunkLabel> m_DuplicateMap;		// // //
+	std::map<stChunkLabel, std::pair<stChunkLabel, unsigned>> m_DuplicateMap;		// // // target label and offset
+	std::vector<const CChunk *> m_vPatternChunks;		// // // Stored pattern chunks, searched for shared data
+	std::unordered_map<std::uint64_t, std::vector<std::pair<unsigned, unsigned>>> m_PatternIndex;		// // // Short strings in stored pattern chunks, to chunk index and offset
+	std::shared_ptr<CPatternCompilerCache> m_pPatternCache;		// // //
 
 	// Debugging
 	std::shared_ptr<CCompilerLog> m_pLogger;		// // //
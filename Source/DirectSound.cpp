@@ -215,13 +215,13 @@ CDSoundChannel::~CDSoundChannel()
 	m_lpDirectSoundNotify->Release();
 }
 
-bool CDSoundChannel::Play() const
+bool CDSoundChannel::Play()
 {
 	// Begin playback of buffer
 	return FAILED(m_lpDirectSoundBuffer->Play(NULL, NULL, DSBPLAY_LOOPING)) ? false : true;
 }
 
-bool CDSoundChannel::Stop() const
+bool CDSoundChannel::Stop()
 {
 	// Stop playback
 	return FAILED(m_lpDirectSoundBuffer->Stop()) ? false : true;
@@ -296,7 +296,7 @@ bool CDSoundChannel::WriteBuffer(array_view<char> Buffer)		// // //
 	return true;
 }
 
-buffer_event_t CDSoundChannel::WaitForSyncEvent(DWORD dwTimeout) const
+buffer_event_t CDSoundChannel::WaitForSyncEvent(unsigned Timeout)		// // //
 {
 	// Wait for a DirectSound event
 	if (!IsPlaying()) {
@@ -305,7 +305,7 @@ buffer_event_t CDSoundChannel::WaitForSyncEvent(DWORD dwTimeout) const
 	}
 
 	// Wait for events
-	switch (::WaitForMultipleObjects(2, m_hEventList, FALSE, dwTimeout)) {
+	switch (::WaitForMultipleObjects(2, m_hEventList, FALSE, Timeout)) {
 		case WAIT_OBJECT_0:			// External event
 			return BUFFER_CUSTOM_EVENT;
 		case WAIT_OBJECT_0 + 1:		// DirectSound buffer
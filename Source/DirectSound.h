@@ -30,18 +30,10 @@
 #include <vector>		// // //
 #include <string>		// // //
 #include "array_view.h"		// // //
-
-// Return values from WaitForDirectSoundEvent()
-enum buffer_event_t {
-	BUFFER_NONE = 0,
-	BUFFER_CUSTOM_EVENT = 1,
-	BUFFER_TIMEOUT,
-	BUFFER_IN_SYNC,
-	BUFFER_OUT_OF_SYNC,
-};
+#include "AudioSink.h"		// // //
 
 // DirectSound channel
-class CDSoundChannel
+class CDSoundChannel : public CAudioSink		// // //
 {
 	friend class CDSound;
 
@@ -49,21 +41,23 @@ public:
 	CDSoundChannel();
 	~CDSoundChannel();
 
-	bool Play() const;
-	bool Stop() const;
-	bool IsPlaying() const;
-	bool ClearBuffer();
-	bool WriteBuffer(array_view<char> Buffer);		// // //
+	bool Play() override;
+	bool Stop() override;
+	bool IsPlaying() const override;
+	bool ClearBuffer() override;
+	bool WriteBuffer(array_view<char> Buffer) override;		// // //
 
-	buffer_event_t WaitForSyncEvent(DWORD dwTimeout) const;
+	buffer_event_t WaitForSyncEvent(unsigned Timeout) override;		// // //
+	bool IsClocked() const override { return true; }		// // //
 
-	int GetBlockSize() const	{ return m_iBlockSize; }
+	int GetBlockSize() const override	{ return m_iBlockSize; }
 	int GetBlockSamples() const	{ return m_iBlockSize >> ((m_iSampleSize >> 3) - 1); }
 	int GetBlocks()	const		{ return m_iBlocks; }
 	int	GetBufferLength() const	{ return m_iBufferLength; }
-	int GetSampleSize()	const	{ return m_iSampleSize;	}
-	int	GetSampleRate()	const	{ return m_iSampleRate;	}
-	int GetChannels() const		{ return m_iChannels; }
+	int GetSampleSize()	const override	{ return m_iSampleSize;	}
+	int	GetSampleRate()	const override	{ return m_iSampleRate;	}
+	int GetChannels() const override	{ return m_iChannels; }
+	int GetOutputLatency() const override { return (m_iBlocks - 1) * GetBlockSamples(); }		// // //
 
 private:
 	int GetPlayBlock() const;
@@ -26,6 +26,7 @@
 #include "ModuleException.h"
 #include "array_view.h"
 #include "NumConv.h"
+#include <algorithm>		// // //
 
 //
 // This class is based on CFile and has some simple extensions to create and read FTM files
@@ -67,6 +68,10 @@ uintmax_t CDocumentFile::GetLength() const {
 void CDocumentFile::Close() {
 	if (m_pFile->m_hFile != CFile::hFileNull)
 		m_pFile->Close();
+	m_BlockView = { };		// // //
+	m_FileData = { };
+	m_pFileData.reset();
+	m_iFileCursor = 0;
 }
 
 // CDocumentFile
@@ -205,18 +210,31 @@ void CDocumentFile::ValidateFile()
 {
 	// Checks if loaded file is valid
 
+	// // // Read the entire file at once, all blocks are read from this buffer
+	m_pFile->SeekToBegin();
+	auto pData = std::make_shared<std::vector<unsigned char>>(static_cast<std::size_t>(m_pFile->GetLength()));
+	pData->resize(m_pFile->Read(pData->data(), static_cast<UINT>(pData->size())));
+	m_FileData = {pData->data(), pData->size()};
+	m_pFileData = std::move(pData);
+	m_iFileCursor = 0;
+	m_iFilePosition = m_iPreviousPosition = 0;
+	m_BlockView = { };
+
 	// Check ident string
 	char Buffer[FILE_HEADER_ID.size()] = { };
-	Read(reinterpret_cast<unsigned char *>(Buffer), FILE_HEADER_ID.size());		// // //
+	ReadFileData(FILE_HEADER_ID.size()).copy(reinterpret_cast<unsigned char *>(Buffer), FILE_HEADER_ID.size());		// // //
 
 	if (array_view<char> {Buffer} != FILE_HEADER_ID)
 		RaiseModuleException("File is not a FamiTracker module");
 
 	// Read file version
 	unsigned char VerBuffer[4] = { };		// // //
-	Read(VerBuffer, std::size(VerBuffer));
+	ReadFileData(std::size(VerBuffer)).copy(VerBuffer, std::size(VerBuffer));
 	m_iFileVersion = (VerBuffer[3] << 24) | (VerBuffer[2] << 16) | (VerBuffer[1] << 8) | VerBuffer[0];
 
+	// // // old modules are still read directly from the CFile
+	m_pFile->Seek(m_iFileCursor, CFile::begin);
+
 	// // // Older file version
 	if (GetFileVersion() < COMPATIBLE_VER)
 		throw CModuleException::WithMessage("FamiTracker module version too old (0x" + conv::from_int_hex(GetFileVersion()) +
@@ -238,13 +256,18 @@ unsigned int CDocumentFile::GetFileVersion() const
 
 bool CDocumentFile::ReadBlock()
 {
+	m_iBlockOffset = m_iFileCursor;		// // //
 	m_iBlockPointer = 0;
+	m_iPreviousPointer = 0;
 
 	m_cBlockID.fill(0);		// // //
+	m_BlockView = { };
+	m_iBlockVersion = 0;
+	m_iBlockSize = 0;
 
-	int BytesRead = Read(reinterpret_cast<unsigned char *>(m_cBlockID.data()), std::size(m_cBlockID) * sizeof(char));
-	Read(reinterpret_cast<unsigned char *>(&m_iBlockVersion), sizeof(m_iBlockVersion));
-	Read(reinterpret_cast<unsigned char *>(&m_iBlockSize), sizeof(m_iBlockSize));
+	int BytesRead = ReadFileData(std::size(m_cBlockID) * sizeof(char)).copy(reinterpret_cast<unsigned char *>(m_cBlockID.data()), std::size(m_cBlockID) * sizeof(char));
+	ReadFileData(sizeof(m_iBlockVersion)).copy(reinterpret_cast<unsigned char *>(&m_iBlockVersion), sizeof(m_iBlockVersion));
+	ReadFileData(sizeof(m_iBlockSize)).copy(reinterpret_cast<unsigned char *>(&m_iBlockSize), sizeof(m_iBlockSize));
 
 	if (m_iBlockSize > 50000000) {
 		// File is probably corrupt
@@ -252,8 +275,8 @@ bool CDocumentFile::ReadBlock()
 		return true;
 	}
 
-	m_pBlockData = std::vector<unsigned char>(m_iBlockSize);		// // //
-	if (Read(m_pBlockData.data(), m_iBlockSize) == FILE_END_ID.size())		// // //
+	m_BlockView = ReadFileData(m_iBlockSize);		// // //
+	if (m_BlockView.size() == FILE_END_ID.size())		// // //
 		if (array_view<char> {m_cBlockID.data(), FILE_END_ID.size()} == FILE_END_ID)
 			m_bFileDone = true;
 
@@ -270,6 +293,46 @@ bool CDocumentFile::ReadBlock()
 	return false;
 }
 
+bool CDocumentFile::ReadBlockAt(std::size_t Offset)		// // //
+{
+	m_iFileCursor = std::min(Offset, m_FileData.size());
+	m_bFileDone = false;
+	return ReadBlock();
+}
+
+std::size_t CDocumentFile::GetBlockOffset() const		// // //
+{
+	return m_iBlockOffset;
+}
+
+std::unique_ptr<CDocumentFile> CDocumentFile::ForkReader() const		// // //
+{
+	// The fork has its own cursor over the same file buffer and keeps the buffer alive
+	auto pFork = std::make_unique<CDocumentFile>();
+	pFork->m_iFileVersion = m_iFileVersion;
+	pFork->m_bFileDone = m_bFileDone;
+	pFork->m_bIncomplete = m_bIncomplete;
+	pFork->m_pFileData = m_pFileData;
+	pFork->m_FileData = m_FileData;
+	pFork->m_iFilePosition = pFork->m_iPreviousPosition = 0;
+	return pFork;
+}
+
+std::unique_ptr<CDocumentFile> CDocumentFile::ForkBlock() const		// // //
+{
+	// The fork keeps only a copy of the current block alive, which it reads from offset 0;
+	// forks of a reader that already holds a single block share its copy
+	auto pFork = ForkReader();
+	if (m_iBlockOffset > 0 || m_iFileCursor < m_FileData.size()) {
+		auto pData = std::make_shared<const std::vector<unsigned char>>(
+			m_FileData.begin() + m_iBlockOffset, m_FileData.begin() + m_iFileCursor);
+		pFork->m_FileData = {pData->data(), pData->size()};
+		pFork->m_pFileData = std::move(pData);
+	}
+	pFork->ReadBlockAt(0);
+	return pFork;
+}
+
 const char *CDocumentFile::GetBlockHeaderID() const		// // //
 {
 	return m_cBlockID.data();
@@ -288,28 +351,6 @@ void CDocumentFile::RollbackPointer(int count)
 	m_iPreviousPosition -= count;
 }
 
-int CDocumentFile::GetBlockInt()
-{
-	int Value;
-	memcpy(&Value, m_pBlockData.data() + m_iBlockPointer, sizeof(Value));		// // //
-	m_iPreviousPointer = m_iBlockPointer;
-	m_iBlockPointer += sizeof(Value);
-	m_iPreviousPosition = m_iFilePosition;		// // //
-	m_iFilePosition += sizeof(Value);
-	return Value;
-}
-
-char CDocumentFile::GetBlockChar()
-{
-	char Value;
-	memcpy(&Value, m_pBlockData.data() + m_iBlockPointer, sizeof(Value));		// // //
-	m_iPreviousPointer = m_iBlockPointer;
-	m_iBlockPointer += sizeof(Value);
-	m_iPreviousPosition = m_iFilePosition;		// // //
-	m_iFilePosition += sizeof(Value);
-	return Value;
-}
-
 std::string CDocumentFile::ReadString()
 {
 	/*
@@ -343,11 +384,19 @@ void CDocumentFile::GetBlock(void *Buffer, int Size)
 	ASSERT(Size < MAX_BLOCK_SIZE);
 	ASSERT(Buffer != NULL);
 
-	memcpy(Buffer, m_pBlockData.data() + m_iBlockPointer, Size);		// // //
-	m_iPreviousPointer = m_iBlockPointer;
-	m_iBlockPointer += Size;
-	m_iPreviousPosition = m_iFilePosition;		// // //
-	m_iFilePosition += Size;
+	// // // bytes past the end of a truncated block read as zero
+	std::size_t Count = m_BlockView.subview(std::min<std::size_t>(m_iBlockPointer, m_BlockView.size()))
+		.copy(static_cast<unsigned char *>(Buffer), Size);
+	std::fill_n(static_cast<unsigned char *>(Buffer) + Count, Size - Count, 0);
+	AdvanceBlockPointer(Size);
+}
+
+array_view<unsigned char> CDocumentFile::GetBlockView(std::size_t Size)		// // //
+{
+	// The view points into the file buffer and is shorter than Size if the block is truncated
+	auto View = m_BlockView.subview(std::min<std::size_t>(m_iBlockPointer, m_BlockView.size()), Size);
+	AdvanceBlockPointer(Size);
+	return View;
 }
 
 bool CDocumentFile::BlockDone() const
@@ -392,11 +441,13 @@ void CDocumentFile::RaiseModuleException(const std::string &Msg) const		// // //
 	throw e;
 }
 
-unsigned CDocumentFile::Read(unsigned char *lpBuf, std::size_t nCount)		// // //
+array_view<unsigned char> CDocumentFile::ReadFileData(std::size_t Size)		// // //
 {
 	m_iPreviousPosition = m_iFilePosition;
-	m_iFilePosition = m_pFile->GetPosition();
-	return m_pFile->Read(lpBuf, nCount);
+	m_iFilePosition = m_iFileCursor;
+	auto Data = m_FileData.subview(m_iFileCursor, Size);
+	m_iFileCursor += Data.size();
+	return Data;
 }
 
 void CDocumentFile::Write(const unsigned char *lpBuf, std::size_t nCount)		// // //
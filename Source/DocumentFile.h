@@ -29,6 +29,7 @@
 #include <memory>		// // //
 #include "array_view.h"		// // //
 #include <string_view>		// // //
+#include <cstring>		// // //
 using namespace std::string_view_literals;
 
 // CDocumentFile, class for reading/writing document files
@@ -68,7 +69,12 @@ public:
 	unsigned int GetFileVersion() const;
 
 	bool		ReadBlock();
+	bool		ReadBlockAt(std::size_t Offset);		// // //
+	std::size_t	GetBlockOffset() const;		// // //
+	std::unique_ptr<CDocumentFile> ForkReader() const;		// // //
+	std::unique_ptr<CDocumentFile> ForkBlock() const;		// // //
 	void		GetBlock(void *Buffer, int Size);
+	array_view<unsigned char> GetBlockView(std::size_t Size);		// // //
 	int			GetBlockVersion() const;
 	bool		BlockDone() const;
 	const char	*GetBlockHeaderID() const;		// // //
@@ -90,7 +96,6 @@ public:
 	[[noreturn]] void RaiseModuleException(const std::string &Msg) const;
 
 private:		// // //
-	unsigned Read(unsigned char *lpBuf, std::size_t nCount);
 	void Write(const unsigned char *lpBuf, std::size_t nCount);
 
 public:
@@ -108,6 +113,10 @@ public:
 private:
 	template <typename T>
 	void WriteBlockData(T Value);
+	template <typename T>
+	T ReadBlockData();		// // //
+	void AdvanceBlockPointer(std::size_t Size);		// // //
+	array_view<unsigned char> ReadFileData(std::size_t Size);		// // //
 
 protected:
 	void ReallocateBlock();
@@ -124,9 +133,45 @@ protected:
 	unsigned int	m_iBlockVersion;
 	std::vector<unsigned char> m_pBlockData;		// // //
 
+	// // // the whole module is read in one go, blocks are views into this buffer
+	std::shared_ptr<const std::vector<unsigned char>> m_pFileData;		// shared with forked readers
+	array_view<unsigned char> m_FileData;
+	std::size_t		m_iFileCursor = 0;
+	std::size_t		m_iBlockOffset = 0;
+	array_view<unsigned char> m_BlockView;
+
 	unsigned int	m_iMaxBlockSize;
 
 	unsigned int	m_iBlockPointer;
 	unsigned int	m_iPreviousPointer;		// // //
 	uintmax_t		m_iFilePosition, m_iPreviousPosition;		// // //
 };
+
+// // // block reads are plain cursor reads into the file buffer
+
+template <typename T>
+inline T CDocumentFile::ReadBlockData() {
+	T Value;
+	if (m_iBlockPointer + sizeof(Value) > m_BlockView.size()) {
+		GetBlock(&Value, sizeof(Value));
+		return Value;
+	}
+	std::memcpy(&Value, m_BlockView.data() + m_iBlockPointer, sizeof(Value));
+	AdvanceBlockPointer(sizeof(Value));
+	return Value;
+}
+
+inline void CDocumentFile::AdvanceBlockPointer(std::size_t Size) {
+	m_iPreviousPointer = m_iBlockPointer;
+	m_iBlockPointer += Size;
+	m_iPreviousPosition = m_iFilePosition;
+	m_iFilePosition += Size;
+}
+
+inline int CDocumentFile::GetBlockInt() {
+	return ReadBlockData<int>();
+}
+
+inline char CDocumentFile::GetBlockChar() {
+	return ReadBlockData<char>();
+}
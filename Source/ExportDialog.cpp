@@ -198,6 +198,7 @@ void CExportDialog::CreateNSF()
 			MachineType = 2;
 
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		UpdateMetadata(Compiler);		// // //
 		Compiler.ExportNSF(*path, MachineType);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
@@ -221,6 +222,7 @@ void CExportDialog::CreateNSFe()		// // //
 			MachineType = 2;
 
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		UpdateMetadata(Compiler);		// // //
 		Compiler.ExportNSFE(*path, MachineType);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
@@ -243,6 +245,7 @@ void CExportDialog::CreateNES()
 		CWaitCursor wait;
 
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		Compiler.ExportNES(*path, IsDlgButtonChecked(IDC_PAL) == BST_CHECKED);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
 	}
@@ -276,6 +279,7 @@ void CExportDialog::CreateBIN()
 		CWaitCursor wait;
 
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		Compiler.ExportBIN(*path, SampleDir);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
 	}
@@ -288,6 +292,7 @@ void CExportDialog::CreatePRG()
 
 		CFamiTrackerDoc *pDoc = CFamiTrackerDoc::GetDoc();
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		Compiler.ExportPRG(*path, IsDlgButtonChecked(IDC_PAL) == BST_CHECKED);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
 	}
@@ -300,6 +305,7 @@ void CExportDialog::CreateASM()
 
 		CFamiTrackerDoc *pDoc = CFamiTrackerDoc::GetDoc();
 		CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+		Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 		Compiler.ExportASM(*path);
 		Env.GetSettings()->SetDirectory((LPCWSTR)*path, PATH_NSF);
 	}
@@ -316,6 +322,7 @@ void CExportDialog::OnBnClickedPlay()
 
 	CFamiTrackerDoc *pDoc = CFamiTrackerDoc::GetDoc();
 	CCompiler Compiler(*pDoc->GetModule(), std::make_unique<CEditLog>(GetDlgItem(IDC_OUTPUT)));
+	Compiler.SetPatternCache(pDoc->GetPatternCache());		// // //
 	Compiler.ExportNSF(file, IsDlgButtonChecked(IDC_PAL) == BST_CHECKED);
 
 	// Play exported file (available in debug)
@@ -38,6 +38,11 @@
 #include "WinSDK/VersionHelpers.h"		// // //
 #include "WaveRenderer.h"		// // //
 #include "WaveRendererFactory.h"		// // //
+#include "WaveFile.h"		// // //
+#include "OfflineRenderer.h"		// // //
+#include "FamiTrackerEnv.h"		// // //
+#include "SoundChipService.h"		// // //
+#include "ChannelOrder.h"		// // //
 #include "VersionChecker.h"		// // //
 #include "VisualizerWnd.h"		// // //
 #include "FileDialogs.h"		// // //
@@ -233,28 +238,43 @@ BOOL CFamiTrackerApp::InitInstance()
 		}
 		if ((unsigned)cmdInfo.track_ >= doc.GetModule()->GetSongCount())
 			cmdInfo.track_ = 0;
-		m_pSoundGenerator->AssignDocument(&doc);
-		m_pSoundGenerator->InitializeSound(NULL);
-
-		std::unique_ptr<CWaveRenderer> render = CWaveRendererFactory::Make(*doc.GetModule(), cmdInfo.track_, cmdInfo.render_type_, cmdInfo.render_param_);
+		std::shared_ptr<CWaveRenderer> render = CWaveRendererFactory::Make(*doc.GetModule(), cmdInfo.track_, cmdInfo.render_type_, cmdInfo.render_param_);
 		if (!render) {
 			std::cerr << "Error: unable to create wave renderer!\n";
 			ExitProcess(1);
 			return FALSE;
 		}
 		render->SetRenderTrack(cmdInfo.track_);
-		if (!m_pSoundGenerator->RenderToFile(cmdInfo.m_strExportFile, std::move(render))) {
+		auto pWave = std::make_unique<CWaveFile>();
+		if (!pWave->OpenFile(cmdInfo.m_strExportFile, GetSettings()->Sound.iSampleRate, COfflineRenderer::GetOutputSampleSize(), COfflineRenderer::GetOutputChannels())) {		// // //
 			std::cerr << "Error: unable to render WAV file: " << cmdInfo.m_strExportFile << '\n';
 			ExitProcess(1);
 			return FALSE;
 		}
-		while (!m_pSoundGenerator->IsRendering())
-			;
+		render->SetOutputFile(std::move(pWave));
+
+		if (cmdInfo.m_bStems) {		// // // one extra file per channel, rendered in the same pass
+			const CStringW &file = cmdInfo.m_strExportFile;
+			const int nPos = file.ReverseFind(L'.');
+			const CStringW base = nPos >= 0 ? file.Left(nPos) : file;
+			const CSoundChipService *pSCS = Env.GetSoundChipService();
+			doc.GetModule()->GetChannelOrder().ForeachChannel([&] (chan_id_t ch) {
+				const bool IsVRC7 = GetChipFromChannel(ch) == sound_chip_t::VRC7;
+				if (IsVRC7 && ch != chan_id_t::VRC7_CH1)		// VRC7 is rendered as a single stem
+					return;
+				std::string_view name = IsVRC7 ? pSCS->GetShortChipName(sound_chip_t::VRC7) : pSCS->GetShortChannelName(ch);
+				CStringW stemFile = base + L"_" + conv::to_wide(name).data() + L".wav";
+				auto pStem = std::make_unique<CWaveFile>();
+				if (pStem->OpenFile(stemFile, GetSettings()->Sound.iSampleRate, COfflineRenderer::GetOutputSampleSize(), 1))		// // //
+					render->SetStemFile(ch, std::move(pStem));
+				else
+					std::cerr << "Error: unable to open stem file: " << stemFile << '\n';
+			});
+		}
+
+		// // // render synchronously without an audio device
 		std::cout << "Rendering started... ";
-		while (m_pSoundGenerator->IsRendering())
-			;//			m_pSoundGenerator->IdleLoop();
-		m_pSoundGenerator->StopPlayer();
-		m_pSoundGenerator->RemoveDocument();
+		COfflineRenderer {*doc.GetModule(), render}.Render();
 		ShutDownSynth();
 		std::cout << "Done." << std::endl;
 		ExitProcess(0);
@@ -716,6 +736,11 @@ void CFTCommandLineInfo::ParseParam(const WCHAR* pszParam, BOOL bFlag, BOOL bLas
 			m_bRender = true;
 			return;
 		}
+		// // // Per-channel stems when rendering (/stems)
+		else if (!_wcsicmp(pszParam, L"stems")) {
+			m_bStems = true;
+			return;
+		}
 		// Disable crash dumps (/nodump)
 		else if (!_wcsicmp(pszParam, L"nodump")) {
 #ifdef ENABLE_CRASH_HANDLER
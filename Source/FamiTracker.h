@@ -51,6 +51,7 @@ public:
 	bool m_bExport = false;
 	bool m_bPlay = false;
 	bool m_bRender = false;		// // //
+	bool m_bStems = false;		// // //
 	CStringW m_strExportFile;
 	CStringW m_strExportLogFile;
 	CStringW m_strExportDPCMFile;
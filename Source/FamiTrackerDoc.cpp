@@ -32,6 +32,7 @@
 #include "ChannelMap.h"		// // //
 #include "FamiTrackerDocIO.h"		// // //
 #include "FamiTrackerDocOldIO.h"		// // //
+#include "PatternCompiler.h"		// // //
 #include "str_conv/str_conv.hpp"		// // //
 
 //
@@ -185,6 +186,7 @@ void CFamiTrackerDoc::DeleteContents()
 
 		UpdateAllViews(NULL, UPDATE_CLOSE);	// TODO remove
 		module_ = std::make_unique<CFamiTrackerModule>();		// // //
+		m_pPatternCache.reset();		// // //
 		Env.GetSoundGenerator()->DocumentPropertiesChanged(this);		// // // rebind module
 		Env.GetSoundGenerator()->ModuleChipChanged();
 
@@ -466,6 +468,12 @@ const CFamiTrackerModule *CFamiTrackerDoc::GetModule() const noexcept {
 	return module_.get();
 }
 
+std::shared_ptr<CPatternCompilerCache> CFamiTrackerDoc::GetPatternCache() {		// // //
+	if (!m_pPatternCache)
+		m_pPatternCache = std::make_shared<CPatternCompilerCache>();
+	return m_pPatternCache;
+}
+
 CStringW CFamiTrackerDoc::GetFileTitle() const
 {
 	// Return file name without extension
@@ -33,6 +33,7 @@
 // External classes
 class CFamiTrackerModule;		// // //
 class CDocumentFile;
+class CPatternCompilerCache;		// // //
 
 // // // + move core data fields into CFamiTrackerModule
 // // // + move high-level pattern operations to CSongView
@@ -71,6 +72,9 @@ public:
 
 	CStringW			GetFileTitle() const;
 
+	// // // Compiled patterns kept between exports so that re-exporting after small edits is fast
+	std::shared_ptr<CPatternCompilerCache> GetPatternCache();
+
 	//
 	// Document file I/O
 	//
@@ -129,6 +133,7 @@ private:
 	//
 private:
 	std::unique_ptr<CFamiTrackerModule> module_;		// // // implementation
+	std::shared_ptr<CPatternCompilerCache> m_pPatternCache;		// // // dropped with the module
 
 	// State variables
 	bool			m_bFileLoaded = false;			// Is a file loaded?
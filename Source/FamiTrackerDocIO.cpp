@@ -58,6 +58,9 @@
 #include "BookmarkCollection.h"
 #include "Bookmark.h"
 
+#include <algorithm>		// // //
+#include <thread>		// // //
+
 namespace {
 
 using namespace std::string_view_literals;
@@ -104,6 +107,49 @@ void VisitSequences(const CSequenceManager *manager, F&& f) {
 	}
 }
 
+// // // Splits a pattern block into runs of whole pattern records of similar size, returns nothing
+// if the block does not parse cleanly so that it is loaded sequentially instead
+template <typename F>
+std::vector<std::size_t> SplitPatternBlock(array_view<unsigned char> Data, int ver, const CChannelOrder &order,
+	unsigned Songs, F EffectColumns, unsigned Parts) {
+	const std::size_t MIN_PART_SIZE = 0x10000;
+	const std::size_t PartSize = Data.size() / std::max(1u, std::min<unsigned>(Parts, static_cast<unsigned>(Data.size() / MIN_PART_SIZE)));
+
+	std::vector<std::size_t> Bounds {0};
+	std::size_t Pos = 0;
+	while (Pos < Data.size()) {
+		int Header[4]; // track, channel, pattern, items
+		if (Data.size() - Pos < sizeof(Header))
+			return { };
+		std::memcpy(Header, Data.data() + Pos, sizeof(Header));
+		Pos += sizeof(Header);
+		if (Header[0] < 0 || static_cast<unsigned>(Header[0]) >= Songs || Header[1] < 0 ||
+			static_cast<unsigned>(Header[1]) >= order.GetChannelCount() || Header[3] < 0 || Header[3] > MAX_PATTERN_LENGTH)
+			return { };
+
+		if (ver < 6) // row, note, octave, instrument, volume, effect columns
+			Pos += Header[3] * (sizeof(int) + 4 + 2 * EffectColumns(Header[0], order.TranslateChannel(Header[1])));
+		else
+			for (int i = 0; i < Header[3]; ++i) {
+				Pos += 5;
+				for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
+					if (Pos >= Data.size())
+						return { };
+					if (Data[Pos++] != value_cast(effect_t::NONE))
+						++Pos;
+				}
+			}
+
+		if (Pos > Data.size())
+			return { };
+		if (Pos - Bounds.back() >= PartSize && Pos < Data.size())
+			Bounds.push_back(Pos);
+	}
+
+	Bounds.push_back(Data.size());
+	return Bounds;
+}
+
 } // namespace
 
 // // // save/load functionality
@@ -143,16 +189,51 @@ bool CFamiTrackerDocIO::Load(CFamiTrackerModule &modfile) {
 	if (file_.GetFileVersion() < 0x0210)
 		(void)modfile.GetSong(0);
 
-	// Read all blocks
+	// // // Index all blocks first
+	struct stBlock {
+		std::size_t Offset;
+		std::string ID;
+		int Version;
+		std::vector<std::future<commit_t>> Staged;
+	};
+	std::vector<stBlock> Blocks;
+
 	bool ErrorFlag = false;
-	while (!file_.Finished() && !ErrorFlag) {
-		ErrorFlag = file_.ReadBlock();
+	while (!file_.Finished()) {
+		if (file_.ReadBlock()) {
+			ErrorFlag = true;
+			break;
+		}
 		std::string_view BlockID = file_.GetBlockHeaderID();		// // //
 		if (BlockID == "END")
 			break;
+		Blocks.push_back({file_.GetBlockOffset(), std::string {BlockID}, file_.GetBlockVersion(), { }});
+	}
+
+	// // // Heavy blocks only depend on PARAMS and HEADER, decode them concurrently once those are loaded
+	std::size_t Ready = Blocks.size();
+	for (std::size_t i = 0; i < Blocks.size(); ++i)
+		if (Blocks[i].ID == FILE_BLOCK_PARAMS || Blocks[i].ID == FILE_BLOCK_HEADER)
+			Ready = i + 1;
+
+	// Read all blocks
+	for (std::size_t i = 0; i < Blocks.size(); ++i) {
+		if (i == Ready)
+			for (std::size_t j = i; j < Blocks.size(); ++j)
+				Blocks[j].Staged = StageBlock(modfile, Blocks[j].Offset, Blocks[j].ID, Blocks[j].Version);
+
+		auto &block = Blocks[i];
+		if (!block.Staged.empty()) {		// // // rethrows errors from the decoders in file order
+			for (auto &part : block.Staged)
+				part.get()(modfile);
+			if (block.ID == FILE_BLOCK_PATTERNS)
+				fds_adjust_arps_ = block.Version < 5;
+			continue;
+		}
 
+		file_.ReadBlockAt(block.Offset);		// // //
 		try {
-			(this->*FTM_READ_FUNC.at(BlockID))(modfile, file_.GetBlockVersion());		// // //
+			(this->*FTM_READ_FUNC.at(block.ID))(modfile, block.Version);		// // //
 		}
 		catch (std::out_of_range) {
 #ifdef _DEBUG
@@ -172,6 +253,47 @@ bool CFamiTrackerDocIO::Load(CFamiTrackerModule &modfile) {
 	return true;
 }
 
+std::vector<std::future<CFamiTrackerDocIO::commit_t>>
+CFamiTrackerDocIO::StageBlock(const CFamiTrackerModule &modfile, std::size_t Offset, std::string_view ID, int ver) const {		// // //
+	// Each decoder gets its own reader over the file buffer and a copy of the module state it needs
+	std::vector<std::future<commit_t>> Staged;
+
+	if (ID == FILE_BLOCK_PATTERNS && ver >= 2 && file_.GetFileVersion() != 0x0200) {
+		// Effect column counts are fixed by HEADER, patterns of songs it did not allocate are loaded sequentially
+		const unsigned Songs = modfile.GetSongCount();
+		std::vector<unsigned> Columns(Songs * CHANID_COUNT);
+		for (unsigned t = 0; t < Songs; ++t)
+			for (std::size_t c = 0; c < CHANID_COUNT; ++c)
+				Columns[t * CHANID_COUNT + c] = modfile.GetSong(t)->GetEffectColumnCount(static_cast<chan_id_t>(c));
+		auto EffectColumns = [Columns = std::move(Columns), Songs] (unsigned Track, chan_id_t ch) -> unsigned {
+			return Track < Songs && value_cast(ch) < CHANID_COUNT ? Columns[Track * CHANID_COUNT + value_cast(ch)] : 0u;
+		};
+
+		auto pFile = file_.ForkReader();
+		pFile->ReadBlockAt(Offset);
+		pFile = pFile->ForkBlock();		// // // deferred patterns keep only this block alive
+		auto Data = pFile->GetBlockView(pFile->GetBlockSize());
+		auto Bounds = Data.size() == static_cast<std::size_t>(pFile->GetBlockSize()) ?
+			SplitPatternBlock(Data, ver, modfile.GetChannelOrder(), Songs, EffectColumns, std::max(std::thread::hardware_concurrency(), 1u)) :
+			std::vector<std::size_t> { };
+
+		for (std::size_t i = 0; i + 1 < Bounds.size(); ++i)
+			Staged.push_back(std::async(std::launch::async, [pFile = pFile->ForkReader(), ver, err_lv = err_lv_,
+				order = modfile.GetChannelOrder(), chips = modfile.GetSoundChipSet(), EffectColumns, Begin = Bounds[i], End = Bounds[i + 1]] {
+				pFile->ReadBlockAt(0);
+				pFile->GetBlockView(Begin);
+				return CFamiTrackerDocIO {*pFile, err_lv}.DecodePatterns(ver, order, chips, EffectColumns, End);
+			}));
+	}
+	else if (ID == FILE_BLOCK_DSAMPLES)
+		Staged.push_back(std::async(std::launch::async, [pFile = file_.ForkReader(), Offset, ver, err_lv = err_lv_] {
+			pFile->ReadBlockAt(Offset);
+			return CFamiTrackerDocIO {*pFile, err_lv}.DecodeDSamples(ver);
+		}));
+
+	return Staged;
+}
+
 bool CFamiTrackerDocIO::Save(const CFamiTrackerModule &modfile) {
 	using block_info_t = std::tuple<void (CFamiTrackerDocIO::*)(const CFamiTrackerModule &, int), int, std::string_view>;
 	const block_info_t MODULE_WRITE_FUNC[] = {		// // //
@@ -740,173 +862,255 @@ void CFamiTrackerDocIO::SaveFrames(const CFamiTrackerModule &modfile, int ver) {
 
 void CFamiTrackerDocIO::LoadPatterns(CFamiTrackerModule &modfile, int ver) {
 	fds_adjust_arps_ = ver < 5;		// // //
-	bool compat200 = (file_.GetFileVersion() == 0x0200);		// // //
 
 	if (ver == 1) {
 		int PatternLen = AssertRange(file_.GetBlockInt(), 0, MAX_PATTERN_LENGTH, "Pattern data count");
 		modfile.GetSong(0)->SetPatternLength(PatternLen);
 	}
 
-	const CChannelOrder &order = modfile.GetChannelOrder();		// // //
+	DecodePatterns(ver, modfile.GetChannelOrder(), modfile.GetSoundChipSet(), [&] (unsigned Track, chan_id_t ch) {
+		return modfile.GetSong(Track)->GetEffectColumnCount(ch);
+	}, file_.GetBlockSize())(modfile);
+}
 
-	while (!file_.BlockDone()) {
-		unsigned Track = 0;
-		if (ver > 1)
-			Track = AssertRange(file_.GetBlockInt(), 0, static_cast<int>(MAX_TRACKS) - 1, "Pattern track index");
+// // // Pattern records are validated on load and decoded again when the pattern is first accessed
+
+struct CFamiTrackerDocIO::stPatternHeader {
+	unsigned Track;
+	unsigned Channel;
+	chan_id_t ch;
+	unsigned Pattern;
+	unsigned Items;
+};
+
+class CFamiTrackerDocIO::CPatternRecord final : public CPatternSource {
+public:
+	struct stContext {
+		std::shared_ptr<const CDocumentFile> pBlock; // copy of the PATTERNS block, forked for each decode
+		int ver;
+		CSoundChipSet chips;
+		module_error_level_t err_lv;
+	};
 
-		unsigned Channel = AssertRange((unsigned)file_.GetBlockInt(), 0u, CHANID_COUNT - 1, "Pattern channel index");
-		AssertRange<MODULE_ERROR_OFFICIAL>(Channel, 0u, MAX_CHANNELS - 1, "Pattern channel index");
-		unsigned Pattern = AssertRange(file_.GetBlockInt(), 0, MAX_PATTERN - 1, "Pattern index");
-		unsigned Items	= AssertRange(file_.GetBlockInt(), 0, MAX_PATTERN_LENGTH, "Pattern data count");
-		chan_id_t ch = order.TranslateChannel(Channel);
+	CPatternRecord(std::shared_ptr<const stContext> pContext, const stPatternHeader &Header, std::size_t Begin, unsigned FX) :
+		pContext_(std::move(pContext)), Header_(Header), Begin_(Begin), FX_(FX)
+	{
+	}
 
-		auto *pSong = modfile.GetSong(Track);
+	void Decode(CPatternData &pattern) const override {
+		auto pFile = pContext_->pBlock->ForkReader();
+		pFile->ReadBlockAt(0);
+		pFile->GetBlockView(Begin_);
+		CFamiTrackerDocIO {*pFile, pContext_->err_lv}.ReadPatternRows(pContext_->ver, Header_, pContext_->chips, FX_, Header_.Items, &pattern);
+	}
 
-		for (unsigned i = 0; i < Items; ++i) try {
-			unsigned Row;
-			if (compat200 || ver >= 6)
-				Row = static_cast<unsigned char>(file_.GetBlockChar());
-			else
-				Row = AssertRange(file_.GetBlockInt(), 0, 0xFF, "Row index");		// // //
+private:
+	std::shared_ptr<const stContext> pContext_;
+	stPatternHeader Header_;
+	std::size_t Begin_;
+	unsigned FX_;
+};
 
-			try {
-				stChanNote Note;		// // //
-
-				Note.Note = static_cast<note_t>(AssertRange<MODULE_ERROR_STRICT>(		// // //
-					file_.GetBlockChar(), value_cast(note_t::NONE), value_cast(note_t::ECHO), "Note value"));
-				Note.Octave = AssertRange<MODULE_ERROR_STRICT>(
-					file_.GetBlockChar(), 0, OCTAVE_RANGE - 1, "Octave value");
-				int Inst = static_cast<unsigned char>(file_.GetBlockChar());
-				if (Inst != HOLD_INSTRUMENT)		// // // 050B
-					AssertRange<MODULE_ERROR_STRICT>(Inst, 0, CInstrumentManager::MAX_INSTRUMENTS, "Instrument index");
-				Note.Instrument = Inst;
-				Note.Vol = AssertRange<MODULE_ERROR_STRICT>(
-					file_.GetBlockChar(), 0, MAX_VOLUME, "Channel volume");
-
-				int FX = compat200 ? 1 : ver >= 6 ? MAX_EFFECT_COLUMNS :
-					pSong->GetEffectColumnCount(order.TranslateChannel(Channel));		// // // 050B
-				for (int n = 0; n < FX; ++n) try {
-					auto EffectNumber = (effect_t)file_.GetBlockChar();
-					if (Note.EffNumber[n] = static_cast<effect_t>(EffectNumber); Note.EffNumber[n] != effect_t::NONE) {
-						AssertRange<MODULE_ERROR_STRICT>(value_cast(EffectNumber), value_cast(effect_t::NONE), EFFECT_COUNT - 1, "Effect index");
-						unsigned char EffectParam = file_.GetBlockChar();
-						if (ver < 3) {
-							if (EffectNumber == effect_t::PORTAOFF) {
-								EffectNumber = effect_t::PORTAMENTO;
-								EffectParam = 0;
-							}
-							else if (EffectNumber == effect_t::PORTAMENTO) {
-								if (EffectParam < 0xFF)
-									++EffectParam;
-							}
+CFamiTrackerDocIO::commit_t CFamiTrackerDocIO::DecodePatterns(int ver, const CChannelOrder &order, const CSoundChipSet &chips,
+	const std::function<unsigned (unsigned, chan_id_t)> &EffectColumns, std::size_t End) {		// // //
+	bool compat200 = (file_.GetFileVersion() == 0x0200);		// // //
+
+	auto pContext = std::make_shared<const CPatternRecord::stContext>(CPatternRecord::stContext {
+		std::shared_ptr<const CDocumentFile> {file_.ForkBlock()}, ver, chips, err_lv_});
+
+	struct stStagedPattern {
+		stPatternHeader Header;
+		std::shared_ptr<const CPatternSource> pSource;
+	};
+	std::vector<stStagedPattern> Patterns;
+
+	while (static_cast<std::size_t>(file_.GetBlockPos()) < End) {
+		auto Header = ReadPatternHeader(ver, order);
+		std::size_t Begin = file_.GetBlockPos();
+		unsigned FX = compat200 ? 1 : ver >= 6 ? MAX_EFFECT_COLUMNS : EffectColumns(Header.Track, Header.ch);		// // // 050B
+
+		if (Header.ch == chan_id_t::NONE && Header.Items) {
+			// the first row cannot be stored, which stops loading this block
+			ReadPatternRows(ver, Header, chips, FX, 1, nullptr);
+			Patterns.push_back({Header, nullptr});
+			break;
+		}
+
+		ReadPatternRows(ver, Header, chips, FX, Header.Items, nullptr);
+		Patterns.push_back({Header, Header.Items ? std::make_shared<CPatternRecord>(pContext, Header, Begin, FX) : nullptr});
+	}
+
+	return [Patterns = std::move(Patterns)] (CFamiTrackerModule &modfile) {		// // //
+		for (const auto &x : Patterns) {
+			auto *pSong = modfile.GetSong(x.Header.Track);
+			if (auto *pTrack = pSong->GetTrack(x.Header.ch))
+				pTrack->SetPatternSource(x.Header.Pattern, x.pSource);
+			else if (x.Header.Items)
+				throw std::out_of_range {"Bad chan_id_t in CSongData::GetPattern(chan_id_t, unsigned)"};
+		}
+	};
+}
+
+CFamiTrackerDocIO::stPatternHeader CFamiTrackerDocIO::ReadPatternHeader(int ver, const CChannelOrder &order) {		// // //
+	unsigned Track = 0;
+	if (ver > 1)
+		Track = AssertRange(file_.GetBlockInt(), 0, static_cast<int>(MAX_TRACKS) - 1, "Pattern track index");
+
+	unsigned Channel = AssertRange((unsigned)file_.GetBlockInt(), 0u, CHANID_COUNT - 1, "Pattern channel index");
+	AssertRange<MODULE_ERROR_OFFICIAL>(Channel, 0u, MAX_CHANNELS - 1, "Pattern channel index");
+	unsigned Pattern = AssertRange(file_.GetBlockInt(), 0, MAX_PATTERN - 1, "Pattern index");
+	unsigned Items	= AssertRange(file_.GetBlockInt(), 0, MAX_PATTERN_LENGTH, "Pattern data count");
+
+	return {Track, Channel, order.TranslateChannel(Channel), Pattern, Items};
+}
+
+void CFamiTrackerDocIO::ReadPatternRows(int ver, const stPatternHeader &Header, const CSoundChipSet &chips,
+	unsigned FX, unsigned Rows, CPatternData *pPattern) {		// // //
+	bool compat200 = (file_.GetFileVersion() == 0x0200);		// // //
+
+	for (unsigned i = 0; i < Rows; ++i) try {
+		unsigned Row;
+		if (compat200 || ver >= 6)
+			Row = static_cast<unsigned char>(file_.GetBlockChar());
+		else
+			Row = AssertRange(file_.GetBlockInt(), 0, 0xFF, "Row index");		// // //
+
+		try {
+			stChanNote Note;		// // //
+
+			Note.Note = static_cast<note_t>(AssertRange<MODULE_ERROR_STRICT>(		// // //
+				file_.GetBlockChar(), value_cast(note_t::NONE), value_cast(note_t::ECHO), "Note value"));
+			Note.Octave = AssertRange<MODULE_ERROR_STRICT>(
+				file_.GetBlockChar(), 0, OCTAVE_RANGE - 1, "Octave value");
+			int Inst = static_cast<unsigned char>(file_.GetBlockChar());
+			if (Inst != HOLD_INSTRUMENT)		// // // 050B
+				AssertRange<MODULE_ERROR_STRICT>(Inst, 0, CInstrumentManager::MAX_INSTRUMENTS, "Instrument index");
+			Note.Instrument = Inst;
+			Note.Vol = AssertRange<MODULE_ERROR_STRICT>(
+				file_.GetBlockChar(), 0, MAX_VOLUME, "Channel volume");
+
+			for (unsigned n = 0; n < FX; ++n) try {
+				auto EffectNumber = (effect_t)file_.GetBlockChar();
+				if (Note.EffNumber[n] = static_cast<effect_t>(EffectNumber); Note.EffNumber[n] != effect_t::NONE) {
+					AssertRange<MODULE_ERROR_STRICT>(value_cast(EffectNumber), value_cast(effect_t::NONE), EFFECT_COUNT - 1, "Effect index");
+					unsigned char EffectParam = file_.GetBlockChar();
+					if (ver < 3) {
+						if (EffectNumber == effect_t::PORTAOFF) {
+							EffectNumber = effect_t::PORTAMENTO;
+							EffectParam = 0;
+						}
+						else if (EffectNumber == effect_t::PORTAMENTO) {
+							if (EffectParam < 0xFF)
+								++EffectParam;
 						}
-						Note.EffParam[n] = EffectParam; // skip on no effect
 					}
-					else if (ver < 6)
-						file_.GetBlockChar(); // unused blank parameter
+					Note.EffParam[n] = EffectParam; // skip on no effect
 				}
-				catch (CModuleException e) {
-					e.AppendError("At effect column fx" + conv::from_int(n + 1) + ',');
-					throw e;
+				else if (ver < 6)
+					file_.GetBlockChar(); // unused blank parameter
+			}
+			catch (CModuleException e) {
+				e.AppendError("At effect column fx" + conv::from_int(n + 1) + ',');
+				throw e;
+			}
+
+//			if (Note.Vol > MAX_VOLUME)
+//				Note.Vol &= 0x0F;
+
+			if (compat200) {		// // //
+				if (Note.EffNumber[0] == effect_t::SPEED && Note.EffParam[0] < 20)
+					++Note.EffParam[0];
+
+				if (Note.Vol == 0)
+					Note.Vol = MAX_VOLUME;
+				else {
+					--Note.Vol;
+					Note.Vol &= 0x0F;
 				}
 
-	//			if (Note.Vol > MAX_VOLUME)
-	//				Note.Vol &= 0x0F;
+				if (Note.Note == note_t::NONE)
+					Note.Instrument = MAX_INSTRUMENTS;
+			}
 
-				if (compat200) {		// // //
-					if (Note.EffNumber[0] == effect_t::SPEED && Note.EffParam[0] < 20)
-						++Note.EffParam[0];
+			if (chips.ContainsChip(sound_chip_t::N163) && GetChipFromChannel(Header.ch) == sound_chip_t::N163) {		// // //
+				for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n)
+					if (Note.EffNumber[n] == effect_t::SAMPLE_OFFSET)
+						Note.EffNumber[n] = effect_t::N163_WAVE_BUFFER;
+			}
 
-					if (Note.Vol == 0)
-						Note.Vol = MAX_VOLUME;
-					else {
-						--Note.Vol;
-						Note.Vol &= 0x0F;
+			if (ver == 3) {
+				// Fix for VRC7 portamento
+				if (GetChipFromChannel(Header.ch) == sound_chip_t::VRC7) {		// // //
+					for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
+						switch (Note.EffNumber[n]) {
+						case effect_t::PORTA_DOWN:
+							Note.EffNumber[n] = effect_t::PORTA_UP;
+							break;
+						case effect_t::PORTA_UP:
+							Note.EffNumber[n] = effect_t::PORTA_DOWN;
+							break;
+						}
 					}
-
-					if (Note.Note == note_t::NONE)
-						Note.Instrument = MAX_INSTRUMENTS;
 				}
-
-				if (modfile.GetSoundChipSet().ContainsChip(sound_chip_t::N163) && GetChipFromChannel(ch) == sound_chip_t::N163) {		// // //
-					for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n)
-						if (Note.EffNumber[n] == effect_t::SAMPLE_OFFSET)
-							Note.EffNumber[n] = effect_t::N163_WAVE_BUFFER;
+				// FDS pitch effect fix
+				else if (GetChipFromChannel(Header.ch) == sound_chip_t::FDS) {
+					for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
+						switch (Note.EffNumber[n]) {
+						case effect_t::PITCH:
+							if (Note.EffParam[n] != 0x80)
+								Note.EffParam[n] = (0x100 - Note.EffParam[n]) & 0xFF;
+							break;
+						}
+					}
 				}
+			}
 
-				if (ver == 3) {
-					// Fix for VRC7 portamento
-					if (GetChipFromChannel(ch) == sound_chip_t::VRC7) {		// // //
-						for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
-							switch (Note.EffNumber[n]) {
+			if (file_.GetFileVersion() < 0x450) {		// // // 050B
+				for (auto &x : Note.EffNumber)
+					if (x < effect_t::COUNT)
+						x = compat::EFF_CONVERSION_050.first[value_cast(x)];
+			}
+			/*
+			if (ver < 6) {
+				// Noise pitch slide fix
+				if (GetChannelType(Channel) == chan_id_t::NOISE) {
+					for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
+						switch (Note.EffNumber[n]) {
 							case effect_t::PORTA_DOWN:
 								Note.EffNumber[n] = effect_t::PORTA_UP;
+								Note.EffParam[n] = Note.EffParam[n] << 4;
 								break;
 							case effect_t::PORTA_UP:
 								Note.EffNumber[n] = effect_t::PORTA_DOWN;
+								Note.EffParam[n] = Note.EffParam[n] << 4;
 								break;
-							}
-						}
-					}
-					// FDS pitch effect fix
-					else if (GetChipFromChannel(ch) == sound_chip_t::FDS) {
-						for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
-							switch (Note.EffNumber[n]) {
-							case effect_t::PITCH:
-								if (Note.EffParam[n] != 0x80)
-									Note.EffParam[n] = (0x100 - Note.EffParam[n]) & 0xFF;
+							case effect_t::PORTAMENTO:
+								Note.EffParam[n] = Note.EffParam[n] << 4;
+								break;
+							case effect_t::SLIDE_UP:
+								Note.EffParam[n] = Note.EffParam[n] + 0x70;
+								break;
+							case effect_t::SLIDE_DOWN:
+								Note.EffParam[n] = Note.EffParam[n] + 0x70;
 								break;
-							}
-						}
-					}
-				}
-
-				if (file_.GetFileVersion() < 0x450) {		// // // 050B
-					for (auto &x : Note.EffNumber)
-						if (x < effect_t::COUNT)
-							x = compat::EFF_CONVERSION_050.first[value_cast(x)];
-				}
-				/*
-				if (ver < 6) {
-					// Noise pitch slide fix
-					if (GetChannelType(Channel) == chan_id_t::NOISE) {
-						for (int n = 0; n < MAX_EFFECT_COLUMNS; ++n) {
-							switch (Note.EffNumber[n]) {
-								case effect_t::PORTA_DOWN:
-									Note.EffNumber[n] = effect_t::PORTA_UP;
-									Note.EffParam[n] = Note.EffParam[n] << 4;
-									break;
-								case effect_t::PORTA_UP:
-									Note.EffNumber[n] = effect_t::PORTA_DOWN;
-									Note.EffParam[n] = Note.EffParam[n] << 4;
-									break;
-								case effect_t::PORTAMENTO:
-									Note.EffParam[n] = Note.EffParam[n] << 4;
-									break;
-								case effect_t::SLIDE_UP:
-									Note.EffParam[n] = Note.EffParam[n] + 0x70;
-									break;
-								case effect_t::SLIDE_DOWN:
-									Note.EffParam[n] = Note.EffParam[n] + 0x70;
-									break;
-							}
 						}
 					}
 				}
-				*/
-
-				pSong->SetPatternData(order.TranslateChannel(Channel), Pattern, Row, Note);		// // //
-			}
-			catch (CModuleException e) {
-				e.AppendError("At row " + conv::from_int_hex(Row, 2) + ',');
-				throw e;
 			}
+			*/
+
+			if (pPattern)		// // //
+				pPattern->SetNoteOn(Row, Note);
 		}
 		catch (CModuleException e) {
-			e.AppendError("At pattern " + conv::from_int_hex(Pattern, 2) + ", channel " + conv::from_int(Channel) + ", track " + conv::from_int(Track + 1) + ',');
+			e.AppendError("At row " + conv::from_int_hex(Row, 2) + ',');
 			throw e;
 		}
 	}
+	catch (CModuleException e) {
+		e.AppendError("At pattern " + conv::from_int_hex(Header.Pattern, 2) + ", channel " + conv::from_int(Header.Channel) + ", track " + conv::from_int(Header.Track + 1) + ',');
+		throw e;
+	}
 }
 
 void CFamiTrackerDocIO::SavePatterns(const CFamiTrackerModule &modfile, int ver) {
@@ -922,8 +1126,9 @@ void CFamiTrackerDocIO::SavePatterns(const CFamiTrackerModule &modfile, int ver)
 	 */
 
 	modfile.VisitSongs([&] (const CSongData &x, unsigned song) {
+		const auto Used = x.GetUsedPatterns();		// // //
 		x.VisitPatterns([&] (const CPatternData &pattern, chan_id_t ch, unsigned index) {
-			if (!x.IsPatternInUse(ch, index))		// // //
+			if (!Used[value_cast(ch)][index])		// // //
 				return;
 
 			// Save all rows
@@ -956,10 +1161,14 @@ void CFamiTrackerDocIO::SavePatterns(const CFamiTrackerModule &modfile, int ver)
 }
 
 void CFamiTrackerDocIO::LoadDSamples(CFamiTrackerModule &modfile, int ver) {
+	DecodeDSamples(ver)(modfile);		// // //
+}
+
+CFamiTrackerDocIO::commit_t CFamiTrackerDocIO::DecodeDSamples(int ver) {		// // //
 	unsigned int Count = AssertRange(
 		static_cast<unsigned char>(file_.GetBlockChar()), 0U, CDSampleManager::MAX_DSAMPLES, "DPCM sample count");
 
-	auto &manager = *modfile.GetInstrumentManager()->GetDSampleManager();
+	std::vector<std::pair<unsigned, std::shared_ptr<ft0cc::doc::dpcm_sample>>> DSamples;
 
 	for (unsigned int i = 0; i < Count; ++i) {
 		unsigned int Index = AssertRange(
@@ -971,16 +1180,23 @@ void CFamiTrackerDocIO::LoadDSamples(CFamiTrackerModule &modfile, int ver) {
 			int Size = AssertRange(file_.GetBlockInt(), 0, 0x7FFF, "DPCM sample size");
 			AssertFileData<MODULE_ERROR_STRICT>(Size <= 0xFF1 && Size % 0x10 == 1, "Bad DPCM sample size");
 			int TrueSize = Size + ((1 - Size) & 0x0F);		// // //
-			std::vector<uint8_t> samples(TrueSize);
-			file_.GetBlock(samples.data(), Size);
+			auto Data = file_.GetBlockView(Size);		// // //
+			std::vector<uint8_t> samples(Data.begin(), Data.end());
+			samples.resize(TrueSize);
 
-			manager.SetDSample(Index, std::make_unique<ft0cc::doc::dpcm_sample>(samples, Name));		// // //
+			DSamples.emplace_back(Index, std::make_shared<ft0cc::doc::dpcm_sample>(std::move(samples), Name));		// // //
 		}
 		catch (CModuleException e) {
 			e.AppendError("At DPCM sample " + conv::from_int(Index) + ',');
 			throw e;
 		}
 	}
+
+	return [DSamples = std::move(DSamples)] (CFamiTrackerModule &modfile) {		// // //
+		auto &manager = *modfile.GetInstrumentManager()->GetDSampleManager();
+		for (const auto &[Index, pSamp] : DSamples)
+			manager.SetDSample(Index, pSamp);
+	};
 }
 
 void CFamiTrackerDocIO::SaveDSamples(const CFamiTrackerModule &modfile, int ver) {
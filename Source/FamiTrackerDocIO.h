@@ -25,11 +25,17 @@
 
 #include <string>
 #include <vector>
+#include <functional>		// // //
+#include <future>		// // //
 #include "OldSequence.h"
 #include "ModuleException.h"
+#include "APU/Types_fwd.h"		// // //
 
 class CFamiTrackerModule;
 class CDocumentFile;
+class CChannelOrder;		// // //
+class CSoundChipSet;		// // //
+class CPatternData;		// // //
 
 class CFamiTrackerDocIO {
 public:
@@ -39,6 +45,11 @@ public:
 	bool Save(const CFamiTrackerModule &modfile);
 
 private:
+	// // // decoded block data, applied to the module in file order
+	using commit_t = std::function<void (CFamiTrackerModule &)>;
+
+	std::vector<std::future<commit_t>> StageBlock(const CFamiTrackerModule &modfile, std::size_t Offset, std::string_view ID, int ver) const;		// // //
+
 	void PostLoad(CFamiTrackerModule &modfile);
 
 	void LoadParams(CFamiTrackerModule &modfile, int ver);
@@ -60,9 +71,17 @@ private:
 	void SaveFrames(const CFamiTrackerModule &modfile, int ver);
 
 	void LoadPatterns(CFamiTrackerModule &modfile, int ver);
+	struct stPatternHeader;		// // //
+	class CPatternRecord;		// // //
+	commit_t DecodePatterns(int ver, const CChannelOrder &order, const CSoundChipSet &chips,		// // //
+		const std::function<unsigned (unsigned, chan_id_t)> &EffectColumns, std::size_t End);
+	stPatternHeader ReadPatternHeader(int ver, const CChannelOrder &order);		// // //
+	void ReadPatternRows(int ver, const stPatternHeader &Header, const CSoundChipSet &chips,		// // //
+		unsigned FX, unsigned Rows, CPatternData *pPattern);
 	void SavePatterns(const CFamiTrackerModule &modfile, int ver);
 
 	void LoadDSamples(CFamiTrackerModule &modfile, int ver);
+	commit_t DecodeDSamples(int ver);		// // //
 	void SaveDSamples(const CFamiTrackerModule &modfile, int ver);
 
 	void LoadComments(CFamiTrackerModule &modfile, int ver);
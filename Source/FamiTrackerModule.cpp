@@ -327,8 +327,9 @@ void CFamiTrackerModule::RemoveUnusedPatterns() {
 			if (!order.HasChannel((chan_id_t)i))
 				for (int p = 0; p < MAX_PATTERN; ++p)
 					song.GetPattern((chan_id_t)i, p) = CPatternData { };
-		song.VisitPatterns([&song] (CPatternData &pattern, chan_id_t c, unsigned p) {
-			if (!song.IsPatternInUse(c, p))
+		const auto Used = song.GetUsedPatterns();		// // //
+		song.VisitPatterns([&Used] (CPatternData &pattern, chan_id_t c, unsigned p) {
+			if (!Used[value_cast(c)][p])
 				pattern = CPatternData { };
 		});
 	});
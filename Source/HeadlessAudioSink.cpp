@@ -0,0 +1,156 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "HeadlessAudioSink.h"
+#include <thread>
+
+CNullAudioSink::CNullAudioSink(int SampleRate, int SampleSize, int Channels, int BlockSize, bool Realtime) :
+	m_iSampleRate(SampleRate),
+	m_iSampleSize(SampleSize),
+	m_iChannels(Channels),
+	m_iBlockSize(BlockSize),
+	m_bRealtime(Realtime),
+	m_BlockDuration(std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(
+		static_cast<double>(BlockSize) / (SampleSize / 8 * Channels) / SampleRate)))
+{
+}
+
+bool CNullAudioSink::Play() {
+	if (!m_bPlaying) {
+		m_bPlaying = true;
+		m_NextBlock = clock_t::now();
+	}
+	return true;
+}
+
+bool CNullAudioSink::Stop() {
+	m_bPlaying = false;
+	return true;
+}
+
+bool CNullAudioSink::IsPlaying() const {
+	return m_bPlaying;
+}
+
+bool CNullAudioSink::ClearBuffer() {
+	return Stop();
+}
+
+bool CNullAudioSink::WriteBuffer(array_view<char> Buffer) {
+	++m_iBlocksWritten;
+	return Buffer.size() == static_cast<std::size_t>(m_iBlockSize);
+}
+
+buffer_event_t CNullAudioSink::WaitForSyncEvent(unsigned Timeout) {
+	if (!IsPlaying() && !Play())
+		return BUFFER_NONE;
+	if (!m_bRealtime)
+		return BUFFER_IN_SYNC;
+
+	auto Now = clock_t::now();
+	if (Now - m_NextBlock > m_BlockDuration) {
+		// the caller missed a whole block
+		m_NextBlock = Now + m_BlockDuration;
+		return BUFFER_OUT_OF_SYNC;
+	}
+	if (m_NextBlock - Now > std::chrono::milliseconds {Timeout}) {
+		std::this_thread::sleep_for(std::chrono::milliseconds {Timeout});
+		return BUFFER_TIMEOUT;
+	}
+
+	std::this_thread::sleep_until(m_NextBlock);
+	m_NextBlock += m_BlockDuration;
+	return BUFFER_IN_SYNC;
+}
+
+bool CNullAudioSink::IsClocked() const {
+	return m_bRealtime;
+}
+
+int CNullAudioSink::GetBlockSize() const {
+	return m_iBlockSize;
+}
+
+int CNullAudioSink::GetSampleSize() const {
+	return m_iSampleSize;
+}
+
+int CNullAudioSink::GetSampleRate() const {
+	return m_iSampleRate;
+}
+
+int CNullAudioSink::GetChannels() const {
+	return m_iChannels;
+}
+
+std::uint64_t CNullAudioSink::GetBlocksWritten() const {
+	return m_iBlocksWritten;
+}
+
+CFileAudioSink::CFileAudioSink(const fs::path &Path, int SampleRate, int SampleSize, int Channels, int BlockSize, bool Realtime) :
+	CNullAudioSink(SampleRate, SampleSize, Channels, BlockSize, Realtime),
+	m_File(Path, std::ios::binary | std::ios::trunc)
+{
+	WriteHeader();
+}
+
+CFileAudioSink::~CFileAudioSink() {
+	if (IsOpen()) {
+		// fill in the chunk sizes
+		m_File.seekp(0);
+		WriteHeader();
+	}
+}
+
+bool CFileAudioSink::IsOpen() const {
+	return m_File.is_open() && m_File.good();
+}
+
+bool CFileAudioSink::WriteBuffer(array_view<char> Buffer) {
+	if (!CNullAudioSink::WriteBuffer(Buffer) || !IsOpen())
+		return false;
+	m_File.write(Buffer.data(), Buffer.size());
+	m_iDataSize += static_cast<std::uint32_t>(Buffer.size());
+	return IsOpen();
+}
+
+void CFileAudioSink::WriteHeader() {
+	const auto Write = [&] (std::uint32_t x, int bytes) {
+		for (int i = 0; i < bytes; ++i)
+			m_File.put(static_cast<char>((x >> (i * 8)) & 0xFF));
+	};
+
+	const std::uint32_t BlockAlign = GetSampleSize() / 8 * GetChannels();
+
+	m_File.write("RIFF", 4);
+	Write(36u + m_iDataSize, 4);
+	m_File.write("WAVEfmt ", 8);
+	Write(16u, 4);
+	Write(1u, 2);						// WAVE_FORMAT_PCM
+	Write(GetChannels(), 2);
+	Write(GetSampleRate(), 4);
+	Write(GetSampleRate() * BlockAlign, 4);
+	Write(BlockAlign, 2);
+	Write(GetSampleSize(), 2);
+	m_File.write("data", 4);
+	Write(m_iDataSize, 4);
+}
@@ -0,0 +1,87 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+
+#pragma once
+
+#include "AudioSink.h"
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include "ft0cc/fs.h"
+
+// // // Audio sinks without a sound card
+
+// Discards all audio. By default blocks are requested as fast as the driver can
+// supply them; in real-time mode the sink requests blocks at the sample rate
+class CNullAudioSink : public CAudioSink {
+public:
+	CNullAudioSink(int SampleRate, int SampleSize, int Channels, int BlockSize, bool Realtime = false);
+
+	bool Play() override;
+	bool Stop() override;
+	bool IsPlaying() const override;
+	bool ClearBuffer() override;
+	bool WriteBuffer(array_view<char> Buffer) override;
+
+	buffer_event_t WaitForSyncEvent(unsigned Timeout) override;
+	bool IsClocked() const override;
+
+	int GetBlockSize() const override;
+	int GetSampleSize() const override;
+	int GetSampleRate() const override;
+	int GetChannels() const override;
+
+	// Number of blocks written since the sink was created
+	std::uint64_t GetBlocksWritten() const;
+
+private:
+	using clock_t = std::chrono::steady_clock;
+
+	int m_iSampleRate;
+	int m_iSampleSize;
+	int m_iChannels;
+	int m_iBlockSize;
+	bool m_bRealtime;
+	bool m_bPlaying = false;
+	clock_t::duration m_BlockDuration;
+	clock_t::time_point m_NextBlock;
+	std::uint64_t m_iBlocksWritten = 0u;
+};
+
+// Streams all audio to a PCM wave file
+class CFileAudioSink : public CNullAudioSink {
+public:
+	CFileAudioSink(const fs::path &Path, int SampleRate, int SampleSize, int Channels, int BlockSize, bool Realtime = false);
+	~CFileAudioSink();
+
+	bool IsOpen() const;
+
+	bool WriteBuffer(array_view<char> Buffer) override;
+
+private:
+	void WriteHeader();
+
+private:
+	std::ofstream m_File;
+	std::uint32_t m_iDataSize = 0u;
+};
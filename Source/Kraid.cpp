@@ -26,6 +26,7 @@
 #include "Instrument2A03.h"
 #include "SongData.h"
 #include "Sequence.h"
+#include <utility>		// // //
 
 void Kraid::operator()(CFamiTrackerModule &modfile) {
 	buildDoc(modfile);
@@ -76,7 +77,7 @@ std::unique_ptr<CSongData> Kraid::makeSong(CFamiTrackerModule &modfile) {
 	int f = 0;
 	int r = 0;
 	do { // TODO: use CSongIterator
-		auto note = pSong->GetPatternOnFrame(chan_id_t::SQUARE2, f).GetNoteOn(r);
+		auto note = std::as_const(*pSong).GetPatternOnFrame(chan_id_t::SQUARE2, f).GetNoteOn(r);		// // //
 		if (++r >= ROWS) {
 			r = 0;
 			if (++f >= FRAMES)
@@ -0,0 +1,268 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "OfflineRenderer.h"
+#include <cmath>
+#include <algorithm>
+#include "FamiTrackerEnv.h"
+#include "Settings.h"
+#include "FamiTrackerModule.h"
+#include "SongData.h"
+#include "ChannelOrder.h"
+#include "APU/APU.h"
+#include "APU/Mixer.h"
+#include "APU/SoundChip.h"
+#include "SoundChipService.h"
+#include "SoundDriver.h"
+#include "TempoCounter.h"
+#include "PlayerCursor.h"
+#include "WaveRenderer.h"
+#include "NumConv.h"
+#include "SampleConversion.h"		// // //
+#include "str_conv/str_conv.hpp"
+
+COfflineRenderer::COfflineRenderer(const CFamiTrackerModule &modfile, std::shared_ptr<CWaveRenderer> pRender) :
+	modfile_(modfile),
+	renderer_(std::move(pRender)),
+	apu_(std::make_unique<CAPU>([] (sound_chip_t c, CMixer &mixer) {
+		return Env.GetSoundChipService()->MakeSoundChipDriver(c, mixer);
+	}, this)),
+	driver_(std::make_unique<CSoundDriver>(this)),
+	tempo_(std::make_shared<CTempoCounter>(modfile))
+{
+	driver_->SetupTracks();
+	driver_->AssignModule(modfile_);
+	driver_->LoadAPU(*apu_);
+	driver_->SetTempoCounter(tempo_);
+	driver_->ConfigureDocument();
+}
+
+COfflineRenderer::~COfflineRenderer() {
+}
+
+void COfflineRenderer::SetChannelMute(chan_id_t chan, bool mute) {
+	muted_[value_cast(chan)] = mute;
+}
+
+int COfflineRenderer::GetOutputChannels() {
+	return Env.GetSettings()->Sound.bStereo ? 2 : 1;
+}
+
+int COfflineRenderer::GetOutputSampleSize() {		// // //
+	const CSettings *pSettings = Env.GetSettings();
+	return IsValidSampleSize(pSettings->Sound.iRenderSampleSize) ? pSettings->Sound.iRenderSampleSize : pSettings->Sound.iSampleSize;
+}
+
+bool COfflineRenderer::Render() {
+	if (!renderer_ || !SetupAPU()) {
+		done_ = true;
+		return false;
+	}
+
+	apu_->SetStemCallback(renderer_->HasStems() ? this : nullptr);		// // //
+	renderer_->Start();
+	ResetAPU();
+	driver_->ResetTracks();
+
+	// Same frame sequence as CSoundGen::IdleLoop, minus the audio device synchronization
+	while (!cancel_) {
+		driver_->Tick();
+
+		if (renderer_->ShouldStopRender())
+			break;
+		if (renderer_->ShouldStartPlayer())
+			BeginPlayer();
+
+		UpdateAPU();
+
+		if (driver_->ShouldHalt())
+			HaltPlayer();
+	}
+
+	renderer_->CloseOutputFile();
+	done_ = true;
+	return !cancel_;
+}
+
+void COfflineRenderer::Cancel() {
+	cancel_ = true;
+}
+
+bool COfflineRenderer::IsDone() const {
+	return done_;
+}
+
+bool COfflineRenderer::SetupAPU() {
+	const CSettings *pSettings = Env.GetSettings();
+
+	const machine_t Machine = modfile_.GetMachine();
+	const int BaseFreq = (Machine == NTSC) ? MASTER_CLOCK_NTSC : MASTER_CLOCK_PAL;
+	const int Rate = modfile_.GetFrameRate();
+	const apu_machine_t APUMachine = (Machine == NTSC) ? MACHINE_NTSC : MACHINE_PAL;
+
+	sampleSize_ = GetOutputSampleSize();		// // //
+	gain_ = static_cast<float>(std::pow(10., -std::max(pSettings->Sound.iRenderHeadroom, 0) / 20.));
+	updateCycles_ = BaseFreq / Rate;
+
+	apu_->SetExternalSound(modfile_.GetSoundChipSet());
+	if (!apu_->SetupSound(pSettings->Sound.iSampleRate, GetOutputChannels(), APUMachine))		// // //
+		return false;
+	LoadChannelPan(pSettings->Sound.strChannelPan);
+	apu_->ChangeMachineRate(APUMachine, Rate);
+
+	apu_->SetChipLevel(CHIP_LEVEL_APU1, float(pSettings->ChipLevels.iLevelAPU1 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_APU2, float(pSettings->ChipLevels.iLevelAPU2 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_VRC6, float(pSettings->ChipLevels.iLevelVRC6 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_VRC7, float(pSettings->ChipLevels.iLevelVRC7 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_MMC5, float(pSettings->ChipLevels.iLevelMMC5 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_FDS, float(pSettings->ChipLevels.iLevelFDS / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_N163, float(pSettings->ChipLevels.iLevelN163 / 10.0f));
+	apu_->SetChipLevel(CHIP_LEVEL_S5B, float(pSettings->ChipLevels.iLevelS5B / 10.0f));
+
+	apu_->SetupMixer(pSettings->Sound.iBassFilter, pSettings->Sound.iTrebleFilter,
+					 pSettings->Sound.iTrebleDamping, pSettings->Sound.iMixVolume);
+	apu_->SetNamcoMixing(pSettings->m_bNamcoMixing);
+
+	return true;
+}
+
+void COfflineRenderer::LoadChannelPan(std::wstring_view str) {
+	// Comma-separated list of <short channel name>=<pan>, channels not listed are centered
+	const CSoundChipService *pSCS = Env.GetSoundChipService();
+	while (!str.empty()) {
+		std::wstring_view item = str.substr(0, str.find(L','));
+		str.remove_prefix(std::min(str.size(), item.size() + 1));
+
+		std::size_t eq = item.find(L'=');
+		if (eq == std::wstring_view::npos)
+			continue;
+		auto Pan = conv::to_int(item.substr(eq + 1));
+		if (!Pan)
+			continue;
+		std::string name = conv::to_utf8(item.substr(0, eq));
+		modfile_.GetChannelOrder().ForeachChannel([&] (chan_id_t ch) {
+			if (pSCS->GetShortChannelName(ch) == name)
+				apu_->SetChannelPan(ch, *Pan);
+		});
+	}
+}
+
+void COfflineRenderer::ResetAPU() {
+	apu_->Reset();
+
+	// Enable all channels
+	apu_->Write(0x4015, 0x0F);
+	apu_->Write(0x4017, 0x00);
+	apu_->Write(0x4023, 0x02);		// FDS enable
+
+	// MMC5
+	apu_->Write(0x5015, 0x03);
+}
+
+void COfflineRenderer::UpdateAPU() {
+	// Keep the register write timing identical to real-time playback
+	int cycles = updateCycles_;
+	sound_chip_t LastChip = sound_chip_t::NONE;
+
+	driver_->ForeachTrack([&] (CChannelHandler &, CTrackerChannel &, chan_id_t ID) {
+		if (modfile_.GetChannelOrder().HasChannel(ID)) {
+			sound_chip_t Chip = GetChipFromChannel(ID);
+			int Delay = (Chip == LastChip) ? 150 : 250;
+			if (Delay < cycles) {
+				cycles -= Delay;
+				apu_->AddTime(Delay);
+			}
+			LastChip = Chip;
+		}
+		apu_->Process();
+	});
+
+	apu_->AddTime(cycles);
+	apu_->Process();
+	apu_->EndFrame();
+}
+
+void COfflineRenderer::BeginPlayer() {
+	const int Track = renderer_->GetRenderTrack();
+	const CSongData &song = *modfile_.GetSong(Track);
+
+	driver_->StartPlayer(std::make_unique<CPlayerCursor>(song, Track));
+	tempo_->LoadTempo(song);
+
+	ResetAPU();
+	apu_->Reset();
+	driver_->ResetTracks();
+}
+
+void COfflineRenderer::HaltPlayer() {
+	apu_->Reset();
+	driver_->ResetTracks();
+	driver_->StopPlayer();
+}
+
+array_view<char> COfflineRenderer::ConvertSamples(array_view<float> Buffer) {
+	convBuffer_.resize(Buffer.size() * (sampleSize_ / 8));		// // //
+	::ConvertSamples(Buffer, convBuffer_.data(), sampleSize_, gain_);
+	return {convBuffer_.data(), convBuffer_.size()};
+}
+
+void COfflineRenderer::FlushBuffer(array_view<float> Buffer) {
+	renderer_->FlushBuffer(ConvertSamples(Buffer));
+}
+
+void COfflineRenderer::FlushStem(chan_id_t Chan, array_view<float> Buffer) {		// // //
+	renderer_->FlushStem(Chan, ConvertSamples(Buffer));
+}
+
+bool COfflineRenderer::PlayBuffer() {
+	return true;
+}
+
+CInstrumentManager *COfflineRenderer::GetInstrumentManager() const {
+	return modfile_.GetInstrumentManager();
+}
+
+void COfflineRenderer::OnTick() {
+	renderer_->Tick();
+}
+
+void COfflineRenderer::OnStepRow() {
+	renderer_->StepRow();
+}
+
+void COfflineRenderer::OnPlayNote(chan_id_t chan, const stChanNote &note) {
+}
+
+void COfflineRenderer::OnUpdateRow(int frame, int row) {
+}
+
+bool COfflineRenderer::IsChannelMuted(chan_id_t chan) const {
+	return muted_[value_cast(chan)];
+}
+
+bool COfflineRenderer::ShouldStopPlayer() const {
+	return renderer_->ShouldStopPlayer();
+}
+
+bool COfflineRenderer::IsPlaying() const {
+	return driver_->IsPlaying();
+}
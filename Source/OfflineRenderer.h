@@ -0,0 +1,106 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <string_view>
+#include "Common.h"
+#include "SoundGenBase.h"
+#include "APU/Types.h"
+
+class CFamiTrackerModule;
+class CWaveRenderer;
+class CAPU;
+class CSoundDriver;
+class CTempoCounter;
+
+// // // Headless WAV renderer, emulates the sound driver and APU in a tight loop
+// without an audio device and writes the output directly to a wave renderer;
+// stems requested by the wave renderer are produced in the same pass
+
+class COfflineRenderer : public CSoundGenBase, public IAudioCallback, public IStemCallback {
+public:
+	COfflineRenderer(const CFamiTrackerModule &modfile, std::shared_ptr<CWaveRenderer> pRender);
+	~COfflineRenderer();
+
+	void SetChannelMute(chan_id_t chan, bool mute);
+
+	// // // Number of channels in the rendered output, the wave file should be opened with this
+	static int GetOutputChannels();
+	// // // Sample size of the rendered output in bits, 32 for floating-point samples
+	static int GetOutputSampleSize();
+
+	// Renders the whole track, returns false if cancelled or if the APU could not be set up
+	bool Render();
+	// Safe to call from any thread
+	void Cancel();
+	bool IsDone() const;
+
+private:
+	bool SetupAPU();
+	void LoadChannelPan(std::wstring_view str);		// // //
+	array_view<char> ConvertSamples(array_view<float> Buffer);		// // //
+	void ResetAPU();
+	void UpdateAPU();
+	void BeginPlayer();
+	void HaltPlayer();
+
+	// IAudioCallback impl
+	void FlushBuffer(array_view<float> Buffer) override;
+	bool PlayBuffer() override;
+
+	// IStemCallback impl
+	void FlushStem(chan_id_t Chan, array_view<float> Buffer) override;
+
+	// CSoundGenBase impl
+	CInstrumentManager *GetInstrumentManager() const override;
+	void OnTick() override;
+	void OnStepRow() override;
+	void OnPlayNote(chan_id_t chan, const stChanNote &note) override;
+	void OnUpdateRow(int frame, int row) override;
+	bool IsChannelMuted(chan_id_t chan) const override;
+	bool ShouldStopPlayer() const override;
+	bool IsPlaying() const override;
+
+private:
+	const CFamiTrackerModule &modfile_;
+	std::shared_ptr<CWaveRenderer> renderer_;
+
+	std::unique_ptr<CAPU> apu_;
+	std::unique_ptr<CSoundDriver> driver_;
+	std::shared_ptr<CTempoCounter> tempo_;
+
+	std::vector<char> convBuffer_;
+	std::array<bool, CHANID_COUNT> muted_ = { };
+
+	int sampleSize_ = 16;
+	float gain_ = 1.f;		// // // headroom
+	int updateCycles_ = 0;
+
+	std::atomic_bool cancel_ = false;
+	std::atomic_bool done_ = false;
+};
@@ -30,6 +30,7 @@
 #include "PatternClipData.h"		// // //
 #include "FamiTrackerModule.h"		// // //
 #include "SongView.h"		// // //
+#include <utility>		// // //
 
 // // // all dependencies on CMainFrame
 #define GET_VIEW() static_cast<CFamiTrackerView *>(MainFrm.GetActiveView())
@@ -282,7 +283,7 @@ CPActionEditNote::CPActionEditNote(const stChanNote &Note) :
 
 bool CPActionEditNote::SaveState(const CMainFrame &MainFrm)
 {
-	m_OldNote = GET_SONG_VIEW()->GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
+	m_OldNote = std::as_const(*GET_SONG_VIEW()).GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
 		.GetNoteOn(m_pUndoState->Cursor.m_iRow);		// // //
 	return true;
 }
@@ -308,7 +309,7 @@ CPActionReplaceNote::CPActionReplaceNote(const stChanNote &Note, int Frame, int
 
 bool CPActionReplaceNote::SaveState(const CMainFrame &MainFrm)
 {
-	m_OldNote = GET_SONG_VIEW()->GetPatternOnFrame(m_iChannel, m_iFrame).GetNoteOn(m_iRow);		// // //
+	m_OldNote = std::as_const(*GET_SONG_VIEW()).GetPatternOnFrame(m_iChannel, m_iFrame).GetNoteOn(m_iRow);		// // //
 	return true;
 }
 
@@ -327,7 +328,7 @@ void CPActionReplaceNote::Redo(CMainFrame &MainFrm)
 bool CPActionInsertRow::SaveState(const CMainFrame &MainFrm)
 {
 	CSongView *pSongView = GET_SONG_VIEW();
-	m_OldNote = GET_SONG_VIEW()->GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
+	m_OldNote = std::as_const(*GET_SONG_VIEW()).GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
 		.GetNoteOn(pSongView->GetSong().GetPatternLength() - 1);		// // //
 	return true;
 }
@@ -358,7 +359,7 @@ bool CPActionDeleteRow::SaveState(const CMainFrame &MainFrm)
 	if (m_bBack && !m_pUndoState->Cursor.m_iRow)
 		return false;
 	m_iRow = m_pUndoState->Cursor.m_iRow - (m_bBack ? 1 : 0);
-	m_OldNote = GET_SONG_VIEW()->GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
+	m_OldNote = std::as_const(*GET_SONG_VIEW()).GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
 		.GetNoteOn(m_iRow);		// // //
 
 	m_NewNote = m_OldNote;
@@ -445,7 +446,7 @@ bool CPActionScrollField::SaveState(const CMainFrame &MainFrm)
 		Old = static_cast<unsigned char>(New);
 	};
 
-	m_OldNote = GET_SONG_VIEW()->GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
+	m_OldNote = std::as_const(*GET_SONG_VIEW()).GetPatternOnFrame(m_pUndoState->Cursor.m_iChannel, m_pUndoState->Cursor.m_iFrame)
 		.GetNoteOn(m_pUndoState->Cursor.m_iRow);		// // //
 	m_NewNote = m_OldNote;
 
@@ -31,8 +31,11 @@
 #include "FamiTrackerModule.h"		// // //
 #include "InstrumentManager.h"		// // //
 #include "SongData.h"		// // //
+#include "PatternData.h"		// // //
 #include "NumConv.h"		// // //
 #include <algorithm>		// // //
+#include <unordered_map>		// // //
+#include <string>		// // //
 
 /**
  * CPatternCompiler - Compress patterns to strings for the NSF code
@@ -59,6 +62,10 @@
 // Use single-byte instrument commands for instrument 0-15 (default on)
 #define PACKED_INST_CHANGE
 
+// // // Find repeated row entries for loop compression (default off)
+// The bundled drivers do not support the loop command, so the result is only reported
+//#define OPTIMIZE_LOOPS
+
 // Command table
 enum command_t {
 	CMD_INSTRUMENT,
@@ -115,7 +122,10 @@ enum command_t {
 	CMD_EFF_S5B_NOISE,			// // // 050B
 };
 
-const unsigned char CMD_LOOP_POINT = 26;	// Currently unused
+// // // Loop command for compressed pattern data, command bytes written by Command() are all even
+const unsigned char LOOP_POINT = 0x81;
+const unsigned LOOP_MAX_LENGTH = 0xFF;
+const unsigned LOOP_MAX_REPEATS = 0xFF;
 
 CPatternCompiler::CPatternCompiler(const CFamiTrackerModule &ModFile, const std::vector<unsigned> &InstList, const DPCM_List_t *pDPCMList, std::shared_ptr<CCompilerLog> pLogger) :		// // //
 	m_iInstrumentList(InstList),
@@ -144,6 +154,7 @@ void CPatternCompiler::CompileData(int Track, int Pattern, chan_id_t Channel) {
 
 	m_vData.clear();
 	m_vCompressedData.clear();
+	m_vEntryPos.assign(1, 0);		// // //
 
 	// Local init
 	unsigned int iPatternLen = pSong->GetPatternLength();
@@ -151,8 +162,13 @@ void CPatternCompiler::CompileData(int Track, int Pattern, chan_id_t Channel) {
 	unsigned char DPCMInst = 0;
 	unsigned char NESNote = 0;
 
+	const auto &PatternData = pSong->GetPattern(Channel, Pattern);		// // //
+#ifdef OPTIMIZE_DURATIONS
+	const auto Spacing = ScanNoteLengths(PatternData, iPatternLen, EffColumns);		// // //
+#endif /* OPTIMIZE_DURATIONS */
+
 	for (unsigned int i = 0; i < iPatternLen; ++i) {
-		stChanNote ChanNote = pSong->GetPattern(Channel, Pattern).GetNoteOn(i);		// // //
+		stChanNote ChanNote = PatternData.GetNoteOn(i);		// // //
 
 		note_t Note = ChanNote.Note;
 		unsigned char Octave = ChanNote.Octave;
@@ -196,7 +212,7 @@ void CPatternCompiler::CompileData(int Track, int Pattern, chan_id_t Channel) {
 #ifdef OPTIMIZE_DURATIONS
 
 		// Determine length of space between notes
-		stSpacingInfo SpaceInfo = ScanNoteLengths(Track, i, Pattern, Channel);		// // //
+		const stSpacingInfo &SpaceInfo = Spacing[i];		// // //
 
 		if (SpaceInfo.SpaceCount > 2) {
 			if (SpaceInfo.SpaceSize != m_iCurrentDefaultDuration && SpaceInfo.SpaceCount != 0xFF) {
@@ -654,7 +670,12 @@ void CPatternCompiler::CompileData(int Track, int Pattern, chan_id_t Channel) {
 
 	WriteDuration();
 
-//	OptimizeString();
+#ifdef OPTIMIZE_LOOPS
+	OptimizeString();		// // //
+	if (m_vCompressedData.size() < m_vData.size())
+		Print(" * Loops would save " + conv::from_uint(m_vData.size() - m_vCompressedData.size()) +
+			" bytes (channel " + conv::from_uint(value_cast(Channel)) + ", pattern " + conv::from_uint(Pattern) + ")\n");
+#endif /* OPTIMIZE_LOOPS */
 }
 
 unsigned char CPatternCompiler::Command(int cmd) const {
@@ -690,15 +711,20 @@ unsigned int CPatternCompiler::FindSample(int Instrument, int MidiNote) const		/
 	return (*m_pDPCMList)[Instrument][MidiNote];
 }
 
-CPatternCompiler::stSpacingInfo CPatternCompiler::ScanNoteLengths(int Track, unsigned int StartRow, int Pattern, chan_id_t Channel) {		// // //
-	const auto *pSong = modfile_.GetSong(Track);		// // //
-	if (!pSong)
-		return { };
-
-	int StartSpace = -1, Space = 0, SpaceCount = 0;
-
-	for (unsigned i = StartRow; i < pSong->GetPatternLength(); ++i) {
-		const auto &NoteData = pSong->GetPattern(Channel, Pattern).GetNoteOn(i);		// // //
+std::vector<CPatternCompiler::stSpacingInfo>
+CPatternCompiler::ScanNoteLengths(const CPatternData &Pattern, unsigned Rows, unsigned EffColumns) {		// // //
+	// For each used row, SpaceSize is the number of empty rows before the next used row, and
+	// SpaceCount is how many of the following used rows are followed by the same spacing,
+	// the last used row counting the empty rows until the end of the pattern.
+	// Empty rows get {0xFF, -1}; used rows without any used row after them get {0, -1}.
+	std::vector<stSpacingInfo> Info(Rows, stSpacingInfo {0xFF, -1});
+	std::vector<int> Space(Rows);		// empty rows after each used row
+	std::vector<int> Run(Rows);			// used rows in a row followed by the same spacing
+
+	// single backward pass
+	unsigned Next = Rows;
+	for (unsigned i = Rows; i-- > 0;) {
+		const auto &NoteData = Pattern.GetNoteOn(i);
 		bool NoteUsed = false;
 
 		if (NoteData.Note != note_t::NONE)
@@ -707,32 +733,27 @@ CPatternCompiler::stSpacingInfo CPatternCompiler::ScanNoteLengths(int Track, uns
 			NoteUsed = true;
 		else if (NoteData.Vol < MAX_VOLUME)
 			NoteUsed = true;
-		else for (unsigned j = 0, Count = pSong->GetEffectColumnCount(Channel); j < Count; ++j)
+		else for (unsigned j = 0; j < EffColumns; ++j)
 			if (NoteData.EffNumber[j] != effect_t::NONE)
 				NoteUsed = true;
 
-		if (i == StartRow && !NoteUsed)
-			return {0xFF, StartSpace};
-
-		if (i > StartRow) {
-			if (NoteUsed) {
-				if (StartSpace == -1)
-					StartSpace = Space;
-				else if (StartSpace == Space)
-					++SpaceCount;
-				else
-					return {SpaceCount, StartSpace};
-				Space = 0;
-			}
-			else
-				++Space;
+		if (!NoteUsed)
+			continue;
+
+		Space[i] = Next - i - 1;
+		if (Next < Rows) {
+			const bool Same = Space[Next] == Space[i];
+			Run[i] = Same ? Run[Next] + 1 : 1;
+			Info[i] = {Same ? Run[Next] : 0, Space[i]};
+		}
+		else {
+			Run[i] = 1;
+			Info[i] = {0, -1};
 		}
+		Next = i;
 	}
 
-	if (StartSpace == Space)
-		++SpaceCount;
-
-	return {SpaceCount, StartSpace};
+	return Info;
 }
 
 void CPatternCompiler::WriteData(unsigned char Value)
@@ -758,144 +779,81 @@ void CPatternCompiler::WriteDuration()
 	}
 
 	m_iDuration = 0;
-}
 
-// Returns the size of the block at 'position' in the data array. A block is terminated by a note
-int CPatternCompiler::GetBlockSize(int Position)
-{
-	unsigned int Pos = Position;
-
-	int iDuration = 1;
-
-	// Find if note duration optimization is on
-	for (int i = 0; i < Position; ++i) {
-		if (m_vData[i] == Command(CMD_SET_DURATION))
-			iDuration = 0;
-		else if (m_vData[i] == Command(CMD_RESET_DURATION))
-			iDuration = 1;
-	}
-
-	for (; Pos < m_vData.size(); ++Pos) {
-		unsigned char data = m_vData[Pos];
-		if (data < 0x80) {		// Note
-			//int size = (Pos + 1 + iDuration) - Position;
-			int size = (Pos - Position);
-//			if (size > 1)
-//				return size - 1;
-
-			return size + 1 + iDuration;// (Pos + 1 + iDuration) - Position;
-		}
-		else if (data == Command(CMD_SET_DURATION))
-			iDuration = 0;
-		else if (data == Command(CMD_RESET_DURATION))
-			iDuration = 1;
-		else {
-			if (data < 0xE0 || data > 0xEF)
-				++Pos;				// Command, skip parameter
-		}
-	//	++Pos;
-	}
-
-	// Error
-	return 1;
+	if (m_vEntryPos.back() != m_vData.size())		// // // the player reads a command next
+		m_vEntryPos.push_back(m_vData.size());
 }
 
-void CPatternCompiler::OptimizeString()
+void CPatternCompiler::OptimizeString()		// // //
 {
-	// Try to optimize by finding repeating patterns and compress them into a loop (simple RLE)
-	//
-
+	// Find repeating runs of row entries and compress them into loops (simple RLE):
 	//
-	// Ok, just figured this won't work without using loads of NES RAM so I'll
-	// probably put this on hold for a while
+	// 80 00 2E 00 2E 00 2E 00 2E 00 2E 00 2E 00 ->
+	// 80 00 2E 00 <loop> 05 02
 	//
+	// The loop point is followed by the number of extra repeats and the number of bytes to
+	// replay, and loops do not nest, so the player only needs one counter per channel.
+	// Runs are made of whole entries, which begin wherever the player reads a command.
 
-	unsigned int i, j, k, l;
-	int matches, best_length = 0, last_inst;
-	bool matched;
-
-	/*
-
-	80 00 2E 00 2E 00 2E 00 2E 00 2E 00 2E 00 ->
-	80 00 2E 00 FF 06 02
-
-	*/
-
-	// Always copy first 2 bytes
-//	memcpy(m_pCompressedData, m_pData, 2);
-//	m_iCompressedDataPointer += 2;
-
-	if (m_vData[0] == 0x80)
-		last_inst = m_vData[1];
-	else
-		last_inst = 0;
-
-	// Loop from start
-	for (i = 0; i < m_vData.size(); /*i += 2*/) {
-
-		int best_matches = 0;
-
-		// Instrument
-		if (m_vData[i] == 0x80)
-			last_inst = m_vData[i + 1];
-		else if (m_vData[i] >= 0xE0 && m_vData[i] <= 0xEF)
-			last_inst = m_vData[i & 0xF];
+	m_vCompressedData.clear();
 
-		// Start checking from the first tuple
-		for (l = GetBlockSize(i); l < (m_vData.size() - i); /*l += 2*/) {
-			matches = 0;
-			// See how many following matches there are from this combination in a row
-			for (j = i + l; j <= m_vData.size(); j += l) {
-				matched = true;
-				// Compare one word
-				for (k = 0; k < l; ++k) {
-					if (m_vData[i + k] != m_vData[j + k])
-						matched = false;
-				}
-				if (!matched)
-					break;
-				++matches;
-				/*
-				if ((j + l) <= m_iDataPointer) {
-					if (memcmp(m_pData + i, m_pData + j, l) == 0)
-						++matches;
-					else
-						break;
-				}
-				*/
-			}
-			// Save
-			if (matches > best_matches) {
-				best_matches = matches;
-				best_length = l;
-			}
+	const std::size_t Entries = m_vEntryPos.size() - 1;
+	const auto EntrySize = [&] (std::size_t Begin, std::size_t End) {
+		return static_cast<unsigned>(m_vEntryPos[End] - m_vEntryPos[Begin]);
+	};
+
+	// label identical entries so that runs can be compared one entry at a time
+	std::vector<unsigned> Label(Entries);
+	{
+		std::unordered_map<std::string, unsigned> Labels;
+		for (std::size_t i = 0; i < Entries; ++i)
+			Label[i] = Labels.try_emplace(std::string(m_vData.begin() + m_vEntryPos[i], m_vData.begin() + m_vEntryPos[i + 1]),
+				(unsigned)Labels.size()).first->second;
+	}
 
-			l += GetBlockSize(i + l);
+	// for every period, Match[i] is the number of entries from i on that equal the ones a period later;
+	// the best loop starting at each entry is kept, so this takes O(entries * loop length)
+	struct stLoop {
+		std::size_t Period = 0;
+		unsigned Repeats = 0;
+		int Saved = 0;
+	};
+	std::vector<stLoop> Best(Entries);
+	std::vector<std::size_t> Match(Entries + 1);
+	for (std::size_t Period = 1; Period <= Entries / 2; ++Period) {
+		Match[Entries - Period] = 0;
+		for (std::size_t i = Entries - Period; i-- > 0;)
+			Match[i] = Label[i] == Label[i + Period] ? Match[i + 1] + 1 : 0;
+		bool Fits = false;
+		for (std::size_t i = 0; i + Period * 2 <= Entries; ++i) {
+			const unsigned Size = EntrySize(i, i + Period);
+			if (Size > LOOP_MAX_LENGTH)
+				continue;
+			Fits = true;
+			const unsigned Repeats = static_cast<unsigned>(std::min<std::size_t>(Match[i] / Period, LOOP_MAX_REPEATS));
+			const int Saved = (int)(Repeats * Size) - 3;
+			if (Saved > Best[i].Saved)
+				Best[i] = {Period, Repeats, Saved};
 		}
-		// Compress
-		if ((best_matches > 1 && best_length > 4) || best_matches > 2 /*&& (best_length > 2 && best_matches > 1)*/) {
-			// Include the first one
-			++best_matches;
-			int size = best_length * best_matches;
-			//
-			// Last known instrument must also be added
-			//
-			std::copy_n(m_vData.begin() + i, best_length, m_vCompressedData.end());		// // //
-			// Define a loop point: 0xFF (number of loops) (number of bytes)
-			m_vCompressedData.push_back(Command(CMD_LOOP_POINT));
-			m_vCompressedData.push_back(best_matches - 1);	// the nsf code sees one less
-			m_vCompressedData.push_back(best_length);
-			i += size;
+		if (!Fits)		// every body of this period is too long, so are longer ones
+			break;
+	}
+
+	for (std::size_t i = 0; i < Entries;) {
+		auto Begin = m_vData.begin() + m_vEntryPos[i];
+		if (const auto &x = Best[i]; x.Saved > 0) {
+			const unsigned Size = EntrySize(i, i + x.Period);
+			m_vCompressedData.insert(m_vCompressedData.end(), Begin, Begin + Size);
+			m_vCompressedData.push_back(LOOP_POINT);
+			m_vCompressedData.push_back(x.Repeats);
+			m_vCompressedData.push_back(Size);
+			i += x.Period * (x.Repeats + 1);
 		}
 		else {
-			// No loop
-			int size = GetBlockSize(i);
-			std::copy_n(m_vData.begin() + i, size, m_vCompressedData.end());		// // //
-			i += size;
+			m_vCompressedData.insert(m_vCompressedData.end(), Begin, Begin + EntrySize(i, i + 1));
+			++i;
 		}
 	}
-
-	(void)last_inst;		// // //
 }
 
 unsigned int CPatternCompiler::GetHash() const
@@ -931,5 +889,58 @@ unsigned int CPatternCompiler::GetDataSize() const
 
 unsigned int CPatternCompiler::GetCompressedDataSize() const
 {
+#ifdef OPTIMIZE_LOOPS
 	return m_vCompressedData.size();
+#else
+	return m_vData.size();		// // // nothing is compressed
+#endif /* OPTIMIZE_LOOPS */
+}
+
+// // // CPatternCompilerCache
+
+CPatternCompilerCache::key_t CPatternCompilerCache::MakeKey(const CPatternData &Data, chan_id_t Channel, unsigned Pattern, unsigned Rows, unsigned EffColumns, bool Tempo) {
+	// 64-bit FNV-1a over every field of the rows that are compiled
+	std::uint64_t Hash = 0xCBF29CE484222325u;
+	const auto Add = [&] (unsigned x) {
+		Hash = (Hash ^ x) * 0x100000001B3u;
+	};
+	Data.VisitRows(Rows, [&] (const stChanNote &Note) {
+		Add(value_cast(Note.Note));
+		Add(Note.Octave);
+		Add(Note.Vol);
+		Add(Note.Instrument);
+		for (int i = 0; i < MAX_EFFECT_COLUMNS; ++i) {
+			Add(value_cast(Note.EffNumber[i]));
+			Add(Note.EffParam[i]);
+		}
+	});
+
+	return {Hash, value_cast(Channel), Pattern, Rows | (EffColumns << 16) | (Tempo ? 1u << 24 : 0u)};
+}
+
+void CPatternCompilerCache::SetContext(std::vector<std::uint64_t> Context) {
+	if (Context != m_Context) {
+		m_Context = std::move(Context);
+		m_Entries.clear();
+	}
+}
+
+const CPatternCompilerCache::stEntry *CPatternCompilerCache::Find(const key_t &Key) {
+	auto it = m_Entries.find(Key);
+	if (it == m_Entries.end())
+		return nullptr;
+	it->second.Used = true;
+	return &it->second.Entry;
+}
+
+void CPatternCompilerCache::Store(const key_t &Key, stEntry Entry) {
+	m_Entries.insert_or_assign(Key, stItem {std::move(Entry)});
+}
+
+void CPatternCompilerCache::Prune() {
+	for (auto it = m_Entries.begin(); it != m_Entries.end(); )
+		if (it->second.Used)
+			(it++)->second.Used = false;
+		else
+			it = m_Entries.erase(it);
 }
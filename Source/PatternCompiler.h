@@ -28,9 +28,14 @@
 #include "APU/Types_fwd.h"		// // //
 #include <memory>		// // //
 #include <string_view>		// // //
+#include <string>		// // //
+#include <array>		// // //
+#include <map>		// // //
+#include <cstdint>		// // //
 
 class CFamiTrackerModule;		// // //
 class CCompilerLog;
+class CPatternData;		// // //
 
 using DPCM_List_t = unsigned char[MAX_INSTRUMENTS][NOTE_COUNT];		// // //
 
@@ -67,8 +72,7 @@ private:
 	void			WriteDuration();
 	void			AccumulateDuration();
 	void			OptimizeString();
-	int				GetBlockSize(int Position);
-	stSpacingInfo	ScanNoteLengths(int Track, unsigned int StartRow, int Pattern, chan_id_t Channel);		// // //
+	static std::vector<stSpacingInfo> ScanNoteLengths(const CPatternData &Pattern, unsigned Rows, unsigned EffColumns);		// // //
 
 	// Debugging
 	void			Print(std::string_view text) const;		// // //
@@ -76,6 +80,7 @@ private:
 private:
 	std::vector<unsigned char> m_vData;		// // //
 	std::vector<unsigned char> m_vCompressedData;
+	std::vector<std::size_t> m_vEntryPos;		// // // offsets where the player reads a command
 
 	unsigned int	m_iDuration;
 	unsigned int	m_iCurrentDefaultDuration;
@@ -88,3 +93,39 @@ private:
 	const CFamiTrackerModule &modfile_;		// // //
 	std::shared_ptr<CCompilerLog> m_pLogger;		// // //
 };
+
+// // // Compiled patterns kept between exports of one document. Entries are keyed
+// on a hash of the pattern rows, so an entry is reused as long as the rows and
+// the rest of the compile context are unchanged. Not thread-safe.
+class CPatternCompilerCache
+{
+public:
+	using key_t = std::array<std::uint64_t, 4>;
+
+	struct stEntry {
+		std::vector<unsigned char> Data;
+		unsigned int Hash = 0;
+		unsigned int CompressedSize = 0;
+		std::string Log;
+	};
+
+	static key_t MakeKey(const CPatternData &Data, chan_id_t Channel, unsigned Pattern, unsigned Rows, unsigned EffColumns, bool Tempo);
+
+	// Module-wide data patterns depend on, all entries are dropped when it changes
+	void			SetContext(std::vector<std::uint64_t> Context);
+
+	const stEntry	*Find(const key_t &Key);
+	void			Store(const key_t &Key, stEntry Entry);
+
+	// Drops entries that were not used since the last call
+	void			Prune();
+
+private:
+	struct stItem {
+		stEntry Entry;
+		bool Used = true;
+	};
+
+	std::vector<std::uint64_t> m_Context;
+	std::map<key_t, stItem> m_Entries;
+};
@@ -22,14 +22,24 @@
 
 #include "PatternData.h"
 #include <type_traits>
+#include <utility>		// // //
 
 namespace {
 
 const auto BLANK = stChanNote { };
 
+std::atomic<std::uint64_t> next_version {1u};		// // //
+
 } // namespace
 
-CPatternData::CPatternData(const CPatternData &other) : data_(std::make_unique<elem_t>(*other.data_)) {
+CPatternData::CPatternData(const CPatternData &other) :
+	data_(std::make_unique<elem_t>(*other.data_)), version_(other.GetVersion())		// // //
+{
+}
+
+CPatternData::CPatternData(CPatternData &&other) noexcept :		// // //
+	data_(std::move(other.data_)), version_(other.version_.exchange(0u, std::memory_order_relaxed))
+{
 }
 
 CPatternData &CPatternData::operator=(const CPatternData &other) {
@@ -40,12 +50,22 @@ CPatternData &CPatternData::operator=(const CPatternData &other) {
 		}
 		else
 			data_.reset();
+		version_.store(other.GetVersion(), std::memory_order_relaxed);		// // //
+	}
+	return *this;
+}
+
+CPatternData &CPatternData::operator=(CPatternData &&other) noexcept {		// // //
+	if (this != &other) {
+		data_ = std::move(other.data_);
+		version_.store(other.version_.exchange(0u, std::memory_order_relaxed), std::memory_order_relaxed);
 	}
 	return *this;
 }
 
 stChanNote &CPatternData::GetNoteOn(unsigned row) {
 	Allocate();
+	Touch();		// // //
 	return (*data_)[row];
 }
 
@@ -55,6 +75,7 @@ const stChanNote &CPatternData::GetNoteOn(unsigned row) const {
 
 void CPatternData::SetNoteOn(unsigned row, const stChanNote &note) {
 	Allocate();
+	Touch();		// // //
 	(*data_)[row] = note;
 }
 
@@ -93,7 +114,15 @@ bool CPatternData::IsEmpty() const {
 	return true;
 }
 
+std::uint64_t CPatternData::GetVersion() const noexcept {		// // //
+	return version_.load(std::memory_order_relaxed);
+}
+
 void CPatternData::Allocate() {
 	if (!data_)
 		data_ = std::make_unique<elem_t>();
 }
+
+void CPatternData::Touch() noexcept {		// // //
+	version_.store(next_version.fetch_add(1u, std::memory_order_relaxed), std::memory_order_relaxed);
+}
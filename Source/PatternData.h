@@ -25,6 +25,8 @@
 
 #include <memory>
 #include <array>
+#include <cstdint>		// // //
+#include <atomic>		// // //
 #include "FamiTrackerTypes.h"
 #include "PatternNote.h"
 
@@ -38,9 +40,9 @@ class CPatternData {
 public:
 	CPatternData() = default;
 	CPatternData(const CPatternData &other);
-	CPatternData(CPatternData &&other) noexcept = default;
+	CPatternData(CPatternData &&other) noexcept;		// // //
 	CPatternData &operator=(const CPatternData &other);
-	CPatternData &operator=(CPatternData &&other) noexcept = default;
+	CPatternData &operator=(CPatternData &&other) noexcept;		// // //
 	~CPatternData() noexcept = default;
 
 	stChanNote &GetNoteOn(unsigned row);
@@ -55,6 +57,11 @@ public:
 	unsigned GetNoteCount(int maxrows = max_size) const;
 	bool IsEmpty() const;
 
+	// // // Changes whenever the pattern is written to, through SetNoteOn or the non-const
+	// GetNoteOn and VisitRows; equal versions imply equal contents, so code that only reads
+	// a pattern must use the const overloads
+	std::uint64_t GetVersion() const noexcept;
+
 	// void (*F)(stChanNote &note p [, unsigned row])
 	template <typename F>
 	void VisitRows(F f) {
@@ -70,6 +77,7 @@ public:
 	template <typename F>
 	void VisitRows(unsigned rows, F f) {
 		if (data_) {
+			Touch();		// // //
 			for (unsigned row = 0; row < rows; ++row)
 				if constexpr (std::is_invocable_v<F, stChanNote &>)
 					f((*data_)[row]);
@@ -91,8 +99,20 @@ public:
 
 private:
 	void Allocate();
+	void Touch() noexcept;		// // //
 
 private:
 	using elem_t = std::array<stChanNote, max_size>;
 	std::unique_ptr<elem_t> data_;
+	std::atomic<std::uint64_t> version_ {0u};		// // // 0 for patterns that have never been written to, read by the player thread
+};
+
+// // // deferred pattern contents, see CTrackData::SetPatternSource
+
+class CPatternSource {
+public:
+	virtual ~CPatternSource() noexcept = default;
+
+	// Writes the stored rows into the given pattern
+	virtual void Decode(CPatternData &pattern) const = 0;
 };
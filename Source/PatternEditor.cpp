@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <vector>		// // //
 #include <cmath>
+#include <utility>		// // //
 #include "FamiTrackerEnv.h"		// // //
 #include "FamiTrackerModule.h"		// // //
 #include "InstrumentManager.h"		// // //
@@ -1251,7 +1252,7 @@ void CPatternEditor::DrawRow(CDC &DC, int Row, int Line, int Frame, bool bPrevie
 				bInvert = true;
 			}
 
-			DrawCell(DC, PosX - m_iColumnSpacing / 2, j, i, bInvert, pSongView->GetPatternOnFrame(i, f).GetNoteOn(Row), colorInfo);		// // //
+			DrawCell(DC, PosX - m_iColumnSpacing / 2, j, i, bInvert, std::as_const(*pSongView).GetPatternOnFrame(i, f).GetNoteOn(Row), colorInfo);		// // //
 			PosX += GetColumnSpace(j);
 			if (!m_bCompactMode)		// // //
 				SelStart += GetSelectWidth(j);
@@ -2841,7 +2842,7 @@ std::unique_ptr<CPatternClipData> CPatternEditor::CopyEntire() const
 
 	for (int i = 0; i < ChannelCount; ++i)
 		for (int j = 0; j < Rows; ++j)
-			*pClipData->GetPattern(i, j) = pSongView->GetPatternOnFrame(i, Frame).GetNoteOn(j);		// // //
+			*pClipData->GetPattern(i, j) = std::as_const(*pSongView).GetPatternOnFrame(i, Frame).GetNoteOn(j);		// // //
 
 	return pClipData;
 }
@@ -2904,7 +2905,7 @@ std::unique_ptr<CPatternClipData> CPatternEditor::CopyRaw(const CSelection &Sel)
 	for (int i = 0; i < Channels; ++i)
 		for (int r = 0; r < Rows; ++r) {
 			auto pos = std::div(PackedPos + r, Length);
-			*pClipData->GetPattern(i, r) = pSongView->GetPatternOnFrame(i + cBegin, pos.quot % Frames).GetNoteOn(pos.rem);
+			*pClipData->GetPattern(i, r) = std::as_const(*pSongView).GetPatternOnFrame(i + cBegin, pos.quot % Frames).GetNoteOn(pos.rem);		// // //
 		}
 
 	return pClipData;
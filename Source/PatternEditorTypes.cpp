@@ -27,6 +27,7 @@
 #include "FamiTrackerEnv.h"		// // //
 #include "Settings.h"		// // //
 #include <algorithm>		// // //
+#include <utility>		// // //
 
 // CCursorPos /////////////////////////////////////////////////////////////////////
 
@@ -210,7 +211,7 @@ std::pair<CPatternIterator, CPatternIterator> CPatternIterator::FromSelection(co
 
 const stChanNote &CPatternIterator::Get(int Channel) const
 {
-	return song_view_.GetPatternOnFrame(Channel, TranslateFrame()).GetNoteOn(m_iRow);
+	return std::as_const(song_view_).GetPatternOnFrame(Channel, TranslateFrame()).GetNoteOn(m_iRow);		// // //
 }
 
 void CPatternIterator::Set(int Channel, const stChanNote &Note)
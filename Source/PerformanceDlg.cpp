@@ -72,10 +72,13 @@ void CPerformanceDlg::OnTimer(UINT nIDEvent)
 	unsigned int Usage = theApp.GetCPUUsage();
 	unsigned int Rate = theApp.GetSoundGenerator()->GetFrameRate();
 	unsigned int Underruns = theApp.GetSoundGenerator()->GetAudioDriver()->GetUnderruns();
+	double Latency = theApp.GetSoundGenerator()->GetAudioDriver()->GetLatency();		// // //
 
 	SetDlgItemTextW(IDC_CPU, FormattedW(L"%i%%", Usage / 100));
 	SetDlgItemTextW(IDC_FRAMERATE, AfxFormattedW(IDS_PERFORMANCE_FRAMERATE_FORMAT, FormattedW(L"%i", Rate)));		// // //
 	SetDlgItemTextW(IDC_UNDERRUN, AfxFormattedW(IDS_PERFORMANCE_UNDERRUN_FORMAT, FormattedW(L"%i", Underruns)));		// // //
+	if (Latency > 0.)		// // //
+		SetDlgItemTextW(IDC_LATENCY, AfxFormattedW(IDS_PERFORMANCE_LATENCY_FORMAT, FormattedW(L"%.1f", Latency)));
 
 	pBar->SetRange(0, 100);
 	pBar->SetPos(Usage / 100);
@@ -0,0 +1,105 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include "array_view.h"
+
+// // // Lock-free single-producer single-consumer ring buffer. Write and
+// GetWriteAvailable may only be called by the producer thread, Read, Discard and
+// GetReadAvailable only by the consumer thread; neither side ever blocks.
+
+template <typename T>
+class CRingBuffer {
+public:
+	explicit CRingBuffer(std::size_t Capacity) :
+		m_iCapacity(RoundCapacity(Capacity)),
+		m_pData(std::make_unique<T[]>(m_iCapacity))
+	{
+	}
+
+	std::size_t GetCapacity() const noexcept {
+		return m_iCapacity;
+	}
+
+	// Number of items that can be written right now
+	std::size_t GetWriteAvailable() const noexcept {
+		return m_iCapacity - (m_iWritePos.load(std::memory_order_relaxed) - m_iReadPos.load(std::memory_order_acquire));
+	}
+
+	// Number of items that can be read right now
+	std::size_t GetReadAvailable() const noexcept {
+		return m_iWritePos.load(std::memory_order_acquire) - m_iReadPos.load(std::memory_order_relaxed);
+	}
+
+	// Appends as many items as fit, returns the number of items written
+	std::size_t Write(array_view<T> Data) noexcept {
+		const std::size_t Pos = m_iWritePos.load(std::memory_order_relaxed);
+		const std::size_t Count = std::min(Data.size(), GetWriteAvailable());
+		const std::size_t Offset = Pos & (m_iCapacity - 1);
+		const std::size_t First = std::min(Count, m_iCapacity - Offset);
+		std::copy_n(Data.data(), First, m_pData.get() + Offset);
+		std::copy_n(Data.data() + First, Count - First, m_pData.get());
+		m_iWritePos.store(Pos + Count, std::memory_order_release);
+		return Count;
+	}
+
+	// Removes up to Count items into Dest, returns the number of items read
+	std::size_t Read(T *Dest, std::size_t Count) noexcept {
+		const std::size_t Pos = m_iReadPos.load(std::memory_order_relaxed);
+		Count = std::min(Count, GetReadAvailable());
+		const std::size_t Offset = Pos & (m_iCapacity - 1);
+		const std::size_t First = std::min(Count, m_iCapacity - Offset);
+		std::copy_n(m_pData.get() + Offset, First, Dest);
+		std::copy_n(m_pData.get(), Count - First, Dest + First);
+		m_iReadPos.store(Pos + Count, std::memory_order_release);
+		return Count;
+	}
+
+	// Drops up to Count items without reading them
+	std::size_t Discard(std::size_t Count) noexcept {
+		const std::size_t Pos = m_iReadPos.load(std::memory_order_relaxed);
+		Count = std::min(Count, GetReadAvailable());
+		m_iReadPos.store(Pos + Count, std::memory_order_release);
+		return Count;
+	}
+
+private:
+	static std::size_t RoundCapacity(std::size_t Capacity) noexcept {
+		std::size_t x = 1;
+		while (x < Capacity)
+			x <<= 1;
+		return x;
+	}
+
+private:
+	static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+	const std::size_t m_iCapacity;
+	const std::unique_ptr<T[]> m_pData;
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_iWritePos {0u};		// only stored by the producer
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_iReadPos {0u};		// only stored by the consumer
+};
@@ -0,0 +1,101 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "SampleConversion.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// The loops below avoid branches so that the compiler may vectorize them
+
+template <int BITS>
+struct quantizer {
+	static constexpr std::int32_t MAX = (1 << (BITS - 1)) - 1;
+	static constexpr std::int32_t MIN = -(1 << (BITS - 1));
+
+	std::int32_t operator()(float x) {
+		float y = std::min(std::max(x * Gain, static_cast<float>(MIN)), static_cast<float>(MAX));
+		auto i = static_cast<std::int32_t>(y);
+		i -= y < static_cast<float>(i);
+		Clipped += (i == MAX) | (i == MIN);
+		return i;
+	}
+
+	float Gain;
+	std::size_t Clipped = 0u;
+};
+
+std::size_t ConvertU8(array_view<float> Samples, std::uint8_t *pOut, float Gain) {
+	quantizer<8> q {Gain * 128.f};
+	for (float x : Samples)
+		*pOut++ = static_cast<std::uint8_t>(q(x) + 0x80);
+	return q.Clipped;
+}
+
+std::size_t ConvertS16(array_view<float> Samples, std::int16_t *pOut, float Gain) {
+	quantizer<16> q {Gain * 32768.f};
+	for (float x : Samples)
+		*pOut++ = static_cast<std::int16_t>(q(x));
+	return q.Clipped;
+}
+
+std::size_t ConvertS24(array_view<float> Samples, std::uint8_t *pOut, float Gain) {
+	quantizer<24> q {Gain * 8388608.f};
+	for (float x : Samples) {
+		std::int32_t i = q(x);
+		*pOut++ = static_cast<std::uint8_t>(i);
+		*pOut++ = static_cast<std::uint8_t>(i >> 8);
+		*pOut++ = static_cast<std::uint8_t>(i >> 16);
+	}
+	return q.Clipped;
+}
+
+std::size_t ConvertF32(array_view<float> Samples, float *pOut, float Gain) {
+	std::size_t Clipped = 0u;
+	for (float x : Samples) {
+		float y = x * Gain;
+		Clipped += (y >= 1.f) | (y < -1.f);
+		*pOut++ = y;
+	}
+	return Clipped;
+}
+
+} // namespace
+
+bool IsValidSampleSize(int SampleSize) {
+	return SampleSize == 8 || SampleSize == 16 || SampleSize == 24 || SampleSize == 32;
+}
+
+bool IsFloatSampleSize(int SampleSize) {
+	return SampleSize == 32;
+}
+
+std::size_t ConvertSamples(array_view<float> Samples, void *pOut, int SampleSize, float Gain) {
+	switch (SampleSize) {
+	case 8:  return ConvertU8(Samples, static_cast<std::uint8_t *>(pOut), Gain);
+	case 16: return ConvertS16(Samples, static_cast<std::int16_t *>(pOut), Gain);
+	case 24: return ConvertS24(Samples, static_cast<std::uint8_t *>(pOut), Gain);
+	case 32: return ConvertF32(Samples, static_cast<float *>(pOut), Gain);
+	}
+	return 0u;
+}
@@ -0,0 +1,41 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2014  Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include "array_view.h"
+
+// // // Conversion of the mixer output to the sample formats of audio devices and
+// wave files. Mixer samples are floating-point values where 1.0 is the full scale
+// of every output format; louder samples are only clipped by this conversion, so
+// floating-point output keeps all headroom.
+
+// Sample sizes are in bits; 32-bit samples are IEEE floating-point, the others
+// are PCM, 8-bit samples being unsigned
+bool IsValidSampleSize(int SampleSize);
+bool IsFloatSampleSize(int SampleSize);
+
+// Converts a block of samples multiplied by Gain in a single pass; integer formats
+// are rounded down. Returns the number of samples at the limits of the format
+std::size_t ConvertSamples(array_view<float> Samples, void *pOut, int SampleSize, float Gain = 1.f);
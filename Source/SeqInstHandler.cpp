@@ -21,10 +21,8 @@
 */
 
 #include "SeqInstHandler.h"
-#include "FamiTrackerEnv.h"
 #include "APU/Types.h"
 #include "FamiTrackerTypes.h"
-#include "SoundGen.h"
 
 #include "SeqInstrument.h"
 #include "ChannelHandlerInterface.h"
@@ -99,6 +97,7 @@ void CSeqInstHandler::UpdateInstrument()
 		case SEQ_STATE_RUNNING:
 			ProcessSequence(*pSeq, info.m_iSeqPointer);
 			info.Step(m_pInterface->IsReleasing());
+			m_pInterface->SetSequencePlayPos(pSeq, info.m_iSeqPointer);		// // //
 			break;
 
 		case SEQ_STATE_END:
@@ -109,7 +108,7 @@ void CSeqInstHandler::UpdateInstrument()
 				break;
 			}
 			info.m_iSeqState = SEQ_STATE_HALT;
-			Env.GetSoundGenerator()->SetSequencePlayPos(pSeq, -1);
+			m_pInterface->SetSequencePlayPos(pSeq, -1);		// // //
 			break;
 
 		case SEQ_STATE_HALT:
@@ -238,5 +237,4 @@ void CSeqInstHandler::seq_info_t::Step(bool isReleasing) {
 			--m_iSeqPointer;
 		}
 	}
-	Env.GetSoundGenerator()->SetSequencePlayPos(m_pSequence, m_iSeqPointer);
 }
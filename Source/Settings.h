@@ -102,10 +102,18 @@ public:
 		int		iSampleRate;
 		int		iSampleSize;
 		int		iBufferLength;
+		int		iRunAheadFrames;		// // // frames the emulation may run ahead of the audio device
+		int		iSubFrameCycles;		// // // CPU cycles between partial frame flushes, 0 flushes once per frame
+		int		iAudioSink;				// // // audio_sink_t
+		std::wstring strSinkFile;		// // // output file of AUDIO_SINK_FILE
 		int		iBassFilter;
 		int		iTrebleFilter;
 		int		iTrebleDamping;
 		int		iMixVolume;
+		bool	bStereo;		// // // WAV rendering only
+		int		iRenderSampleSize;		// // // WAV rendering only, 8, 16, 24 or 32 (floating-point); 0 uses iSampleSize
+		int		iRenderHeadroom;		// // // WAV rendering only, attenuation in dB
+		std::wstring strChannelPan;		// // // "PU1=-50,PU2=50", short channel names
 	} Sound;
 
 	struct {
@@ -25,6 +25,7 @@
 #include "FamiTrackerEnv.h"
 #include "ColorScheme.h"
 #include "ModuleException.h"
+#include "AudioSink.h"		// // //
 
 // Settings types
 
@@ -314,10 +315,18 @@ void CSettingsService::SetupSettings() {
 	SETTING_INT(L"Sound", L"Sample rate", 44100, &s.Sound.iSampleRate);
 	SETTING_INT(L"Sound", L"Sample size", 16, &s.Sound.iSampleSize);
 	SETTING_INT(L"Sound", L"Buffer length", 40, &s.Sound.iBufferLength);
+	SETTING_INT(L"Sound", L"Run-ahead frames", 2, &s.Sound.iRunAheadFrames);		// // //
+	SETTING_INT(L"Sound", L"Sub-frame flush cycles", 0, &s.Sound.iSubFrameCycles);		// // //
+	SETTING_INT(L"Sound", L"Audio sink", AUDIO_SINK_DIRECTSOUND, &s.Sound.iAudioSink);		// // //
+	SETTING_STRING(L"Sound", L"Audio sink file", L"audio.wav", &s.Sound.strSinkFile);		// // //
 	SETTING_INT(L"Sound", L"Bass filter freq", 30, &s.Sound.iBassFilter);
 	SETTING_INT(L"Sound", L"Treble filter freq", 12000, &s.Sound.iTrebleFilter);
 	SETTING_INT(L"Sound", L"Treble filter damping", 24, &s.Sound.iTrebleDamping);
 	SETTING_INT(L"Sound", L"Volume", 100, &s.Sound.iMixVolume);
+	SETTING_BOOL(L"Sound", L"Stereo", false, &s.Sound.bStereo);		// // //
+	SETTING_INT(L"Sound", L"WAV sample size", 0, &s.Sound.iRenderSampleSize);		// // //
+	SETTING_INT(L"Sound", L"WAV headroom", 0, &s.Sound.iRenderHeadroom);		// // //
+	SETTING_STRING(L"Sound", L"Channel panning", L"", &s.Sound.strChannelPan);		// // //
 
 	// Midi
 	SETTING_INT(L"MIDI", L"Device", 0, &s.Midi.iMidiDevice);
@@ -63,9 +63,21 @@ bool CSongData::IsPatternInUse(chan_id_t Channel, unsigned int Pattern) const
 	return false;
 }
 
+std::array<std::bitset<MAX_PATTERN>, CHANID_COUNT> CSongData::GetUsedPatterns() const {		// // //
+	std::array<std::bitset<MAX_PATTERN>, CHANID_COUNT> used;
+	VisitTracks([&] (const CTrackData &track, chan_id_t ch) {
+		used[value_cast(ch)] = track.GetUsedPatterns(GetFrameCount());
+	});
+	return used;
+}
+
 unsigned CSongData::GetFreePatternIndex(chan_id_t Channel, unsigned Whence) const {		// // //
+	const auto *pTrack = GetTrack(Channel);
+	if (!pTrack)
+		return -1;
+	const auto Used = pTrack->GetUsedPatterns(GetFrameCount());
 	while (++Whence < MAX_PATTERN)
-		if (!IsPatternInUse(Channel, Whence) && GetPattern(Channel, Whence).IsEmpty())
+		if (!Used[Whence] && GetPattern(Channel, Whence).IsEmpty())
 			return Whence;
 
 	return -1;
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <array>		// // //
+#include <bitset>		// // //
 #include <string>		// // //
 #include "FamiTrackerTypes.h"		// // //
 #include "APU/Types.h"		// // //
@@ -44,6 +45,8 @@ public:
 	const CTrackData *GetTrack(chan_id_t chan) const;
 
 	bool IsPatternInUse(chan_id_t Channel, unsigned int Pattern) const;
+	// // // Patterns addressed in the frame list of every track, indexed by channel ID; one pass over each frame list
+	std::array<std::bitset<MAX_PATTERN>, CHANID_COUNT> GetUsedPatterns() const;
 
 	unsigned GetFreePatternIndex(chan_id_t Channel, unsigned Whence = (unsigned)-1) const;		// // //
 
@@ -230,6 +230,66 @@ void stChannelState::HandleSxxCommand(unsigned char xy) {
 	}
 }
 
+bool stChannelState::CanMergeEarlier() const {		// // //
+	// echo notes in the buffer depend on every note before them
+	for (int i = 0; i < std::min(BufferPos, (int)std::size(Echo)); ++i)
+		if (Echo[i] >= ECHO_BUFFER_ECHO && Echo[i] < ECHO_BUFFER_ECHO + (int)ECHO_BUFFER_LENGTH)
+			return false;
+	return true;
+}
+
+void stChannelState::MergeEarlier(const stChannelState &Earlier, bool MaskFDS) {		// // //
+	const int Pos = std::min(BufferPos, (int)std::size(Echo));
+	for (int i = Pos; i < (int)std::size(Echo); ++i) {
+		Echo[i] = Earlier.Echo[i - Pos];
+		Transpose[i] = Earlier.Transpose[i - Pos];
+	}
+	BufferPos += Earlier.BufferPos;
+
+	if (Instrument == MAX_INSTRUMENTS)
+		Instrument = Earlier.Instrument;
+	if (Volume == MAX_VOLUME)
+		Volume = Earlier.Volume;
+
+	for (std::size_t i = 0; i < std::size(Effect); ++i)
+		switch (static_cast<effect_t>(i)) {
+		case effect_t::VOLUME: case effect_t::NOTE_CUT: case effect_t::FDS_MOD_SPEED_HI:
+			break;
+		default:
+			if (Effect[i] == -1)
+				Effect[i] = Earlier.Effect[i];
+		}
+
+	int &Vol = Effect[value_cast(effect_t::VOLUME)];
+	int &Cut = Effect[value_cast(effect_t::NOTE_CUT)];
+	if (Effect_LengthCounter == -1) {
+		Effect_LengthCounter = Earlier.Effect_LengthCounter;
+		Vol = Earlier.Effect[value_cast(effect_t::VOLUME)];
+		Cut = Earlier.Effect[value_cast(effect_t::NOTE_CUT)];
+	}
+	else {
+		if (Vol == -1)
+			Vol = Earlier.Effect[value_cast(effect_t::VOLUME)];
+		if (Cut == -1 && Effect_LengthCounter != 0xE0)
+			Cut = Earlier.FirstNoteCut;
+	}
+
+	int &ModSpeed = Effect[value_cast(effect_t::FDS_MOD_SPEED_HI)];
+	if (!MaskFDS) {
+		if (ModSpeed == -1)
+			ModSpeed = Earlier.Effect[value_cast(effect_t::FDS_MOD_SPEED_HI)];
+		if (Effect_AutoFMMult == -1)
+			Effect_AutoFMMult = Earlier.Effect_AutoFMMult;
+	}
+	else if (Effect_AutoFMMult == -1)
+		Effect_AutoFMMult = Earlier.FirstAutoFMMult;
+
+	if (FirstNoteCut == -1)
+		FirstNoteCut = Earlier.FirstNoteCut;
+	if (FirstAutoFMMult == -1)
+		FirstAutoFMMult = Earlier.FirstAutoFMMult;
+}
+
 
 
 CSongState::CSongState() {
@@ -239,17 +299,17 @@ CSongState::CSongState() {
 
 void CSongState::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, unsigned Frame, unsigned Row) {
 	CConstSongView SongView {modfile.GetChannelOrder().Canonicalize(), *modfile.GetSong(Track)};
-	const auto &song = SongView.GetSong();
-
-	int totalRows = 0;
+	Walk(modfile, SongView, Frame, Row, 0);		// // //
+	Finish(modfile, SongView.GetSong());
+}
 
-	bool maskFDS = false;
-	bool doHalt = false;
+void CSongState::Walk(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Frame, unsigned Row, unsigned StopFrame) {		// // //
+	const auto &song = SongView.GetSong();
 
-	while (true) {
+	while (!Halted) {
 		if (Row)
 			--Row;
-		else if (Frame)
+		else if (Frame > StopFrame)
 			Row = SongView.GetFrameLength(--Frame) - 1;
 		else
 			break;
@@ -274,7 +334,7 @@ void CSongState::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, uns
 				case effect_t::JUMP: case effect_t::SKIP: // no true backward iterator
 					break;
 				case effect_t::HALT:
-					doHalt = true;
+					Halted = true;
 					break;
 				case effect_t::SPEED:
 					if (Speed == -1 && (xy < modfile.GetSpeedSplitPoint() || song.GetSongTempo() == 0)) {
@@ -283,10 +343,12 @@ void CSongState::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, uns
 					}
 					else if (Tempo == -1 && xy >= modfile.GetSpeedSplitPoint())
 						Tempo = xy;
+					if (FirstTempo == -1 && xy >= modfile.GetSpeedSplitPoint())		// // //
+						FirstTempo = xy;
 					break;
 				case effect_t::GROOVE:
 					if (GroovePos == -1 && xy < MAX_GROOVE && modfile.HasGroove(xy)) {
-						GroovePos = totalRows + 1;
+						GroovePos = TotalRows + 1;
 						Speed = xy;
 					}
 					break;
@@ -295,22 +357,26 @@ void CSongState::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, uns
 					break;
 				case effect_t::NOTE_CUT:
 					chState.HandleSxxCommand(xy);
+					if (chState.FirstNoteCut == -1 && c == chan_id_t::TRIANGLE && xy >= 0x80)		// // //
+						chState.FirstNoteCut = xy;
 					break;
 				case effect_t::FDS_MOD_DEPTH:
 					if (chState.Effect_AutoFMMult == -1 && xy >= 0x80)
 						chState.Effect_AutoFMMult = xy;
+					if (chState.FirstAutoFMMult == -1 && xy >= 0x80)		// // //
+						chState.FirstAutoFMMult = xy;
 					break;
 				case effect_t::FDS_MOD_SPEED_HI:
 					if (xy <= 0x0F)
-						maskFDS = true;
-					else if (!maskFDS && chState.Effect[value_cast(fx)] == -1) {
+						MaskFDS = true;
+					else if (!MaskFDS && chState.Effect[value_cast(fx)] == -1) {
 						chState.Effect[value_cast(fx)] = xy;
 						if (chState.Effect_AutoFMMult == -1)
 							chState.Effect_AutoFMMult = -2;
 					}
 					break;
 				case effect_t::FDS_MOD_SPEED_LO:
-					maskFDS = true;
+					MaskFDS = true;
 					break;
 				case effect_t::DUTY_CYCLE:
 					if (GetChipFromChannel(c) == sound_chip_t::VRC7)		// // // 050B
@@ -331,14 +397,43 @@ void CSongState::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, uns
 				}
 			}
 		});
-		if (doHalt)
+		if (Halted)
 			break;
-		++totalRows;
+		++TotalRows;
+	}
+}
+
+bool CSongState::MergeEarlier(const CSongState &Earlier) {		// // //
+	if (Halted)
+		return true;
+	for (const auto &x : State)
+		if (!x.CanMergeEarlier())
+			return false;
+
+	// with song tempo 0, Fxx sets the tempo only after the speed is known
+	if (Tempo == -1)
+		Tempo = Speed == -1 ? Earlier.Tempo : Earlier.FirstTempo;
+	if (Speed == -1) {
+		Speed = Earlier.Speed;
+		GroovePos = Earlier.GroovePos >= 0 ? Earlier.GroovePos + TotalRows : Earlier.GroovePos;
 	}
+	if (FirstTempo == -1)
+		FirstTempo = Earlier.FirstTempo;
+
+	for (std::size_t i = 0; i < std::size(State); ++i)
+		State[i].MergeEarlier(Earlier.State[i], MaskFDS);
+
+	MaskFDS = MaskFDS || Earlier.MaskFDS;
+	TotalRows += Earlier.TotalRows;
+	Halted = Earlier.Halted;
+	return true;
+}
+
+void CSongState::Finish(const CFamiTrackerModule &modfile, const CSongData &song) {		// // //
 	if (GroovePos == -1 && song.GetSongGroove()) {
 		unsigned Index = song.GetSongSpeed();
 		if (Index < MAX_GROOVE && modfile.HasGroove(Index)) {
-			GroovePos = totalRows;
+			GroovePos = TotalRows;
 			Speed = Index;
 		}
 	}
@@ -362,3 +457,82 @@ std::string CSongState::GetChannelStateString(const CFamiTrackerModule &modfile,
 
 	return str;
 }
+
+
+
+// // // CSongStateIndex
+
+CSongState CSongStateIndex::Retrieve(const CFamiTrackerModule &modfile, unsigned Track, unsigned Frame, unsigned Row) {
+	std::lock_guard<std::mutex> lock {m_Lock};
+
+	CConstSongView SongView {modfile.GetChannelOrder().Canonicalize(), *modfile.GetSong(Track)};
+	Validate(modfile, SongView, Track, Frame);
+
+	while (m_Checkpoints.size() <= Frame) {
+		const unsigned f = m_FrameKeys.size();
+		MakeFrameKey(SongView, f, m_FrameKeys.emplace_back());
+		m_Checkpoints.push_back(StepFrame(modfile, SongView, f + 1, 0, f));
+	}
+
+	CSongState state = StepFrame(modfile, SongView, Frame, Row, Frame);
+	state.Finish(modfile, SongView.GetSong());
+	return state;
+}
+
+void CSongStateIndex::Clear() {
+	std::lock_guard<std::mutex> lock {m_Lock};
+	m_SongKey.clear();
+	m_FrameKeys.clear();
+	m_Checkpoints.clear();
+}
+
+void CSongStateIndex::Validate(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Track, unsigned Frame) {
+	const auto &song = SongView.GetSong();
+	std::vector<std::uint64_t> SongKey {
+		reinterpret_cast<std::uintptr_t>(&modfile), Track, (unsigned)modfile.GetSpeedSplitPoint(),
+		song.GetPatternLength(), song.GetSongSpeed(), song.GetSongTempo(), song.GetSongGroove(),
+	};
+	std::uint64_t Grooves = 0;
+	for (unsigned i = 0; i < MAX_GROOVE; ++i)
+		if (modfile.HasGroove(i))
+			Grooves |= 1ull << i;
+	SongKey.push_back(Grooves);
+	SongView.ForeachTrack([&] (const CTrackData &track, chan_id_t c) {
+		SongKey.push_back(value_cast(c));
+		SongKey.push_back(track.GetEffectColumnCount());
+	});
+
+	if (SongKey != m_SongKey) {
+		m_SongKey = std::move(SongKey);
+		m_FrameKeys.clear();
+		m_Checkpoints.clear();
+	}
+	if (m_Checkpoints.empty())
+		m_Checkpoints.emplace_back();
+
+	// the checkpoint at a frame depends on every frame before it
+	std::vector<pattern_key_t> FrameKey;
+	for (unsigned f = 0, n = std::min<std::size_t>(m_FrameKeys.size(), Frame); f < n; ++f) {
+		MakeFrameKey(SongView, f, FrameKey);
+		if (FrameKey != m_FrameKeys[f]) {
+			m_FrameKeys.resize(f);
+			m_Checkpoints.resize(f + 1);
+			break;
+		}
+	}
+}
+
+void CSongStateIndex::MakeFrameKey(const CConstSongView &SongView, unsigned Frame, std::vector<pattern_key_t> &key) const {
+	key.clear();
+	SongView.ForeachTrack([&] (const CTrackData &track) {
+		key.emplace_back(track.GetFramePattern(Frame), track.GetPatternOnFrame(Frame).GetVersion());
+	});
+}
+
+CSongState CSongStateIndex::StepFrame(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Frame, unsigned Row, unsigned StopFrame) const {
+	CSongState state;
+	state.Walk(modfile, SongView, Frame, Row, StopFrame);
+	if (!state.MergeEarlier(m_Checkpoints[StopFrame]))
+		state.Walk(modfile, SongView, StopFrame, 0, 0);
+	return state;
+}
@@ -28,8 +28,13 @@
 #include <memory>
 #include <string>
 #include <array>
+#include <vector>		// // //
+#include <mutex>		// // //
+#include <cstdint>		// // //
 
 class CFamiTrackerModule;
+class CConstSongView;		// // //
+class CSongData;		// // //
 class stChanNote;
 
 std::string MakeCommandString(effect_t Effect, unsigned char Param);		// // //
@@ -70,8 +75,13 @@ private:
 	void HandleExxCommand2A03(unsigned char param);
 	void HandleSxxCommand(unsigned char param);
 
+	bool CanMergeEarlier() const;		// // //
+	void MergeEarlier(const stChannelState &Earlier, bool MaskFDS);		// // //
+
 	int BufferPos = 0;
 	std::array<int, ECHO_BUFFER_LENGTH> Transpose = { };
+	int FirstNoteCut = -1;		// // // first triangle Sxx (xy >= 80) regardless of Exx state
+	int FirstAutoFMMult = -1;		// // // first Hxx (xy >= 80) regardless of Ixx state
 };
 
 class CSongState {
@@ -85,4 +95,42 @@ public:
 	int Tempo = -1;
 	int Speed = -1;
 	int GroovePos = -1; // -1: disable groove
+
+private:
+	friend class CSongStateIndex;		// // //
+
+	// // // Visits rows backward from the one before (Frame, Row) until the beginning of StopFrame or a halt
+	void Walk(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Frame, unsigned Row, unsigned StopFrame);
+	// // // Combines with the state of all rows before the ones visited so far; false if it cannot be done exactly
+	bool MergeEarlier(const CSongState &Earlier);
+	void Finish(const CFamiTrackerModule &modfile, const CSongData &song);
+
+	int TotalRows = 0;
+	int FirstTempo = -1;
+	bool MaskFDS = false;
+	bool Halted = false;
+};
+
+// // // Song state lookup with one cached checkpoint at the beginning of each frame
+class CSongStateIndex {
+public:
+	/*!	\brief Obtains the same song state as CSongState::Retrieve, visiting only the rows of the
+	current frame once the checkpoints before it are built.
+	\details Checkpoints are validated against the frame list and the pattern versions of the song,
+	so an edit only discards the checkpoints after the earliest frame it touches.
+	*/
+	CSongState Retrieve(const CFamiTrackerModule &modfile, unsigned Track, unsigned Frame, unsigned Row);
+	void Clear();
+
+private:
+	using pattern_key_t = std::pair<unsigned, std::uint64_t>; // pattern index, pattern version
+
+	void Validate(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Track, unsigned Frame);
+	void MakeFrameKey(const CConstSongView &SongView, unsigned Frame, std::vector<pattern_key_t> &key) const;
+	CSongState StepFrame(const CFamiTrackerModule &modfile, const CConstSongView &SongView, unsigned Frame, unsigned Row, unsigned StopFrame) const;
+
+	std::mutex m_Lock;
+	std::vector<std::uint64_t> m_SongKey;
+	std::vector<std::vector<pattern_key_t>> m_FrameKeys;	// contents of each frame a checkpoint depends on
+	std::vector<CSongState> m_Checkpoints;					// states at the beginning of each frame
 };
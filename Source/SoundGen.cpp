@@ -51,6 +51,8 @@ CSoundGen depends on CFamiTrackerView for:
 #include "APU/2A03.h"		// // //
 #include "APU/Mixer.h"		// // // CHIP_LEVEL_*
 #include "SoundChipSet.h"		// // //
+#include "SoundChipService.h"		// // //
+#include "APU/SoundChip.h"		// // //
 #include "ft0cc/doc/dpcm_sample.hpp"		// // //
 #include "InstrumentRecorder.h"		// // //
 #include "Settings.h"
@@ -60,7 +62,9 @@ CSoundGen depends on CFamiTrackerView for:
 #include "TempoCounter.h"		// // //
 #include "TempoDisplay.h"		// // // 050B
 #include "AudioDriver.h"		// // //
+#include "HeadlessAudioSink.h"		// // //
 #include "WaveRenderer.h"		// // //
+#include "OfflineRenderer.h"		// // //
 #include "SoundDriver.h"		// // //
 #include "PatternNote.h"		// // //
 #include "ChannelMap.h"		// // //
@@ -88,8 +92,6 @@ BEGIN_MESSAGE_MAP(CSoundGen, CWinThread)
 	ON_THREAD_MESSAGE(WM_USER_PLAY, OnStartPlayer)
 	ON_THREAD_MESSAGE(WM_USER_STOP, OnStopPlayer)
 	ON_THREAD_MESSAGE(WM_USER_RESET, OnResetPlayer)
-	ON_THREAD_MESSAGE(WM_USER_START_RENDER, OnStartRender)
-	ON_THREAD_MESSAGE(WM_USER_STOP_RENDER, OnStopRender)
 	ON_THREAD_MESSAGE(WM_USER_PREVIEW_SAMPLE, OnPreviewSample)
 	ON_THREAD_MESSAGE(WM_USER_WRITE_APU, OnWriteAPU)
 	ON_THREAD_MESSAGE(WM_USER_CLOSE_SOUND, OnCloseSound)
@@ -104,7 +106,10 @@ END_MESSAGE_MAP()
 CSoundGen::CSoundGen() :
 	m_pTempoCounter(std::make_shared<CTempoCounter>()),		// // //
 	m_pSoundDriver(std::make_unique<CSoundDriver>(this)),		// // //
-	m_pAPU(std::make_unique<CAPU>()),		// // //
+	m_pAPU(std::make_unique<CAPU>([] (sound_chip_t c, CMixer &mixer) {		// // //
+		return Env.GetSoundChipService()->MakeSoundChipDriver(c, mixer);
+	})),
+	m_pSongStateIndex(std::make_unique<CSongStateIndex>()),		// // //
 	m_bHaltRequest(false),
 	m_pInstRecorder(std::make_unique<CInstrumentRecorder>(this)),		// // //
 	m_bWaveChanged(0),
@@ -124,6 +129,7 @@ CSoundGen::CSoundGen() :
 
 CSoundGen::~CSoundGen()
 {
+	CancelRendering();		// // //
 }
 
 //
@@ -416,30 +422,44 @@ bool CSoundGen::ResetAudioDevice()
 	unsigned int SampleRate = pSettings->Sound.iSampleRate;
 	unsigned int BufferLen	= pSettings->Sound.iBufferLength;
 	unsigned int Device		= pSettings->Sound.iDevice;
+	unsigned int RunAhead	= std::max(pSettings->Sound.iRunAheadFrames, 0);		// // //
 
 	if (m_pAudioDriver)
 		m_pAudioDriver->CloseAudioDevice();		// // //
 
-	if (Device >= m_pDSound->GetDeviceCount()) {
-		// Invalid device detected, reset to 0
-		Device = 0;
-		pSettings->Sound.iDevice = 0;
-	}
-
-	// Reinitialize direct sound
-	if (!m_pDSound->SetupDevice(Device)) {
-		AfxMessageBox(IDS_DSOUND_ERROR, MB_ICONERROR);
-		return false;
-	}
-
 	int iBlocks = 2;	// default = 2
 
 	// Create more blocks if a bigger buffer than 100ms is used to reduce lag
 	if (BufferLen > 100)
 		iBlocks += (BufferLen / 66);
 
-	m_pAudioDriver = std::make_unique<CAudioDriver>(*this,
-		std::move(m_pDSound->OpenChannel(SampleRate, SampleSize, 1, BufferLen, iBlocks)), SampleSize);
+	std::unique_ptr<CAudioSink> pSink;		// // //
+	switch (pSettings->Sound.iAudioSink) {
+	case AUDIO_SINK_NULL: case AUDIO_SINK_FILE: {
+		int BlockSize = m_pDSound->CalculateBufferLength(BufferLen, SampleRate, SampleSize, 1) / iBlocks;
+		if (pSettings->Sound.iAudioSink == AUDIO_SINK_NULL)
+			pSink = std::make_unique<CNullAudioSink>(SampleRate, SampleSize, 1, BlockSize, true);
+		else if (auto pFile = std::make_unique<CFileAudioSink>(pSettings->Sound.strSinkFile, SampleRate, SampleSize, 1, BlockSize, true); pFile->IsOpen())
+			pSink = std::move(pFile);
+	}	break;
+	default:
+		if (Device >= m_pDSound->GetDeviceCount()) {
+			// Invalid device detected, reset to 0
+			Device = 0;
+			pSettings->Sound.iDevice = 0;
+		}
+
+		// Reinitialize direct sound
+		if (!m_pDSound->SetupDevice(Device)) {
+			AfxMessageBox(IDS_DSOUND_ERROR, MB_ICONERROR);
+			return false;
+		}
+
+		pSink = m_pDSound->OpenChannel(SampleRate, SampleSize, 1, BufferLen, iBlocks);
+	}
+
+	unsigned FrameRate = (m_iMachineType == NTSC) ? FRAME_RATE_NTSC : FRAME_RATE_PAL;		// // //
+	m_pAudioDriver = std::make_unique<CAudioDriver>(*this, std::move(pSink), SampleSize, SampleRate * RunAhead / FrameRate);		// // //
 
 	// Channel failed
 	if (!m_pAudioDriver || !m_pAudioDriver->IsAudioDeviceOpen()) {
@@ -456,6 +476,7 @@ bool CSoundGen::ResetAudioDevice()
 	m_pAPU->SetCallback(*m_pAudioDriver);
 	if (!m_pAPU->SetupSound(SampleRate, 1, (m_iMachineType == NTSC) ? MACHINE_NTSC : MACHINE_PAL))
 		return false;
+	m_pAPU->SetSubFrameCycles(std::max(pSettings->Sound.iSubFrameCycles, 0));		// // //
 
 	m_pAPU->SetChipLevel(CHIP_LEVEL_APU1, float(pSettings->ChipLevels.iLevelAPU1 / 10.0f));
 	m_pAPU->SetChipLevel(CHIP_LEVEL_APU2, float(pSettings->ChipLevels.iLevelAPU2 / 10.0f));
@@ -509,7 +530,7 @@ void CSoundGen::ResetBuffer()
 	m_pAPU->Reset();
 }
 
-void CSoundGen::FlushBuffer(array_view<int16_t> Buffer)		// // //
+void CSoundGen::FlushBuffer(array_view<float> Buffer)		// // //
 {
 	// Callback method from emulation
 
@@ -532,25 +553,14 @@ bool CSoundGen::PlayBuffer()
 {
 	ASSERT(GetCurrentThreadId() == m_nThreadID);
 
-	if (m_pWaveRenderer) {		// // //
-		CSingleLock l(&m_csRenderer); l.Lock();
-		if (is_rendering_impl()) {
-			m_pWaveRenderer->FlushBuffer(m_pAudioDriver->ReleaseSoundBuffer());		// // //
-			return true;
-		}
-	}
-
 	if (!m_pAudioDriver->DoPlayBuffer())
 		return false;
 
 	// // // Draw graph
-//	if (!IsBackgroundTask()) {
-	if (!is_rendering_impl()) {
-		m_csVisualizerWndLock.Lock();
-		if (m_pVisualizerWnd)
-			m_pVisualizerWnd->FlushSamples(m_pAudioDriver->ReleaseGraphBuffer());
-		m_csVisualizerWndLock.Unlock();
-	}
+	m_csVisualizerWndLock.Lock();
+	if (m_pVisualizerWnd)
+		m_pVisualizerWnd->FlushSamples(m_pAudioDriver->ReleaseGraphBuffer());
+	m_csVisualizerWndLock.Unlock();
 
 	return true;
 }
@@ -612,8 +622,7 @@ void CSoundGen::ApplyGlobalState()		// // //
 	CSingleLock l(&m_csAPULock, TRUE);		// // //
 	auto [Frame, Row] = IsPlaying() ? GetPlayerPos() : m_pTrackerView->GetSelectedPos();		// // //
 
-	CSongState state;
-	state.Retrieve(*m_pModule, GetPlayerTrack(), Frame, Row);
+	CSongState state = m_pSongStateIndex->Retrieve(*m_pModule, GetPlayerTrack(), Frame, Row);		// // //
 
 	m_pSoundDriver->LoadSoundState(state);
 
@@ -624,17 +633,11 @@ void CSoundGen::ApplyGlobalState()		// // //
 void CSoundGen::OnTick() {
 	if (m_pTempoDisplay)		// // // 050B
 		m_pTempoDisplay->Tick();
-	CSingleLock l(&m_csRenderer); l.Lock();
-	if (is_rendering_impl())
-		m_pWaveRenderer->Tick();
 }
 
 void CSoundGen::OnStepRow() {
 	if (m_pTempoDisplay)		// // // 050B
 		m_pTempoDisplay->StepRow();
-	CSingleLock l(&m_csRenderer); l.Lock();
-	if (is_rendering_impl())
-		m_pWaveRenderer->StepRow();		// // //
 }
 
 void CSoundGen::OnPlayNote(chan_id_t chan, const stChanNote &note) {
@@ -664,8 +667,7 @@ bool CSoundGen::IsChannelMuted(chan_id_t chan) const {		// // //
 }
 
 bool CSoundGen::ShouldStopPlayer() const {
-	CSingleLock l(&m_csRenderer); l.Lock();		// // //
-	return is_rendering_impl() && m_pWaveRenderer->ShouldStopPlayer();
+	return false;
 }
 
 int CSoundGen::GetArpNote(chan_id_t chan) const {
@@ -680,8 +682,7 @@ std::string CSoundGen::RecallChannelState(chan_id_t Channel) const		// // //
 		return m_pSoundDriver->GetChannelStateString(Channel);
 
 	auto [Frame, Row] = m_pTrackerView->GetSelectedPos();
-	CSongState state;
-	state.Retrieve(*m_pModule, GetPlayerTrack(), Frame, Row);
+	CSongState state = m_pSongStateIndex->Retrieve(*m_pModule, GetPlayerTrack(), Frame, Row);		// // //
 	return state.GetChannelStateString(*m_pModule, Channel);
 }
 
@@ -869,7 +870,7 @@ bool CSoundGen::RenderToFile(LPCWSTR pFile, const std::shared_ptr<CWaveRenderer>
 {
 	// Called from main thread
 	ASSERT(GetCurrentThreadId() == Env.GetMainApp()->m_nThreadID);
-	ASSERT(m_pDocument != NULL);
+	ASSERT(m_pModule != nullptr);
 
 	if (!pRender)
 		return false;
@@ -880,51 +881,36 @@ bool CSoundGen::RenderToFile(LPCWSTR pFile, const std::shared_ptr<CWaveRenderer>
 		WaitForStop();
 	}
 
-	CSingleLock l(&m_csRenderer); l.Lock();
-	m_pWaveRenderer = pRender;		// // //
+	CancelRendering();		// // //
 
 	if (auto pWave = std::make_unique<CWaveFile>(); pWave &&		// // //
-		pWave->OpenFile(pFile, Env.GetSettings()->Sound.iSampleRate, Env.GetSettings()->Sound.iSampleSize, 1)) {
-		m_pWaveRenderer->SetOutputFile(std::move(pWave));
-		PostThreadMessageW(WM_USER_START_RENDER, 0, 0);
+		pWave->OpenFile(pFile, Env.GetSettings()->Sound.iSampleRate, COfflineRenderer::GetOutputSampleSize(), COfflineRenderer::GetOutputChannels())) {		// // //
+		pRender->SetOutputFile(std::move(pWave));
+
+		// // // render on a separate thread, independent of the audio device
+		m_pOfflineRenderer = std::make_unique<COfflineRenderer>(*m_pModule, pRender);
+		for (std::size_t i = 0; i < CHANID_COUNT; ++i)
+			m_pOfflineRenderer->SetChannelMute(static_cast<chan_id_t>(i), muted_[i]);
+		m_RenderThread = std::thread {[p = m_pOfflineRenderer.get()] { p->Render(); }};
 		return true;
 	}
 
-	StopPlayer();
 	AfxMessageBox(IDS_FILE_OPEN_ERROR);
 	return false;
 }
 
-// // //
-void CSoundGen::StartRendering() {
-	ResetBuffer();
-	CSingleLock l(&m_csRenderer); l.Lock();
-	m_pWaveRenderer->Start();
-}
-
-void CSoundGen::StopRendering()
+void CSoundGen::CancelRendering()		// // //
 {
-	// Called from player thread
-	ASSERT(GetCurrentThreadId() == m_nThreadID);
-
-//	CSingleLock l(&m_csRenderer); l.Lock();
-	if (!is_rendering_impl())
-		return;
-
-	m_pWaveRenderer.reset();		// // //
-	ResetBuffer();
-	HaltPlayer();		// // //
-	ResetAPU();		// // //
+	if (m_pOfflineRenderer)
+		m_pOfflineRenderer->Cancel();
+	if (m_RenderThread.joinable())
+		m_RenderThread.join();
+	m_pOfflineRenderer.reset();
 }
 
 bool CSoundGen::IsRendering() const
 {
-	CSingleLock l(&m_csRenderer); l.Lock();		// // //
-	return is_rendering_impl();
-}
-
-bool CSoundGen::is_rendering_impl() const {		// // //
-	return m_pWaveRenderer && m_pWaveRenderer->Started() && !m_pWaveRenderer->Finished();		// // //
+	return m_pOfflineRenderer && !m_pOfflineRenderer->IsDone();		// // //
 }
 
 bool CSoundGen::IsBackgroundTask() const
@@ -1044,11 +1030,17 @@ BOOL CSoundGen::IdleLoop() {
 
 	++m_iFrameCounter;
 
+	// // // notes queued until now are played from the start of this frame
+	auto NoteTime = m_iNoteTime.exchange(0);
+
 	// Access the document object, skip if access wasn't granted to avoid gaps in audio playback
 	m_pDocument->Locked([this] {
 		m_pSoundDriver->Tick();		// // //
 	}, 0);
 
+	if (NoteTime)		// // //
+		m_pAudioDriver->MarkLatency(std::chrono::steady_clock::time_point {std::chrono::steady_clock::duration {NoteTime}});
+
 	m_pSoundDriver->ForeachTrack([&] (CChannelHandler &, CTrackerChannel &TrackerChan, chan_id_t ID) {		// // //
 		TrackerChan.SetVolumeMeter(m_pAPU->GetVol(ID));		// // //
 	});
@@ -1056,15 +1048,6 @@ BOOL CSoundGen::IdleLoop() {
 	if (Env.GetSettings()->Midi.bMidiArpeggio && m_pArpeggiator)		// // //
 		m_pArpeggiator->Tick(m_pTrackerView->GetSelectedChannelID());
 
-	// Rendering
-	if (CSingleLock l(&m_csRenderer); l.Lock() && m_pWaveRenderer)		// // //
-		if (m_pWaveRenderer->ShouldStopRender())
-			StopRendering();
-		else if (m_pWaveRenderer->ShouldStartPlayer()) {
-			int track = m_pWaveRenderer->GetRenderTrack();
-			StartPlayer(std::make_unique<CPlayerCursor>(*m_pModule->GetSong(track), track));
-		}
-
 	// Update APU registers
 	UpdateAPU();
 
@@ -1160,17 +1143,6 @@ void CSoundGen::OnResetPlayer(WPARAM wParam, LPARAM lParam)
 		BeginPlayer(std::move(pCur));		// // //
 }
 
-void CSoundGen::OnStartRender(WPARAM wParam, LPARAM lParam)
-{
-	StartRendering();		// // //
-}
-
-void CSoundGen::OnStopRender(WPARAM wParam, LPARAM lParam)
-{
-	CSingleLock l(&m_csRenderer); l.Lock();
-	StopRendering();
-}
-
 void CSoundGen::OnPreviewSample(WPARAM wParam, LPARAM lParam)
 {
 	PlayPreviewSample(wParam, lParam);
@@ -1247,6 +1219,8 @@ void CSoundGen::QueueNote(chan_id_t Channel, const stChanNote &NoteData, note_pr
 {
 	// Queue a note for play
 	m_pSoundDriver->QueueNote(Channel, NoteData, Priority);
+	long long None = 0;		// // // only the first note before the next frame is measured
+	m_iNoteTime.compare_exchange_strong(None, std::chrono::steady_clock::now().time_since_epoch().count());
 	Env.GetMIDI()->WriteNote((uint8_t)m_pModule->GetChannelOrder().GetChannelIndex(Channel), NoteData.Note, NoteData.Octave, NoteData.Vol);
 }
 
@@ -33,6 +33,8 @@
 #include <vector>		// // //
 #include <array>		// // //
 #include <memory>		// // //
+#include <thread>		// // //
+#include <atomic>		// // //
 #include "FamiTrackerTypes.h"		// // //
 #include "SoundGenBase.h"		// // //
 #include "APU/Types.h" // CHANID_COUNT
@@ -44,8 +46,6 @@ enum {
 	WM_USER_PLAY,
 	WM_USER_STOP,
 	WM_USER_RESET,
-	WM_USER_START_RENDER,
-	WM_USER_STOP_RENDER,
 	WM_USER_PREVIEW_SAMPLE,
 	WM_USER_WRITE_APU,
 	WM_USER_CLOSE_SOUND,
@@ -74,6 +74,7 @@ class CRegisterState;		// // //
 class CArpeggiator;		// // //
 class CAudioDriver;		// // //
 class CWaveRenderer;		// // //
+class COfflineRenderer;		// // //
 class CTempoDisplay;		// // //
 class CTempoCounter;		// // //
 class CTrackerChannel;		// // //
@@ -81,6 +82,7 @@ class CPlayerCursor;		// // //
 class CSoundDriver;		// // //
 class CChannelMap;		// // //
 class CSoundChipSet;		// // //
+class CSongStateIndex;		// // //
 
 namespace ft0cc::doc {
 class dpcm_sample;
@@ -117,7 +119,7 @@ public:
 
 	// Sound
 	bool		InitializeSound(HWND hWnd);
-	void		FlushBuffer(array_view<int16_t> Buffer) override;
+	void		FlushBuffer(array_view<float> Buffer) override;
 	CDSound		*GetSoundInterface() const;		// // //
 	CAudioDriver *GetAudioDriver() const;		// // //
 
@@ -148,7 +150,7 @@ public:
 	void		 ResetTempo();
 	void		 SetHighlightRows(int Rows);		// // //
 	float		 GetCurrentBPM() const;		// // //
-	bool		 IsPlaying() const;
+	bool		 IsPlaying() const override;
 
 	CTrackerChannel *GetTrackerChannel(chan_id_t chan);		// // //
 	const CTrackerChannel *GetTrackerChannel(chan_id_t chan) const;		// // //
@@ -165,6 +167,7 @@ public:
 
 	// Rendering
 	bool		 RenderToFile(LPCWSTR pFile, const std::shared_ptr<CWaveRenderer> &pRender);		// // //
+	void		 CancelRendering();		// // //
 	bool		 IsRendering() const;
 	bool		 IsBackgroundTask() const;
 
@@ -209,7 +212,7 @@ public:
 	void			SetRecordSetting(const stRecordSetting &Setting);
 
 	// Sequence play position
-	void SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos);		// // //
+	void SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos) override;		// // //
 	int GetSequencePlayPos(std::shared_ptr<const CSequence> pSequence);		// // //
 
 	void SetMeterDecayRate(decay_rate_t Type) const;		// // // 050B
@@ -229,9 +232,6 @@ private:
 
 	bool		PlayBuffer() override;
 
-	void		StartRendering();		// // //
-	void		StopRendering();		// // //
-
 	// Player
 	void		UpdateAPU();
 	void		ResetBuffer();
@@ -239,8 +239,6 @@ private:
 	void		HaltPlayer();
 	void		MakeSilent();
 
-	bool		is_rendering_impl() const;		// // //
-
 	// Misc
 	void		PlayPreviewSample(int Offset, int Pitch);		// // //
 
@@ -281,7 +279,6 @@ private:
 private:
 	mutable CCriticalSection m_csAPULock;		// // //
 	mutable CCriticalSection m_csVisualizerWndLock;
-	mutable CCriticalSection m_csRenderer;		// // //
 
 	// Handles
 	HANDLE				m_hInterruptEvent;					// Used to interrupt sound buffer syncing
@@ -292,9 +289,11 @@ private:
 	std::unique_ptr<CSoundDriver> m_pSoundDriver;			// // // main sound engine
 
 	std::unique_ptr<CTempoDisplay> m_pTempoDisplay;			// // // 050B
+	std::unique_ptr<CSongStateIndex> m_pSongStateIndex;		// // // checkpoints for channel state retrieval
 	bool				m_bHaltRequest;						// True when a halt is requested
 	bool				m_bPlayingSingleRow = false;		// // //
 	int					m_iFrameCounter;
+	mutable std::atomic<long long> m_iNoteTime = 0;			// // // steady_clock time of the last queued note, 0 if none
 
 	int					m_iUpdateCycles;					// Number of cycles/APU update
 
@@ -305,7 +304,8 @@ private:
 
 	std::unique_ptr<CArpeggiator> m_pArpeggiator;			// // //
 
-	std::shared_ptr<CWaveRenderer> m_pWaveRenderer;			// // //
+	std::unique_ptr<COfflineRenderer> m_pOfflineRenderer;	// // // WAV export, runs on its own thread
+	std::thread			m_RenderThread;						// // //
 	std::unique_ptr<CInstrumentRecorder> m_pInstRecorder;
 
 	std::array<bool, CHANID_COUNT> muted_ = { };				// // //
@@ -334,8 +334,6 @@ public:
 	afx_msg void OnStartPlayer(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnStopPlayer(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnResetPlayer(WPARAM wParam, LPARAM lParam);
-	afx_msg void OnStartRender(WPARAM wParam, LPARAM lParam);
-	afx_msg void OnStopRender(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnPreviewSample(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnHaltPreview(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnWriteAPU(WPARAM wParam, LPARAM lParam);
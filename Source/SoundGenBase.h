@@ -27,8 +27,11 @@
 
 // // // tentative base class for CSoundGen, might become CSoundDriverBase later
 
+#include <memory>		// // //
+
 class stChanNote;
 class CInstrumentManager;
+class CSequence;		// // //
 
 class CSoundGenBase {
 public:
@@ -44,8 +47,12 @@ public:
 
 	virtual bool IsChannelMuted(chan_id_t chan) const = 0; // TODO: remove
 	virtual bool ShouldStopPlayer() const = 0;
+	virtual bool IsPlaying() const = 0;
 
 	virtual int GetArpNote(chan_id_t chan) const { // TODO: remove
 		return -1;
 	}
+
+	virtual void SetSequencePlayPos(std::shared_ptr<const CSequence> pSequence, int Pos) { // TODO: remove
+	}
 };
@@ -937,8 +937,9 @@ CStringA CTextExport::ExportRows(LPCWSTR FileName, const CFamiTrackerModule &mod
 
 	modfile.VisitSongs([&] (const CSongData &song, unsigned t) {
 		unsigned rows = song.GetPatternLength();
+		const auto Used = song.GetUsedPatterns();		// // //
 		song.VisitPatterns([&] (const CPatternData &pat, chan_id_t c, unsigned p) {
-			if (song.IsPatternInUse(c, p))
+			if (Used[value_cast(c)][p])
 				pat.VisitRows(rows, [&] (const stChanNote &stCell, unsigned r) {
 					if (stCell != stChanNote { })
 						WriteString(FormattedA(FMT, id++, t, c, p, r,
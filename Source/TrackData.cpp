@@ -21,21 +21,57 @@
 */
 
 #include "TrackData.h"
+#include <algorithm>		// // //
+
+CTrackData::CTrackData(const CTrackData &other) {		// // //
+	*this = other;
+}
+
+CTrackData::CTrackData(CTrackData &&other) noexcept {		// // //
+	*this = std::move(other);
+}
+
+CTrackData &CTrackData::operator=(const CTrackData &other) {		// // //
+	if (this != &other) {
+		std::lock_guard<std::mutex> lock {other.m_PatternSourceLock};
+		m_pPatternData = other.m_pPatternData;
+		m_pPatternSources = other.m_pPatternSources ?
+			std::make_unique<std::array<std::shared_ptr<const CPatternSource>, MAX_PATTERN>>(*other.m_pPatternSources) : nullptr;
+		m_iPendingPatterns.store(other.m_iPendingPatterns.load(std::memory_order_relaxed), std::memory_order_release);
+		m_iFrameList = other.m_iFrameList;
+		m_iEffectColumns = other.m_iEffectColumns;
+	}
+	return *this;
+}
+
+CTrackData &CTrackData::operator=(CTrackData &&other) noexcept {		// // //
+	if (this != &other) {
+		// tracks are only moved by the thread that owns them, so no lock is taken
+		m_pPatternData = std::move(other.m_pPatternData);
+		m_pPatternSources = std::move(other.m_pPatternSources);
+		m_iPendingPatterns.store(other.m_iPendingPatterns.exchange(0, std::memory_order_relaxed), std::memory_order_release);
+		m_iFrameList = other.m_iFrameList;
+		m_iEffectColumns = other.m_iEffectColumns;
+	}
+	return *this;
+}
 
 CPatternData &CTrackData::GetPattern(unsigned Pattern) {
+	MaterializePattern(Pattern);		// // //
 	return m_pPatternData.at(Pattern);
 }
 
 const CPatternData &CTrackData::GetPattern(unsigned Pattern) const {
+	MaterializePattern(Pattern);		// // //
 	return m_pPatternData.at(Pattern);
 }
 
 CPatternData &CTrackData::GetPatternOnFrame(unsigned Frame) {
-	return m_pPatternData.at(GetFramePattern(Frame));
+	return GetPattern(GetFramePattern(Frame));		// // //
 }
 
 const CPatternData &CTrackData::GetPatternOnFrame(unsigned Frame) const {
-	return m_pPatternData.at(GetFramePattern(Frame));
+	return GetPattern(GetFramePattern(Frame));		// // //
 }
 
 unsigned int CTrackData::GetFramePattern(unsigned Frame) const {
@@ -47,6 +83,14 @@ void CTrackData::SetFramePattern(unsigned Frame, unsigned Pattern) {
 		m_iFrameList[Frame] = Pattern;
 }
 
+std::bitset<MAX_PATTERN> CTrackData::GetUsedPatterns(unsigned FrameCount) const {		// // //
+	std::bitset<MAX_PATTERN> used;
+	for (unsigned i = 0, n = std::min<std::size_t>(FrameCount, m_iFrameList.size()); i < n; ++i)
+		if (m_iFrameList[i] < MAX_PATTERN)
+			used.set(m_iFrameList[i]);
+	return used;
+}
+
 unsigned CTrackData::GetEffectColumnCount() const {
 	return m_iEffectColumns;
 }
@@ -54,3 +98,34 @@ unsigned CTrackData::GetEffectColumnCount() const {
 void CTrackData::SetEffectColumnCount(unsigned Count) {
 	m_iEffectColumns = Count;
 }
+
+void CTrackData::SetPatternSource(unsigned Pattern, std::shared_ptr<const CPatternSource> pSource) {		// // //
+	MaterializePattern(Pattern);
+	if (!pSource || Pattern >= MAX_PATTERN)
+		return;
+
+	std::lock_guard<std::mutex> lock {m_PatternSourceLock};
+	if (!m_pPatternSources)
+		m_pPatternSources = std::make_unique<std::array<std::shared_ptr<const CPatternSource>, MAX_PATTERN>>();
+	(*m_pPatternSources)[Pattern] = std::move(pSource);
+	m_iPendingPatterns.fetch_add(1u, std::memory_order_release);
+}
+
+void CTrackData::MaterializePattern(unsigned Pattern) const {		// // //
+	if (!m_iPendingPatterns.load(std::memory_order_acquire))
+		return;
+
+	std::lock_guard<std::mutex> lock {m_PatternSourceLock};
+	if (m_pPatternSources && Pattern < MAX_PATTERN)
+		if (auto pSource = std::move((*m_pPatternSources)[Pattern])) {
+			// the source is consumed even if decoding throws
+			if (m_iPendingPatterns.fetch_sub(1u, std::memory_order_release) == 1u)
+				m_pPatternSources.reset();
+			pSource->Decode(m_pPatternData[Pattern]);
+		}
+}
+
+void CTrackData::MaterializePatterns() const {		// // //
+	for (unsigned i = 0; i < MAX_PATTERN && m_iPendingPatterns.load(std::memory_order_acquire); ++i)
+		MaterializePattern(i);
+}
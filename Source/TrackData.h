@@ -24,11 +24,22 @@
 #pragma once
 
 #include <array>
+#include <bitset>		// // //
+#include <memory>		// // //
+#include <atomic>		// // //
+#include <mutex>		// // //
 #include "FamiTrackerTypes.h"
 #include "PatternData.h"
 
 class CTrackData {
 public:
+	CTrackData() = default;		// // //
+	CTrackData(const CTrackData &other);
+	CTrackData(CTrackData &&other) noexcept;
+	CTrackData &operator=(const CTrackData &other);
+	CTrackData &operator=(CTrackData &&other) noexcept;
+	~CTrackData() noexcept = default;
+
 	CPatternData &GetPattern(unsigned Pattern);		// // //
 	const CPatternData &GetPattern(unsigned Pattern) const;		// // //
 
@@ -37,13 +48,18 @@ public:
 
 	unsigned int GetFramePattern(unsigned Frame) const;
 	void SetFramePattern(unsigned Frame, unsigned Pattern);
+	std::bitset<MAX_PATTERN> GetUsedPatterns(unsigned FrameCount) const;		// // //
 
 	unsigned GetEffectColumnCount() const;
 	void SetEffectColumnCount(unsigned Count);
 
+	// // // Decodes the pattern from the source on first access, on top of its current contents
+	void SetPatternSource(unsigned Pattern, std::shared_ptr<const CPatternSource> pSource);
+
 	// void (*F)(CPatternData &pattern [, std::size_t p_index])
 	template <typename F>
 	void VisitPatterns(F f) {
+		MaterializePatterns();		// // //
 		if constexpr (std::is_invocable_v<F, CPatternData &, std::size_t>) {
 			std::size_t p_index = 0;
 			for (auto &pattern : m_pPatternData)
@@ -60,6 +76,7 @@ public:
 	// void (*F)(const CPatternData &pattern [, std::size_t p_index])
 	template <typename F>
 	void VisitPatterns(F f) const {
+		MaterializePatterns();		// // //
 		if constexpr (std::is_invocable_v<F, const CPatternData &, std::size_t>) {
 			std::size_t p_index = 0;
 			for (auto &pattern : m_pPatternData)
@@ -74,7 +91,14 @@ public:
 	}
 
 private:
-	std::array<CPatternData, MAX_PATTERN> m_pPatternData = { };
+	void MaterializePattern(unsigned Pattern) const;		// // //
+	void MaterializePatterns() const;		// // //
+
+private:
+	mutable std::array<CPatternData, MAX_PATTERN> m_pPatternData = { };		// // // written on first access
+	mutable std::unique_ptr<std::array<std::shared_ptr<const CPatternSource>, MAX_PATTERN>> m_pPatternSources;		// // //
+	mutable std::atomic<unsigned> m_iPendingPatterns {0u};		// // //
+	mutable std::mutex m_PatternSourceLock;		// // // guards the deferred patterns of this track
 	std::array<unsigned int, MAX_FRAMES> m_iFrameList = { };
 	unsigned char m_iEffectColumns = 1;		// // //
 };
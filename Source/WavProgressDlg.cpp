@@ -58,10 +58,8 @@ void CWavProgressDlg::OnBnClickedCancel()
 {
 	CSoundGen *pSoundGen = Env.GetSoundGenerator();
 
-	if (pSoundGen->IsRendering()) {
-		//pSoundGen->StopRendering();
-		pSoundGen->PostThreadMessageW(WM_USER_STOP_RENDER, 0, 0);
-	}
+	if (pSoundGen->IsRendering())
+		pSoundGen->CancelRendering();		// // //
 
 	EndDialog(0);
 }
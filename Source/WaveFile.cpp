@@ -21,17 +21,23 @@
 */
 
 #include "WaveFile.h"
+#include <mmreg.h>		// // //
+#include "SampleConversion.h"		// // //
 
 bool CWaveFile::OpenFile(LPCWSTR Filename, int SampleRate, int SampleSize, int Channels)
 {
 	int nError;
 
-	WaveFormat.wf.wFormatTag	  = WAVE_FORMAT_PCM;
-	WaveFormat.wf.nChannels		  = Channels;
-	WaveFormat.wf.nSamplesPerSec  = SampleRate;
-	WaveFormat.wf.nBlockAlign	  = (SampleSize / 8) * Channels;
-	WaveFormat.wf.nAvgBytesPerSec = SampleRate * (SampleSize / 8) * Channels;
-	WaveFormat.wBitsPerSample	  = SampleSize;
+	const bool Float = IsFloatSampleSize(SampleSize);		// // //
+	const DWORD FormatSize = Float ? sizeof(WAVEFORMATEX) : sizeof(PCMWAVEFORMAT);
+
+	WaveFormat.wFormatTag	   = Float ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+	WaveFormat.nChannels	   = Channels;
+	WaveFormat.nSamplesPerSec  = SampleRate;
+	WaveFormat.nBlockAlign	   = (SampleSize / 8) * Channels;
+	WaveFormat.nAvgBytesPerSec = SampleRate * (SampleSize / 8) * Channels;
+	WaveFormat.wBitsPerSample  = SampleSize;
+	WaveFormat.cbSize		   = 0;
 
 	WCHAR pBuf[128] = { };		// // //
 	wcscpy_s(pBuf, Filename);
@@ -46,14 +52,14 @@ bool CWaveFile::OpenFile(LPCWSTR Filename, int SampleRate, int SampleSize, int C
 		return false;
 
 	ckOut.ckid	 = mmioFOURCC('f', 'm', 't', ' ');
-	ckOut.cksize = sizeof(PCMWAVEFORMAT);
+	ckOut.cksize = FormatSize;		// // //
 
 	nError = mmioCreateChunk(hmmioOut, &ckOut, 0);
 
 	if (nError != MMSYSERR_NOERROR)
 		return false;
 
-	mmioWrite(hmmioOut, (HPSTR)&WaveFormat, sizeof(PCMWAVEFORMAT));
+	mmioWrite(hmmioOut, (HPSTR)&WaveFormat, FormatSize);		// // //
 	mmioAscend(hmmioOut, &ckOut, 0);
 
 	ckOut.ckid	 = mmioFOURCC('d', 'a', 't', 'a');
@@ -30,7 +30,7 @@
 class CWaveFile
 {
 public:
-	// Open a wave file for streaming
+	// Open a wave file for streaming, 32-bit samples are floating-point
 	bool	OpenFile(LPCWSTR Filename, int SampleRate, int SampleSize, int Channels);		// // //
 	// Close the file
 	void	CloseFile();
@@ -38,7 +38,7 @@ public:
 	void	WriteWave(array_view<char> av);		// // //
 
 private:
-	PCMWAVEFORMAT	WaveFormat;
+	WAVEFORMATEX	WaveFormat;		// // // only the PCMWAVEFORMAT part is written for PCM files
 	MMCKINFO		ckOutRIFF, ckOut;
 	MMIOINFO		mmioinfoOut;
 	HMMIO			hmmioOut;
@@ -37,6 +37,9 @@ void CWaveRenderer::CloseOutputFile() {
 		m_pWaveFile->CloseFile();
 		m_pWaveFile.reset();
 	}
+	for (auto &x : m_pStemFiles)		// // //
+		x.second->CloseFile();
+	m_pStemFiles.clear();
 }
 
 void CWaveRenderer::FlushBuffer(array_view<char> Buf) const {
@@ -44,6 +47,22 @@ void CWaveRenderer::FlushBuffer(array_view<char> Buf) const {
 		m_pWaveFile->WriteWave(Buf);
 }
 
+void CWaveRenderer::SetStemFile(chan_id_t Chan, std::unique_ptr<CWaveFile> pWave) {		// // //
+	if (pWave)
+		m_pStemFiles[Chan] = std::move(pWave);
+	else
+		m_pStemFiles.erase(Chan);
+}
+
+void CWaveRenderer::FlushStem(chan_id_t Chan, array_view<char> Buf) const {		// // //
+	if (auto it = m_pStemFiles.find(Chan); it != m_pStemFiles.end())
+		it->second->WriteWave(Buf);
+}
+
+bool CWaveRenderer::HasStems() const {		// // //
+	return !m_pStemFiles.empty();
+}
+
 void CWaveRenderer::Start() {
 	m_bStarted = true;
 }
@@ -26,7 +26,9 @@
 #include <memory>
 #include <cstdint>
 #include <string>
+#include <map>		// // //
 #include "array_view.h"
+#include "APU/Types_fwd.h"		// // //
 
 class CWaveFile;
 
@@ -38,6 +40,11 @@ public:
 	void CloseOutputFile();
 	void FlushBuffer(array_view<char> Buf) const;
 
+	// // // stems, one output file per channel
+	void SetStemFile(chan_id_t Chan, std::unique_ptr<CWaveFile> pWave);
+	void FlushStem(chan_id_t Chan, array_view<char> Buf) const;
+	bool HasStems() const;
+
 	void Start();
 	virtual void Tick() { }
 	virtual void StepRow() { }
@@ -59,6 +66,7 @@ protected:
 
 private:
 	std::unique_ptr<CWaveFile> m_pWaveFile;
+	std::map<chan_id_t, std::unique_ptr<CWaveFile>> m_pStemFiles;		// // //
 	bool m_bStarted = false;
 	bool m_bFinished = false;
 
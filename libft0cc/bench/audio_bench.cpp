@@ -0,0 +1,180 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+// Runs the playback path of the tracker (register writes, APU updates, audio
+// driver, audio sink) without a sound card and reports its throughput, together
+// with the key-to-sound latency of a simulated key press every few frames.
+//
+// usage: audio_bench [fast|realtime|file <path>] [frames] [run-ahead frames] [sub-frame cycles]
+
+#include "APU/APU.h"
+#include "AudioDriver.h"
+#include "HeadlessAudioSink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int SAMPLE_RATE = 44100;
+constexpr int SAMPLE_SIZE = 16;
+constexpr int BUFFER_LENGTH = 40;		// ms, same as the default sound setting
+constexpr int BLOCKS = 2;
+constexpr int KEY_INTERVAL = 10;		// frames between key presses
+
+class CDriverCallback : public IAudioCallback {
+public:
+	void FlushBuffer(array_view<float>) override {
+	}
+	bool PlayBuffer() override {
+		auto t = clock_type::now();
+		bool ret = driver_->DoPlayBuffer();
+		auto blocked = clock_type::now() - t;
+		totalBlocked_ += blocked;
+		maxBlocked_ = std::max(maxBlocked_, blocked);
+		return ret;
+	}
+
+	CAudioDriver *driver_ = nullptr;
+	clock_type::duration totalBlocked_ { };
+	clock_type::duration maxBlocked_ { };
+};
+
+// a few notes on the 2A03 so that every channel produces output
+void WriteRegisters(CAPU &apu, int frame) {
+	if (frame == 0) {
+		apu.Write(0x4015, 0x0F);
+		apu.Write(0x4000, 0xBF);
+		apu.Write(0x4004, 0x7F);
+		apu.Write(0x4008, 0xFF);
+		apu.Write(0x400C, 0x3F);
+	}
+	const int period = 0x100 + (frame % 16) * 0x20;
+	apu.Write(0x4002, period & 0xFF);
+	apu.Write(0x4003, period >> 8);
+	apu.Write(0x4006, (period * 3 / 2) & 0xFF);
+	apu.Write(0x4007, (period * 3 / 2) >> 8);
+	apu.Write(0x400A, (period / 2) & 0xFF);
+	apu.Write(0x400B, (period / 2) >> 8);
+	apu.Write(0x400E, frame % 16);
+	apu.Write(0x400F, 0x08);
+}
+
+// same update order as CSoundGen::UpdateAPU for the five 2A03 channels
+void UpdateAPU(CAPU &apu) {
+	int cycles = MASTER_CLOCK_NTSC / FRAME_RATE_NTSC;
+	for (int i = 0; i < 5; ++i) {
+		int delay = i ? 150 : 250;
+		cycles -= delay;
+		apu.AddTime(delay);
+		apu.Process();
+	}
+	apu.AddTime(cycles);
+	apu.Process();
+	apu.EndFrame();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	const char *mode = argc > 1 ? argv[1] : "fast";
+	int arg = 2;
+	const char *path = nullptr;
+	if (!std::strcmp(mode, "file")) {
+		if (argc <= arg) {
+			std::fprintf(stderr, "missing output file\n");
+			return 1;
+		}
+		path = argv[arg++];
+	}
+	const int frames = argc > arg ? std::atoi(argv[arg]) : 6000;
+	const int runAhead = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 2;
+	const int subFrame = argc > arg + 2 ? std::atoi(argv[arg + 2]) : 0;
+	const bool realtime = !std::strcmp(mode, "realtime");
+
+	const int blockSize = SAMPLE_RATE * BUFFER_LENGTH / 1000 * (SAMPLE_SIZE / 8) / BLOCKS;
+	std::unique_ptr<CAudioSink> sink;
+	if (path) {
+		auto file = std::make_unique<CFileAudioSink>(path, SAMPLE_RATE, SAMPLE_SIZE, 1, blockSize);
+		if (!file->IsOpen()) {
+			std::fprintf(stderr, "cannot open %s\n", path);
+			return 1;
+		}
+		sink = std::move(file);
+	}
+	else
+		sink = std::make_unique<CNullAudioSink>(SAMPLE_RATE, SAMPLE_SIZE, 1, blockSize, realtime);
+
+	CDriverCallback cb;
+	CAudioDriver driver {cb, std::move(sink), SAMPLE_SIZE, SAMPLE_RATE * runAhead / FRAME_RATE_NTSC};
+	cb.driver_ = &driver;
+
+	CAPU apu;
+	apu.SetCallback(driver);
+	if (!apu.SetupSound(SAMPLE_RATE, 1, MACHINE_NTSC)) {
+		std::fprintf(stderr, "cannot set up the APU\n");
+		return 1;
+	}
+	apu.SetupMixer(30, 12000, 24, 100);
+	apu.SetExternalSound(sound_chip_t::APU);
+	apu.SetSubFrameCycles(subFrame);
+
+	driver.Reset();
+	int keys = 0;
+	double totalLatency = 0.;
+	double maxLatency = 0.;
+	auto start = clock_type::now();
+	for (int i = 0; i < frames; ++i) {
+		if (!(i % KEY_INTERVAL)) {
+			// the previous key has reached the sink by now
+			if (double latency = driver.GetLatency(); i && latency > 0.) {
+				++keys;
+				totalLatency += latency;
+				maxLatency = std::max(maxLatency, latency);
+			}
+			driver.MarkLatency(clock_type::now());
+		}
+		WriteRegisters(apu, i);
+		UpdateAPU(apu);
+	}
+	driver.CloseAudioDevice();
+	double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+	using ms = std::chrono::duration<double, std::milli>;
+	std::printf("mode:           %s\n", mode);
+	std::printf("frames:         %d\n", frames);
+	std::printf("elapsed:        %.3f s\n", elapsed);
+	std::printf("frames/s:       %.1f (%.2fx real time)\n", frames / elapsed, frames / elapsed / FRAME_RATE_NTSC);
+	std::printf("underruns:      %u\n", driver.GetUnderruns());
+	std::printf("queue length:   %d frames\n", runAhead);
+	std::printf("sub-frame:      %d cycles\n", subFrame);
+	std::printf("blocked/frame:  %.3f ms avg, %.3f ms max\n",
+		ms(cb.totalBlocked_).count() / frames, ms(cb.maxBlocked_).count());
+	if (keys)
+		std::printf("latency:        %.3f ms avg, %.3f ms max (%d keys)\n", totalLatency / keys, maxLatency, keys);
+	return 0;
+}
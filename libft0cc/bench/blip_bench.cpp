@@ -0,0 +1,174 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+// Measures the Blip_Buffer kernels of every instruction set supported by the
+// processor against the portable kernels, and checks that their output is the same.
+//
+// usage: blip_bench [frames]
+
+#include "Blip_Buffer/Blip_Kernels.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using buf_t = Blip_Buffer::buf_t_;
+
+constexpr long FRAME_SAMPLES = 44100 / 60;
+constexpr int DELTAS_PER_FRAME = 4096;		// several busy channels
+constexpr int STEM_LANES = 8;		// channel buffers read together for stems or panning
+
+struct stDelta {
+	int pos;
+	int phase;
+	int delta;
+};
+
+struct stResult {
+	double synth = 0.;		// deltas per second
+	double integrate = 0.;		// samples per second, one buffer
+	double integrateStems = 0.;		// samples per second, all buffers
+	double mix = 0.;		// samples per second
+	std::vector<buf_t> synthOut;
+	std::vector<std::vector<float>> integrateOut;
+	std::vector<buf_t> mixOut;
+};
+
+struct stInput {
+	std::vector<short> rows;
+	std::vector<stDelta> deltas;
+	std::vector<std::vector<buf_t>> blip;
+	std::vector<blip_sample_t> samples;
+};
+
+stInput MakeInput() {
+	std::mt19937 rng(0);
+	stInput in;
+
+	std::uniform_int_distribution<int> imp(-2048, 2048);
+	in.rows.resize(blip_res * blip_good_quality);
+	for (auto &x : in.rows)
+		x = static_cast<short>(imp(rng));
+
+	std::uniform_int_distribution<int> delta(-(15 << 6), 15 << 6);
+	for (int i = 0; i < DELTAS_PER_FRAME; ++i)
+		in.deltas.push_back({static_cast<int>(rng() % FRAME_SAMPLES), static_cast<int>(rng() % blip_res), delta(rng)});
+
+	std::uniform_int_distribution<int> sample(-(1 << 20), 1 << 20);
+	in.blip.resize(STEM_LANES);
+	for (auto &lane : in.blip) {
+		lane.resize(FRAME_SAMPLES);
+		for (auto &x : lane)
+			x = sample(rng);
+	}
+
+	std::uniform_int_distribution<int> pcm(-32768, 32767);
+	in.samples.resize(FRAME_SAMPLES);
+	for (auto &x : in.samples)
+		x = static_cast<blip_sample_t>(pcm(rng));
+
+	return in;
+}
+
+template <typename F>
+double Measure(F f) {
+	auto start = clock_type::now();
+	f();
+	return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+double Integrate(const blip_kernels_t &k, const stInput &in, int lanes, int frames, std::vector<std::vector<float>> &out) {
+	out.assign(lanes, std::vector<float>(FRAME_SAMPLES));
+	std::vector<blip_lane_t> state;
+	for (int l = 0; l < lanes; ++l)
+		state.push_back({in.blip[l].data(), out[l].data(), 0});
+	return Measure([&] {
+		for (int i = 0; i < frames; ++i)
+			k.integrate(state.data(), lanes, FRAME_SAMPLES, 9);
+	});
+}
+
+stResult Run(const blip_kernels_t &k, const stInput &in, int frames) {
+	stResult r;
+
+	r.synthOut.assign(FRAME_SAMPLES + blip_widest_impulse_, 0);
+	double t = Measure([&] {
+		for (int i = 0; i < frames; ++i)
+			for (const auto &d : in.deltas)
+				k.synth(r.synthOut.data() + d.pos, in.rows.data() + d.phase * blip_good_quality, blip_good_quality, d.delta);
+	});
+	r.synth = static_cast<double>(frames) * DELTAS_PER_FRAME / t;
+
+	std::vector<std::vector<float>> out;
+	t = Integrate(k, in, 1, frames, out);
+	r.integrate = static_cast<double>(frames) * FRAME_SAMPLES / t;
+	t = Integrate(k, in, STEM_LANES, frames, r.integrateOut);
+	r.integrateStems = static_cast<double>(frames) * FRAME_SAMPLES * STEM_LANES / t;
+
+	r.mixOut.assign(FRAME_SAMPLES + 1, 0);
+	t = Measure([&] {
+		for (int i = 0; i < frames; ++i)
+			k.mix(r.mixOut.data(), in.samples.data(), FRAME_SAMPLES);
+	});
+	r.mix = static_cast<double>(frames) * FRAME_SAMPLES / t;
+
+	return r;
+}
+
+bool SameOutput(const stResult &a, const stResult &b) {
+	return a.synthOut == b.synthOut && a.integrateOut == b.integrateOut && a.mixOut == b.mixOut;
+}
+
+void Print(const char *name, double value, double base) {
+	std::printf("  %-22s %8.1f M/s  (%.2fx)\n", name, value / 1e6, value / base);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+	const stInput in = MakeInput();
+
+	const stResult base = Run(*blip_kernel_set(0), in, frames);
+	bool exact = true;
+	for (int i = 0; const blip_kernels_t *k = blip_kernel_set(i); ++i) {
+		const stResult r = i ? Run(*k, in, frames) : base;
+		const bool same = SameOutput(r, base);
+		exact = exact && same;
+		std::printf("%s%s:%s\n", k->name, k == &blip_kernels() ? " (selected)" : "", same ? "" : " OUTPUT DIFFERS");
+		Print("synth, deltas", r.synth, base.synth);
+		Print("integrate, samples", r.integrate, base.integrate);
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "integrate x%d, samples", STEM_LANES);
+		Print(buf, r.integrateStems, base.integrateStems);
+		Print("mix, samples", r.mix, base.mix);
+	}
+
+	std::printf("frames:         %d (%ld samples, %d deltas each)\n", frames, FRAME_SAMPLES, DELTAS_PER_FRAME);
+	std::printf("bit-exact:      %s\n", exact ? "yes" : "no");
+	return exact ? 0 : 1;
+}
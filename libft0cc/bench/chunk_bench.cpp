@@ -0,0 +1,184 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+// Measures label resolution of the NSF compiler on a synthetic chunk graph of
+// MAX_TRACKS tracks with MAX_FRAMES frames each, the way CCompiler resolves them
+// for a bankswitched export, and checks the resolved pointers and banks.
+//
+// usage: chunk_bench [runs]
+
+#include "Chunk.h"
+#include "FamiTrackerTypes.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr unsigned CHANNELS = 16;		// 2A03 and every expansion chip but N163
+constexpr unsigned PATTERNS = 64;		// distinct patterns of a channel in a track
+constexpr int PATTERN_SWITCH_BANK = 3;		// as in CCompiler
+constexpr int BANK_SIZE = 0x1000;
+
+// The chunks of a compiled module, created as CCompiler::CreateChunk does
+struct stGraph {
+	CChunkLabelTable labels;
+	std::vector<std::shared_ptr<CChunk>> chunks;
+	std::vector<CChunk *> labelChunks;		// indexed by label ID
+	std::vector<CChunk *> frameChunks;
+
+	CChunk &CreateChunk(const stChunkLabel &label) {
+		CChunk &chunk = *chunks.emplace_back(std::make_shared<CChunk>(label, labels));
+		unsigned id = chunk.GetLabelID();
+		if (id >= labelChunks.size())
+			labelChunks.resize(id + 1, nullptr);
+		if (!labelChunks[id])
+			labelChunks[id] = &chunk;
+		return chunk;
+	}
+};
+
+std::unique_ptr<stGraph> MakeGraph() {
+	auto g = std::make_unique<stGraph>();
+	std::mt19937 rng(0);
+
+	for (unsigned t = 0; t < MAX_TRACKS; ++t) {
+		CChunk &frameList = g->CreateChunk({CHUNK_FRAME_LIST, t});
+		for (unsigned i = 0; i < MAX_FRAMES; ++i) {
+			frameList.StorePointer({CHUNK_FRAME, t, i});
+			CChunk &frame = g->CreateChunk({CHUNK_FRAME, t, i});
+			g->frameChunks.push_back(&frame);
+			for (unsigned c = 0; c < CHANNELS; ++c)
+				frame.StorePointer({CHUNK_PATTERN, t, static_cast<unsigned>(rng() % PATTERNS), c});
+			for (unsigned c = 0; c < CHANNELS; ++c)		// CCompiler::AddBankswitching
+				frame.StoreBankReference(frame.GetDataPointerTarget(c), 0);
+		}
+
+		for (unsigned c = 0; c < CHANNELS; ++c)
+			for (unsigned p = 0; p < PATTERNS; ++p) {
+				CChunk &pattern = g->CreateChunk({CHUNK_PATTERN, t, p, c});
+				std::vector<unsigned char> data(8 + rng() % 56);
+				for (auto &x : data)
+					x = static_cast<unsigned char>(rng());
+				pattern.StoreString(data);
+			}
+	}
+
+	return g;
+}
+
+template <typename F>
+double Measure(F f) {
+	auto start = clock_type::now();
+	f();
+	return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// CCompiler::CollectLabelsBankswitched, with every chunk in the switchable area
+void CollectLabels(stGraph &g, std::vector<int> &labelMap) {
+	int offset = 0;
+	int bank = PATTERN_SWITCH_BANK;
+	for (const auto &pChunk : g.chunks) {
+		int size = pChunk->CountDataSize();
+		if (offset + size > BANK_SIZE) {
+			// the graph is larger than any NSF, so bank numbers wrap around
+			offset = 0;
+			bank = bank < 0xFF ? bank + 1 : PATTERN_SWITCH_BANK;
+		}
+		labelMap[pChunk->GetLabelID()] = 0xB000 + offset;
+		pChunk->SetBank(static_cast<unsigned char>(bank));
+		offset += size;
+	}
+}
+
+// CCompiler::AssignLabels
+void AssignLabels(stGraph &g, const std::vector<int> &labelMap) {
+	for (auto &pChunk : g.chunks)
+		pChunk->AssignLabels(labelMap);
+}
+
+// CCompiler::UpdateFrameBanks
+void UpdateFrameBanks(stGraph &g) {
+	for (CChunk *pChunk : g.frameChunks)
+		for (unsigned j = 0; j < CHANNELS; ++j) {
+			unsigned char bank = g.labelChunks[pChunk->GetDataPointerTargetID(j)]->GetBank();
+			if (bank < PATTERN_SWITCH_BANK)
+				bank = PATTERN_SWITCH_BANK;
+			pChunk->SetupBankData(j + CHANNELS, bank);
+		}
+}
+
+// resolves every frame again through full labels
+bool Verify(const stGraph &g, const std::vector<int> &labelMap) {
+	std::map<stChunkLabel, const CChunk *> byLabel;
+	for (const auto &pChunk : g.chunks)
+		byLabel.try_emplace(pChunk->GetLabel(), pChunk.get());
+
+	for (const CChunk *pChunk : g.frameChunks)
+		for (unsigned j = 0; j < CHANNELS; ++j) {
+			const CChunk *target = byLabel.at(pChunk->GetDataPointerTarget(j));
+			if (pChunk->GetData(j) != (labelMap[target->GetLabelID()] & 0xFFFF))
+				return false;
+			if (pChunk->GetData(j + CHANNELS) != target->GetBank())
+				return false;
+		}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	const int runs = argc > 1 ? std::atoi(argv[1]) : 10;
+
+	double tCreate = 0., tCollect = 0., tAssign = 0., tBanks = 0.;
+	bool ok = true;
+	std::size_t chunkCount = 0, labelCount = 0;
+
+	for (int i = 0; i < runs; ++i) {
+		std::unique_ptr<stGraph> g;
+		tCreate += Measure([&] { g = MakeGraph(); });
+		chunkCount = g->chunks.size();
+		labelCount = g->labels.GetCount();
+
+		std::vector<int> labelMap(labelCount, -1);
+		tCollect += Measure([&] { CollectLabels(*g, labelMap); });
+		tAssign += Measure([&] { AssignLabels(*g, labelMap); });
+		tBanks += Measure([&] { UpdateFrameBanks(*g); });
+		ok = ok && Verify(*g, labelMap);
+	}
+
+	std::printf("graph:          %u tracks, %d frames, %u channels, %zu chunks, %zu labels\n",
+		MAX_TRACKS, MAX_FRAMES, CHANNELS, chunkCount, labelCount);
+	std::printf("runs:           %d\n", runs);
+	std::printf("create:         %8.3f ms\n", tCreate * 1e3 / runs);
+	std::printf("collect labels: %8.3f ms\n", tCollect * 1e3 / runs);
+	std::printf("assign labels:  %8.3f ms\n", tAssign * 1e3 / runs);
+	std::printf("frame banks:    %8.3f ms\n", tBanks * 1e3 / runs);
+	std::printf("resolved:       %s\n", ok ? "yes" : "no");
+	return ok ? 0 : 1;
+}
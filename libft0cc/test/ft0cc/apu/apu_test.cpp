@@ -0,0 +1,253 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "APU/APU.h"
+#include "APU/SoundChip.h"
+#include "APU/Mixer.h"
+#include "gtest/gtest.h"
+#include <vector>
+#include <map>
+
+namespace {
+
+class CBufferCallback : public IAudioCallback {
+public:
+	void FlushBuffer(array_view<float> Buffer) override {
+		samples_.insert(samples_.end(), Buffer.begin(), Buffer.end());
+		++flushes_;
+	}
+	bool PlayBuffer() override {
+		return true;
+	}
+
+	std::vector<float> samples_;
+	int flushes_ = 0;
+};
+
+class CStemCallback : public IStemCallback {
+public:
+	void FlushStem(chan_id_t Ch, array_view<float> Buffer) override {
+		auto &v = samples_[Ch];
+		v.insert(v.end(), Buffer.begin(), Buffer.end());
+	}
+
+	std::map<chan_id_t, std::vector<float>> samples_;
+};
+
+void SetupVRC7(CAPU &apu, int rate) {
+	apu.SetupSound(rate, 1, MACHINE_NTSC);
+	apu.SetupMixer(16, 12000, 24, 100);
+	apu.SetExternalSound(CSoundChipSet {sound_chip_t::APU}.WithChip(sound_chip_t::VRC7));
+	apu.Write(0x9010, 0x30);
+	apu.Write(0x9030, 0x10);
+	apu.Write(0x9010, 0x10);
+	apu.Write(0x9030, 0xAC);
+	apu.Write(0x9010, 0x20);
+	apu.Write(0x9030, 0x18);
+}
+
+// plays a square wave on the first 2A03 channel
+void SetupSquare(CAPU &apu, int rate, int channels, CSoundChipSet chips = sound_chip_t::APU) {
+	apu.SetupSound(rate, channels, MACHINE_NTSC);
+	apu.SetupMixer(16, 12000, 24, 100);
+	apu.SetExternalSound(chips);
+	apu.Write(0x4015, 0x01);
+	apu.Write(0x4000, 0xBF);
+	apu.Write(0x4002, 0xFD);
+	apu.Write(0x4003, 0x00);
+}
+
+void RunFrames(CAPU &apu, int frames) {
+	for (int i = 0; i < frames; ++i) {
+		apu.AddTime(MASTER_CLOCK_NTSC / FRAME_RATE_NTSC);
+		apu.Process();
+		apu.EndFrame();
+	}
+}
+
+} // namespace
+
+TEST(Apu, InjectedChips) {
+	std::vector<sound_chip_t> made;
+	CAPU apu {[&] (sound_chip_t chip, CMixer &mixer) {
+		made.push_back(chip);
+		return CAPU::MakeDefaultSoundChip(chip, mixer);
+	}};
+
+	ASSERT_EQ(made.size(), SOUND_CHIP_COUNT);
+	for (std::size_t i = 0; i < SOUND_CHIP_COUNT; ++i) {
+		EXPECT_EQ(made[i], SOUND_CHIPS[i]);
+		ASSERT_NE(apu.GetSoundChip(SOUND_CHIPS[i]), nullptr);
+		EXPECT_EQ(apu.GetSoundChip(SOUND_CHIPS[i])->GetID(), SOUND_CHIPS[i]);
+	}
+}
+
+TEST(Apu, RenderSquare) {
+	CBufferCallback cb;
+	CAPU apu {&cb};
+	SetupSquare(apu, 44100, 1);
+	apu.Write(0x4015, 0x00);
+
+	RunFrames(apu, 1);
+	EXPECT_EQ(cb.samples_.size(), 44100u / FRAME_RATE_NTSC);
+	for (auto x : cb.samples_)
+		EXPECT_EQ(x, 0);
+
+	cb.samples_.clear();
+	apu.Write(0x4015, 0x01);
+	apu.Write(0x4003, 0x00);
+	RunFrames(apu, 10);
+	EXPECT_EQ(cb.samples_.size(), 10 * 44100u / FRAME_RATE_NTSC);
+	EXPECT_GT(apu.GetVol(chan_id_t::SQUARE1), 0);
+
+	bool nonzero = false;
+	for (auto x : cb.samples_)
+		nonzero = nonzero || x != 0;
+	EXPECT_TRUE(nonzero);
+}
+
+TEST(Apu, IndependentVRC7) {
+	CBufferCallback cb1;
+	CAPU apu1 {&cb1};
+	SetupVRC7(apu1, 44100);
+	RunFrames(apu1, 10);
+
+	// a second emulator running at another sample rate must not affect the first one
+	CBufferCallback cb2;
+	CBufferCallback cb3;
+	CAPU apu2 {&cb2};
+	CAPU apu3 {&cb3};
+	SetupVRC7(apu2, 44100);
+	SetupVRC7(apu3, 48000);
+	for (int i = 0; i < 10; ++i) {
+		RunFrames(apu3, 1);
+		RunFrames(apu2, 1);
+	}
+
+	EXPECT_GT(apu1.GetVol(chan_id_t::VRC7_CH1), 0);
+	EXPECT_EQ(apu1.GetVol(chan_id_t::VRC7_CH1), apu2.GetVol(chan_id_t::VRC7_CH1));
+	EXPECT_EQ(cb1.samples_, cb2.samples_);
+	EXPECT_NE(cb1.samples_.size(), cb3.samples_.size());
+}
+
+TEST(Apu, Stems) {
+	CBufferCallback cb;
+	CStemCallback stems;
+	CAPU apu {&cb};
+	SetupSquare(apu, 44100, 1);
+	apu.SetStemCallback(&stems);
+	RunFrames(apu, 10);
+
+	// only the playing channel has a non-silent stem, and it equals the full mix
+	ASSERT_EQ(stems.samples_.size(), 5u);
+	for (const auto &[ch, v] : stems.samples_) {
+		EXPECT_EQ(v.size(), cb.samples_.size());
+		if (ch == chan_id_t::SQUARE1)
+			EXPECT_EQ(v, cb.samples_);
+		else
+			for (auto x : v)
+				EXPECT_EQ(x, 0);
+	}
+}
+
+TEST(Apu, StereoPan) {
+	const auto render = [] (int channels, int pan) {
+		CBufferCallback cb;
+		CAPU apu {&cb};
+		SetupSquare(apu, 44100, channels);
+		apu.SetChannelPan(chan_id_t::SQUARE1, pan);
+		RunFrames(apu, 10);
+		return cb.samples_;
+	};
+
+	// centered channels are identical on both sides
+	auto mono = render(1, 0);
+	auto center = render(2, 0);
+	ASSERT_EQ(center.size(), mono.size() * 2);
+	for (std::size_t i = 0; i < mono.size(); ++i) {
+		EXPECT_EQ(center[i * 2], mono[i]);
+		EXPECT_EQ(center[i * 2 + 1], mono[i]);
+	}
+
+	// a channel panned fully to the left is absent from the right side
+	auto left = render(2, -100);
+	ASSERT_EQ(left.size(), center.size());
+	bool nonzero = false;
+	for (std::size_t i = 0; i < mono.size(); ++i) {
+		nonzero = nonzero || left[i * 2] != 0;
+		EXPECT_EQ(left[i * 2 + 1], 0);
+	}
+	EXPECT_TRUE(nonzero);
+}
+
+TEST(Apu, IdleChannels) {
+	const auto render = [] (bool square2) {
+		CBufferCallback cb;
+		CAPU apu {&cb};
+		SetupSquare(apu, 44100, 1);
+		apu.Write(0x4015, 0x03);
+		if (square2) {		// ultrasonic period, never audible
+			apu.Write(0x4004, 0xBF);
+			apu.Write(0x4006, 0x03);
+			apu.Write(0x4007, 0x00);
+		}
+		RunFrames(apu, 10);
+		return cb.samples_;
+	};
+
+	EXPECT_EQ(render(true), render(false));
+}
+
+TEST(Apu, SubFrameFlush) {
+	const auto render = [] (uint32_t cycles, int &flushes) {
+		CBufferCallback cb;
+		CAPU apu {&cb};
+		SetupSquare(apu, 44100, 1, CSoundChipSet {sound_chip_t::APU}.WithChip(sound_chip_t::N163));
+		apu.SetSubFrameCycles(cycles);
+		apu.Write(0x4015, 0x0F);
+		apu.Write(0x400C, 0x3F);
+		apu.Write(0x400E, 0x04);
+		apu.Write(0x400F, 0x08);
+		for (int i = 0; i < 0x10; ++i) {		// N163 waveform
+			apu.Write(0xF800, i);
+			apu.Write(0x4800, i * 0x11);
+		}
+		apu.Write(0xF800, 0xF8);
+		for (int x : {0x00, 0x00, 0x80, 0x00, 0xE0, 0x00, 0x00, 0x7F})
+			apu.Write(0x4800, x);
+		for (int i = 0; i < 10; ++i) {
+			apu.Write(0x4002, 0xFD - i);
+			RunFrames(apu, 1);
+		}
+		flushes = cb.flushes_;
+		return cb.samples_;
+	};
+
+	// partial frames only change when the samples are handed over
+	int flushes = 0;
+	int subFrameFlushes = 0;
+	auto whole = render(0, flushes);
+	auto partial = render(1000, subFrameFlushes);
+	EXPECT_EQ(flushes, 10);
+	EXPECT_GT(subFrameFlushes, 10 * 29);
+	EXPECT_EQ(whole, partial);
+}
@@ -0,0 +1,213 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "Blip_Buffer/Blip_Kernels.h"
+#include "gtest/gtest.h"
+#include <climits>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using buf_t = Blip_Buffer::buf_t_;
+
+const blip_kernels_t &Portable() {
+	return *blip_kernel_set(0);
+}
+
+std::vector<buf_t> RandomInput(std::mt19937 &rng, std::size_t Count, int Range) {
+	std::uniform_int_distribution<int> dist(-Range, Range);
+	std::vector<buf_t> v(Count);
+	for (auto &x : v)
+		x = dist(rng);
+	return v;
+}
+
+// compares the output of every kernel set with the portable kernels
+template <typename F>
+void ForEachKernelSet(F f) {
+	for (int i = 1; blip_kernel_set(i); ++i) {
+		SCOPED_TRACE(blip_kernel_set(i)->name);
+		f(*blip_kernel_set(i));
+	}
+}
+
+} // namespace
+
+TEST(BlipKernels, Selection) {
+	ASSERT_NE(blip_kernel_set(0), nullptr);
+	EXPECT_STREQ(blip_kernel_set(0)->name, "scalar");
+	EXPECT_EQ(blip_kernel_set(-1), nullptr);
+
+	int i = 0;
+	while (blip_kernel_set(i + 1))
+		++i;
+	EXPECT_EQ(&blip_kernels(), blip_kernel_set(i));
+}
+
+TEST(BlipKernels, Synth) {
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<int> imp(-32768, 32767);
+	// products do not overflow 32-bit buffers either
+	const int DeltaRange = sizeof(buf_t) > 4 ? 1 << 24 : 1 << 10;
+	std::uniform_int_distribution<int> delta(-DeltaRange, DeltaRange);
+
+	ForEachKernelSet([&] (const blip_kernels_t &k) {
+		for (int width : {8, 12, 16}) {
+			std::vector<short> row(width);
+			for (auto &x : row)
+				x = static_cast<short>(imp(rng));
+			auto expected = RandomInput(rng, width + 2, 1 << 28);
+			auto actual = expected;
+			for (int i = 0; i < 16; ++i) {
+				int d = delta(rng);
+				Portable().synth(expected.data() + 1, row.data(), width, d);
+				k.synth(actual.data() + 1, row.data(), width, d);
+			}
+			EXPECT_EQ(actual, expected) << "width " << width;
+		}
+	});
+}
+
+TEST(BlipKernels, Integrate) {
+	std::mt19937 rng(2);
+	const int Range = sizeof(buf_t) > 4 ? 1 << 26 : 1 << 20;
+
+	ForEachKernelSet([&] (const blip_kernels_t &k) {
+		for (int lanes : {1, 2, 3, 4, 5, 9}) for (long count : {0L, 1L, 3L, 4L, 7L, 735L}) {
+			std::vector<std::vector<buf_t>> in;
+			std::vector<std::vector<float>> expected(lanes, std::vector<float>(count));
+			auto actual = expected;
+			std::vector<blip_lane_t> e, a;
+			for (int l = 0; l < lanes; ++l) {
+				in.push_back(RandomInput(rng, count, Range));
+				const long accum = RandomInput(rng, 1, Range << 3)[0];
+				e.push_back({in[l].data(), expected[l].data(), accum});
+				a.push_back({in[l].data(), actual[l].data(), accum});
+			}
+
+			Portable().integrate(e.data(), lanes, count, 9);
+			k.integrate(a.data(), lanes, count, 9);
+			for (int l = 0; l < lanes; ++l) {
+				EXPECT_EQ(a[l].accum, e[l].accum);
+				EXPECT_EQ(std::memcmp(actual[l].data(), expected[l].data(), count * sizeof(float)), 0)
+					<< lanes << " lanes, " << count << " samples";
+			}
+		}
+	});
+}
+
+TEST(BlipKernels, IntegrateOverload) {
+	// samples far beyond full scale, and no bass filter
+	std::mt19937 rng(3);
+	const long count = 64;
+	const long Start = LONG_MAX / 4;
+	const int Range = 1 << 24;
+
+	ForEachKernelSet([&] (const blip_kernels_t &k) {
+		for (int shift : {31, 13, 1}) {
+			std::vector<std::vector<buf_t>> in;
+			std::vector<std::vector<float>> expected(4, std::vector<float>(count));
+			auto actual = expected;
+			std::vector<blip_lane_t> e, a;
+			for (int l = 0; l < 4; ++l) {
+				in.push_back(RandomInput(rng, count, Range));
+				e.push_back({in[l].data(), expected[l].data(), l % 2 ? -Start : Start});
+				a.push_back({in[l].data(), actual[l].data(), l % 2 ? -Start : Start});
+			}
+
+			Portable().integrate(e.data(), 4, count, shift);
+			k.integrate(a.data(), 4, count, shift);
+			for (int l = 0; l < 4; ++l) {
+				EXPECT_EQ(a[l].accum, e[l].accum);
+				EXPECT_EQ(std::memcmp(actual[l].data(), expected[l].data(), count * sizeof(float)), 0)
+					<< "bass shift " << shift;
+			}
+		}
+	});
+}
+
+TEST(BlipKernels, Mix) {
+	std::mt19937 rng(4);
+	std::uniform_int_distribution<int> dist(-32768, 32767);
+
+	ForEachKernelSet([&] (const blip_kernels_t &k) {
+		for (long count : {0L, 1L, 8L, 9L, 10L, 17L, 735L}) {
+			std::vector<blip_sample_t> in(count);
+			for (auto &x : in)
+				x = static_cast<blip_sample_t>(dist(rng));
+			auto expected = RandomInput(rng, count + 1, 1 << 28);
+			auto actual = expected;
+			Portable().mix(expected.data(), in.data(), count);
+			k.mix(actual.data(), in.data(), count);
+			EXPECT_EQ(actual, expected) << count << " samples";
+		}
+	});
+}
+
+TEST(BlipKernels, ReadSeveralBuffers) {
+	// the same buffers, read one by one and together
+	const int BUFFERS = 6;
+	Blip_Buffer a[BUFFERS], b[BUFFERS];
+	Blip_Synth<blip_good_quality> synth(100.);
+	synth.volume(.5);
+
+	std::mt19937 rng(5);
+	for (int i = 0; i < BUFFERS; ++i)
+		for (Blip_Buffer *bb : {&a[i], &b[i]}) {
+			ASSERT_EQ(bb->set_sample_rate(44100, 100), nullptr);
+			bb->clock_rate(1789773);
+			bb->bass_freq(i == 4 ? 90 : 16);		// read alone
+			if (i == 5)
+				bb->end_frame(41);		// one sample ahead, read alone
+		}
+
+	for (int frame = 0; frame < 3; ++frame) {
+		for (int i = 0; i < BUFFERS; ++i)
+			for (int n = 0; n < 200; ++n) {
+				const blip_time_t t = rng() % 29000;
+				const int delta = static_cast<int>(rng() % 101) - 50;
+				synth.offset(t, delta, &a[i]);
+				synth.offset(t, delta, &b[i]);
+			}
+
+		std::vector<std::vector<float>> expected(BUFFERS), actual(BUFFERS);
+		Blip_Buffer *buffers[BUFFERS];
+		float *dests[BUFFERS];
+		for (int i = 0; i < BUFFERS; ++i) {
+			a[i].end_frame(29780);
+			b[i].end_frame(29780);
+			expected[i].resize(a[i].samples_avail());
+			expected[i].resize(a[i].read_samples(expected[i].data(), expected[i].size()));
+			actual[i].resize(b[i].samples_avail());
+			buffers[i] = &b[i];
+			dests[i] = actual[i].data();
+		}
+		Blip_Buffer::read_samples(buffers, dests, BUFFERS);
+
+		for (int i = 0; i < BUFFERS; ++i) {
+			EXPECT_EQ(b[i].samples_avail(), 0);
+			EXPECT_EQ(actual[i], expected[i]) << "buffer " << i << ", frame " << frame;
+		}
+	}
+}
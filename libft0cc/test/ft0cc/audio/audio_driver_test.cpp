@@ -0,0 +1,117 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "AudioDriver.h"
+#include "HeadlessAudioSink.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+class CDriverCallback : public IAudioCallback {
+public:
+	void FlushBuffer(array_view<float>) override {
+	}
+	bool PlayBuffer() override {
+		return driver_ && driver_->DoPlayBuffer();
+	}
+
+	CAudioDriver *driver_ = nullptr;
+};
+
+std::vector<char> RenderToFile(const char *name, int sampleSize, const std::vector<int16_t> &input, int frameLen) {
+	std::vector<float> samples;
+	for (int16_t x : input)
+		samples.push_back(x / 32768.f);
+
+	const int rate = 44100;
+	const int blockSize = 882 * (sampleSize / 8);
+
+	CDriverCallback cb;
+	{
+		CAudioDriver driver {cb, std::make_unique<CFileAudioSink>(name, rate, sampleSize, 1, blockSize), static_cast<unsigned>(sampleSize), 1470u};
+		cb.driver_ = &driver;
+		driver.Reset();
+		for (std::size_t i = 0; i < samples.size(); i += frameLen)
+			driver.FlushBuffer({samples.data() + i, std::min<std::size_t>(frameLen, samples.size() - i)});
+		driver.CloseAudioDevice();
+		EXPECT_EQ(driver.GetUnderruns(), 0u);
+	}
+
+	std::ifstream f {name, std::ios::binary};
+	std::vector<char> contents {std::istreambuf_iterator<char> {f}, std::istreambuf_iterator<char> { }};
+	f.close();
+	std::remove(name);
+	return contents;
+}
+
+unsigned ReadLE(const std::vector<char> &v, std::size_t pos, int bytes) {
+	unsigned x = 0;
+	for (int i = bytes - 1; i >= 0; --i)
+		x = (x << 8) | static_cast<unsigned char>(v[pos + i]);
+	return x;
+}
+
+} // namespace
+
+TEST(AudioDriver, FileSink16Bit) {
+	std::vector<int16_t> samples(735 * 100);
+	for (std::size_t i = 0; i < samples.size(); ++i)
+		samples[i] = static_cast<int16_t>(i * 37);
+
+	auto wav = RenderToFile("ft0cc_audio_driver_test_16.wav", 16, samples, 735);
+	ASSERT_GE(wav.size(), 44u);
+	EXPECT_EQ(std::string(wav.data(), 4), "RIFF");
+	EXPECT_EQ(std::string(wav.data() + 8, 8), "WAVEfmt ");
+	EXPECT_EQ(ReadLE(wav, 22, 2), 1u);
+	EXPECT_EQ(ReadLE(wav, 24, 4), 44100u);
+	EXPECT_EQ(ReadLE(wav, 34, 2), 16u);
+
+	// only whole blocks reach the sink
+	const unsigned dataSize = ReadLE(wav, 40, 4);
+	EXPECT_EQ(dataSize, samples.size() / 882 * 882 * 2);
+	EXPECT_EQ(ReadLE(wav, 4, 4), 36u + dataSize);
+	ASSERT_EQ(wav.size(), 44u + dataSize);
+
+	bool same = true;
+	for (std::size_t i = 0; i < dataSize / 2; ++i)
+		same = same && static_cast<int16_t>(ReadLE(wav, 44 + i * 2, 2)) == samples[i];
+	EXPECT_TRUE(same);
+}
+
+TEST(AudioDriver, FileSink8Bit) {
+	std::vector<int16_t> samples(882 * 4);
+	for (std::size_t i = 0; i < samples.size(); ++i)
+		samples[i] = static_cast<int16_t>((i % 256) * 256 - 32768);
+
+	auto wav = RenderToFile("ft0cc_audio_driver_test_8.wav", 8, samples, 1000);
+	ASSERT_EQ(wav.size(), 44u + samples.size());
+	EXPECT_EQ(ReadLE(wav, 34, 2), 8u);
+
+	bool same = true;
+	for (std::size_t i = 0; i < samples.size(); ++i)
+		same = same && static_cast<unsigned char>(wav[44 + i]) == i % 256;
+	EXPECT_TRUE(same);
+}
@@ -0,0 +1,99 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "RingBuffer.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+TEST(RingBuffer, Capacity) {
+	EXPECT_EQ(CRingBuffer<int>(1).GetCapacity(), 1u);
+	EXPECT_EQ(CRingBuffer<int>(100).GetCapacity(), 128u);
+	EXPECT_EQ(CRingBuffer<int>(4096).GetCapacity(), 4096u);
+}
+
+TEST(RingBuffer, ReadWrite) {
+	CRingBuffer<int> ring(8);
+	EXPECT_EQ(ring.GetReadAvailable(), 0u);
+	EXPECT_EQ(ring.GetWriteAvailable(), 8u);
+
+	const int data[] = {1, 2, 3, 4, 5, 6};
+	EXPECT_EQ(ring.Write(data), 6u);
+	EXPECT_EQ(ring.GetReadAvailable(), 6u);
+	EXPECT_EQ(ring.GetWriteAvailable(), 2u);
+
+	int out[8] = { };
+	EXPECT_EQ(ring.Read(out, 4), 4u);
+	EXPECT_EQ(out[0], 1);
+	EXPECT_EQ(out[3], 4);
+
+	// wraps around the end of the storage
+	EXPECT_EQ(ring.Write(data), 6u);
+	EXPECT_EQ(ring.Write(data), 0u);
+	EXPECT_EQ(ring.Read(out, 8), 8u);
+	const int expected[] = {5, 6, 1, 2, 3, 4, 5, 6};
+	for (int i = 0; i < 8; ++i)
+		EXPECT_EQ(out[i], expected[i]);
+
+	EXPECT_EQ(ring.Read(out, 8), 0u);
+}
+
+TEST(RingBuffer, Discard) {
+	CRingBuffer<char> ring(4);
+	EXPECT_EQ(ring.Write(array_view<char> {"abcd", 4}), 4u);
+	EXPECT_EQ(ring.Discard(3), 3u);
+	EXPECT_EQ(ring.Discard(3), 1u);
+	EXPECT_EQ(ring.GetReadAvailable(), 0u);
+	EXPECT_EQ(ring.GetWriteAvailable(), 4u);
+}
+
+TEST(RingBuffer, Concurrent) {
+	constexpr int COUNT = 1 << 16;
+	CRingBuffer<int> ring(1000);
+
+	std::thread producer {[&] {
+		std::vector<int> chunk;
+		int next = 0;
+		while (next < COUNT) {
+			chunk.clear();
+			for (int i = 0; i < 37 && next + i < COUNT; ++i)
+				chunk.push_back(next + i);
+			std::size_t written = 0;
+			while (written < chunk.size())
+				written += ring.Write(array_view<int> {chunk.data() + written, chunk.size() - written});
+			next += static_cast<int>(chunk.size());
+		}
+	}};
+
+	int expected = 0;
+	bool ordered = true;
+	int buf[53];
+	while (expected < COUNT) {
+		std::size_t n = ring.Read(buf, std::size(buf));
+		for (std::size_t i = 0; i < n; ++i)
+			ordered = ordered && buf[i] == expected++;
+	}
+	producer.join();
+
+	EXPECT_TRUE(ordered);
+	EXPECT_EQ(ring.GetReadAvailable(), 0u);
+}
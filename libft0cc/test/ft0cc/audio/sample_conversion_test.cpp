@@ -0,0 +1,101 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2015 Jonathan Liss
+**
+** 0CC-FamiTracker is (C) 2014-2018 HertzDevil
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Library General Public License for more details.  To obtain a
+** copy of the GNU Library General Public License, write to the Free
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "SampleConversion.h"
+#include "gtest/gtest.h"
+#include <iterator>
+#include <cstdint>
+#include <vector>
+
+TEST(SampleConversion, RoundTrip16Bit) {
+	std::vector<float> in;
+	for (int i = -32768; i <= 32767; ++i)
+		in.push_back(i / 32768.f);
+
+	std::vector<std::int16_t> out(in.size());
+	EXPECT_EQ(ConvertSamples(in, out.data(), 16), 2u);
+	bool same = true;
+	for (std::size_t i = 0; i < in.size(); ++i)
+		same = same && out[i] == static_cast<int>(i) - 32768;
+	EXPECT_TRUE(same);
+
+	// 8-bit samples are the unsigned upper half of the 16-bit samples
+	std::vector<std::uint8_t> out8(in.size());
+	ConvertSamples(in, out8.data(), 8);
+	same = true;
+	for (std::size_t i = 0; i < in.size(); ++i)
+		same = same && out8[i] == static_cast<std::uint8_t>((out[i] >> 8) + 0x80);
+	EXPECT_TRUE(same);
+}
+
+TEST(SampleConversion, RoundDown) {
+	const float in[] = {.25f / 32768, -.25f / 32768, -1.f / 32768, 100.75f / 32768};
+	std::int16_t out[4] = { };
+	EXPECT_EQ(ConvertSamples(in, out, 16), 0u);
+	EXPECT_EQ(out[0], 0);
+	EXPECT_EQ(out[1], -1);
+	EXPECT_EQ(out[2], -1);
+	EXPECT_EQ(out[3], 100);
+}
+
+TEST(SampleConversion, Clipping) {
+	const float in[] = {2.f, -3.f, .5f, 1.f};
+	std::int16_t out[4] = { };
+	EXPECT_EQ(ConvertSamples(in, out, 16), 3u);
+	EXPECT_EQ(out[0], 32767);
+	EXPECT_EQ(out[1], -32768);
+	EXPECT_EQ(out[2], 16384);
+	EXPECT_EQ(out[3], 32767);
+
+	// the gain is applied before clipping
+	EXPECT_EQ(ConvertSamples(in, out, 16, .25f), 0u);
+	EXPECT_EQ(out[0], 16384);
+	EXPECT_EQ(out[1], -24576);
+}
+
+TEST(SampleConversion, Packed24Bit) {
+	const float in[] = {1.f / 8388608, -1.f / 8388608, .5f, -1.f, 0x123456 / 8388608.f};
+	std::uint8_t out[15] = { };
+	EXPECT_EQ(ConvertSamples(in, out, 24), 1u);
+	const std::uint8_t expected[] = {
+		0x01, 0x00, 0x00,
+		0xFF, 0xFF, 0xFF,
+		0x00, 0x00, 0x40,
+		0x00, 0x00, 0x80,
+		0x56, 0x34, 0x12,
+	};
+	for (std::size_t i = 0; i < std::size(out); ++i)
+		EXPECT_EQ(out[i], expected[i]);
+}
+
+TEST(SampleConversion, FloatKeepsHeadroom) {
+	const float in[] = {2.f, -.5f, 1.5f};
+	float out[3] = { };
+	EXPECT_EQ(ConvertSamples(in, out, 32), 2u);
+	EXPECT_EQ(out[0], 2.f);
+	EXPECT_EQ(out[1], -.5f);
+	EXPECT_EQ(out[2], 1.5f);
+
+	EXPECT_EQ(ConvertSamples(in, out, 32, .25f), 0u);
+	EXPECT_EQ(out[0], .5f);
+	EXPECT_EQ(out[2], .375f);
+}
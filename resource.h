@@ -204,6 +204,7 @@
 #define IDS_MIDI_MESSAGE_OFF            317
 #define IDI_RIGHT                       317
 #define IDS_WAVE_PROGRESS_ROW_FORMAT    318
+#define IDS_PERFORMANCE_LATENCY_FORMAT  319
 #define IDR_SEQUENCE_POPUP              319
 #define IDD_STRETCH                     323
 #define IDD_BOOKMARKS                   324
@@ -595,6 +596,7 @@
 #define IDC_INST_SEQUENCE_GRAPH         1458
 #define IDC_MAINFRAME_INST_TOOLBAR      1458
 #define IDC_STATIC_DPCM_ZOOM            1459
+#define IDC_LATENCY                     1460
 #define ID_TRACKER_PLAY                 32771
 #define ID_TRACKER_PLAYPATTERN          32775
 #define ID_TRACKER_STOP                 32776
@@ -757,7 +759,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        358
 #define _APS_NEXT_COMMAND_VALUE         33202
-#define _APS_NEXT_CONTROL_VALUE         1460
+#define _APS_NEXT_CONTROL_VALUE         1461
 #define _APS_NEXT_SYMED_VALUE           179
 #endif
 #endif